@@ -0,0 +1,492 @@
+/**
+ * @file bignum_bench.cpp
+ * @brief Machine-readable size sweeps over every algorithm tier, with
+ * baseline comparison for regression gating.
+ *
+ * Each operation runs at operand sizes from 64 to 65,536 bits with one tier
+ * pinned through BigNum::setTuning: the tier is forced at the top level of
+ * the call and the defaults stay in place below it, so neighbouring rows
+ * show where a threshold belongs. Calls are timed in batches long enough to
+ * hide the clock's resolution, and a row reports the median time per call
+ * over the batches, TSC cycles per call on x86 and those cycles divided by
+ * the operand's limb count.
+ *
+ * Usage: bignum_bench [--format console|json|csv] [--out FILE]
+ *                     [--filter TEXT] [--min-bits N] [--max-bits N]
+ *                     [--min-time SECONDS] [--baseline FILE]
+ *                     [--threshold PERCENT]
+ *
+ * With --baseline the run is compared row by row against an earlier JSON or
+ * CSV output of this tool. Rows slower than the baseline by more than the
+ * threshold (10% by default) are reported, and the exit status is 1 when
+ * there is at least one.
+ */
+
+#include "bignum.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__EMSCRIPTEN__)
+#include <x86intrin.h>
+#define BIGNUM_BENCH_TSC 1
+#else
+#define BIGNUM_BENCH_TSC 0
+#endif
+
+namespace {
+
+struct Options {
+    std::string format = "console";
+    std::string out;
+    std::string filter;
+    std::string baseline;
+    size_t min_bits = 64;
+    size_t max_bits = 65536;
+    double min_time = 0.1;    // seconds of batches per row
+    double threshold = 10.0;  // percent slower that counts as a regression
+};
+
+struct Row {
+    std::string name;
+    std::string op;
+    std::string tier;
+    size_t bits = 0;
+    size_t limbs = 0;
+    uint64_t iterations = 0;
+    double ns_per_op = 0;      // median over batches
+    double min_ns_per_op = 0;
+    double cycles_per_op = 0;  // 0 without a cycle counter
+    double cycles_per_limb = 0;
+};
+
+// Consumes results so the optimiser keeps the calls being timed
+volatile size_t g_sink = 0;
+
+void keep(const BigNum& x) { g_sink = g_sink + x.getDigits().size(); }
+void keep(const std::string& s) { g_sink = g_sink + s.size(); }
+
+inline uint64_t cycles() {
+#if BIGNUM_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Batches double in length until one takes at least 1/20 of the budget (or
+// a single call is slower than that); batches of that length then run
+// until the budget is spent, with at least three of them
+Row measure(const std::function<void()>& op, double min_time) {
+    const double batch_target = min_time / 20;
+    op();  // warm-up: caches, arenas, the NTT root tables
+
+    uint64_t batch = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) op();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= batch_target || batch >= (uint64_t(1) << 30)) break;
+        batch *= 2;
+    }
+
+    std::vector<double> ns;
+    std::vector<double> cyc;
+    uint64_t iterations = 0;
+    double spent = 0;
+    while (spent < min_time || ns.size() < 3) {
+        const uint64_t c0 = cycles();
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) op();
+        auto stop = Clock::now();
+        const uint64_t c1 = cycles();
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        spent += seconds;
+        iterations += batch;
+        ns.push_back(seconds * 1e9 / batch);
+        cyc.push_back(static_cast<double>(c1 - c0) / batch);
+    }
+
+    Row row;
+    row.iterations = iterations;
+    std::vector<double> sorted_ns = ns, sorted_cyc = cyc;
+    std::sort(sorted_ns.begin(), sorted_ns.end());
+    std::sort(sorted_cyc.begin(), sorted_cyc.end());
+    row.ns_per_op = sorted_ns[sorted_ns.size() / 2];
+    row.min_ns_per_op = sorted_ns.front();
+    row.cycles_per_op = BIGNUM_BENCH_TSC ? sorted_cyc[sorted_cyc.size() / 2] : 0;
+    return row;
+}
+
+// One family of rows: `op` at every size, with the tuning that pins `tier`
+struct Case {
+    std::string op;
+    std::string tier;
+    size_t min_bits;
+    size_t max_bits;
+    std::function<BigNumTuning(size_t limbs)> tuning;
+    std::function<std::function<void()>(size_t bits)> make;
+};
+
+const size_t NEVER = static_cast<size_t>(-1);
+
+std::vector<Case> cases() {
+    const BigNumTuning d = BigNum::tuning();
+    auto only = [d](std::function<void(BigNumTuning&, size_t)> pin) {
+        return [d, pin](size_t limbs) {
+            BigNumTuning t = d;
+            pin(t, limbs);
+            return t;
+        };
+    };
+
+    auto mul = [](size_t bits) {
+        BigNum a = BigNum::random(bits), b = BigNum::random(bits);
+        return std::function<void()>([a, b]() { keep(a * b); });
+    };
+    auto sqr = [](size_t bits) {
+        BigNum a = BigNum::random(bits);
+        return std::function<void()>([a]() { keep(a.square()); });
+    };
+    // 2n / n bits, the shape of a modular reduction
+    auto div = [](size_t bits) {
+        BigNum a = BigNum::random(2 * bits), b = BigNum::random(bits) | (BigNum(1) << static_cast<int>(bits - 1));
+        return std::function<void()>([a, b]() { keep(a / b); });
+    };
+    // A 64-bit exponent keeps a row to about a hundred modular products
+    auto modpow = [](bool odd) {
+        return [odd](size_t bits) {
+            BigNum m = BigNum::random(bits) | (BigNum(1) << static_cast<int>(bits - 1));
+            m = odd ? (m | BigNum(1)) : ((m >> 1) << 1);
+            BigNum b = BigNum::random(bits - 1), e = BigNum::random(64);
+            return std::function<void()>([m, b, e]() { keep(b.modPow(e, m)); });
+        };
+    };
+    // b1^e1 * b2^e2 mod m, as one interleaved chain or two modPows
+    auto modpow2 = [](bool product) {
+        return [product](size_t bits) {
+            BigNum m = BigNum::random(bits) | (BigNum(1) << static_cast<int>(bits - 1)) | BigNum(1);
+            std::vector<BigNum> b = {BigNum::random(bits - 1), BigNum::random(bits - 1)};
+            std::vector<BigNum> e = {BigNum::random(64), BigNum::random(64)};
+            if (product) return std::function<void()>([m, b, e]() { keep(BigNum::modPowProduct(b, e, m)); });
+            return std::function<void()>([m, b, e]() { keep(BigNum::mulMod(b[0].modPow(e[0], m), b[1].modPow(e[1], m), m)); });
+        };
+    };
+    // An RSA private-key operation with a full-length d, by CRT or not
+    auto rsa = [](bool crt) {
+        return [crt](size_t bits) {
+            const BigNum e(65537);
+            BigNum p, q, phi;
+            do {
+                p = BigNum::randomPrime(bits / 2);
+                q = BigNum::randomPrime(bits - bits / 2);
+                phi = (p - BigNum(1)) * (q - BigNum(1));
+            } while (!e.gcd(phi).isOne());
+            BigNum n = p * q, d = e.modInverse(phi);
+            BigNum c = BigNum::random(bits) % n;
+            if (!crt) return std::function<void()>([c, d, n]() { keep(c.modPow(d, n)); });
+            auto key = std::make_shared<RSACRTContext>(p, q, d % (p - BigNum(1)), d % (q - BigNum(1)),
+                                                       q.modInverse(p));
+            return std::function<void()>([c, key]() { keep(key->modPow(c)); });
+        };
+    };
+    auto toDecimal = [](size_t bits) {
+        BigNum a = BigNum::random(bits);
+        return std::function<void()>([a]() { keep(a.toDecimalString()); });
+    };
+    auto fromDecimal = [](size_t bits) {
+        std::string s = BigNum::random(bits).toDecimalString();
+        return std::function<void()>([s]() { keep(BigNum::fromDecimalString(s)); });
+    };
+    auto toHex = [](size_t bits) {
+        BigNum a = BigNum::random(bits);
+        return std::function<void()>([a]() { keep(a.toHexString()); });
+    };
+
+    // Pinning a tier at n limbs sets its threshold to min(n, default), so
+    // the recursion below the top level sees the usual crossovers. Every
+    // tier above the basecase is reached through the Karatsuba gate, which
+    // is opened the same way.
+    auto gate = [d](BigNumTuning& t, size_t n) {
+        t.karatsuba_threshold = std::max<size_t>(2, std::min(n, d.karatsuba_threshold));
+    };
+    return {
+        {"mul", "schoolbook", 64, 65536, only([](BigNumTuning& t, size_t) {
+            t.karatsuba_threshold = t.toom3_threshold = t.ntt_threshold = NEVER;
+        }), mul},
+        {"mul", "karatsuba", 128, 65536, only([gate](BigNumTuning& t, size_t n) {
+            gate(t, n);
+            t.toom3_threshold = t.ntt_threshold = NEVER;
+        }), mul},
+        {"mul", "toom3", 192, 65536, only([d, gate](BigNumTuning& t, size_t n) {
+            gate(t, n);
+            t.toom3_threshold = std::max<size_t>(3, std::min(n, d.toom3_threshold));
+            t.ntt_threshold = NEVER;
+        }), mul},
+        {"mul", "ntt", 128, 65536, only([gate](BigNumTuning& t, size_t n) {
+            gate(t, n);
+            t.ntt_threshold = 1;
+        }), mul},
+        {"mul", "default", 64, 65536, only([](BigNumTuning&, size_t) {}), mul},
+        {"sqr", "basecase", 64, 65536, only([](BigNumTuning& t, size_t) {
+            t.karatsuba_sqr_threshold = t.toom3_threshold = t.ntt_threshold = NEVER;
+        }), sqr},
+        {"sqr", "karatsuba", 128, 65536, only([d](BigNumTuning& t, size_t n) {
+            t.karatsuba_sqr_threshold = std::max<size_t>(2, std::min(n, d.karatsuba_sqr_threshold));
+            t.toom3_threshold = t.ntt_threshold = NEVER;
+        }), sqr},
+        {"sqr", "default", 64, 65536, only([](BigNumTuning&, size_t) {}), sqr},
+        {"div", "default", 64, 65536, only([](BigNumTuning&, size_t) {}), div},
+        {"modpow", "montgomery", 64, 65536, only([](BigNumTuning& t, size_t) {
+            t.montgomery_threshold = 1;
+        }), modpow(true)},
+        {"modpow", "barrett", 64, 65536, only([](BigNumTuning& t, size_t) {
+            t.montgomery_threshold = NEVER;
+            t.barrett_threshold = 1;
+        }), modpow(false)},
+        {"modpow", "plain", 64, 65536, only([](BigNumTuning& t, size_t) {
+            t.montgomery_threshold = t.barrett_threshold = NEVER;
+        }), modpow(false)},
+        {"modpow2", "separate", 64, 65536, only([](BigNumTuning&, size_t) {}), modpow2(false)},
+        {"modpow2", "product", 64, 65536, only([](BigNumTuning&, size_t) {}), modpow2(true)},
+        {"rsa_private", "full", 512, 4096, only([](BigNumTuning&, size_t) {}), rsa(false)},
+        {"rsa_private", "crt", 512, 4096, only([](BigNumTuning&, size_t) {}), rsa(true)},
+        {"to_decimal", "basecase", 64, 65536, only([](BigNumTuning& t, size_t) {
+            t.decimal_threshold = NEVER;
+        }), toDecimal},
+        {"to_decimal", "default", 64, 65536, only([](BigNumTuning&, size_t) {}), toDecimal},
+        {"from_decimal", "default", 64, 65536, only([](BigNumTuning&, size_t) {}), fromDecimal},
+        {"to_hex", "default", 64, 65536, only([](BigNumTuning&, size_t) {}), toHex},
+    };
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+std::string jsonEscape(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        r += c;
+    }
+    return r;
+}
+
+void writeJson(std::ostream& os, const std::vector<Row>& rows) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    os << "{\n  \"context\": {\"date\": \"" << date << "\", \"kernels\": \"" << jsonEscape(BigNum::kernels())
+       << "\", \"threads\": " << BigNum::threadCount() << ", \"cycle_counter\": "
+       << (BIGNUM_BENCH_TSC ? "\"tsc\"" : "null") << "},\n  \"benchmarks\": [\n";
+    os << std::setprecision(6);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& r = rows[i];
+        os << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"op\": \"" << r.op << "\", \"tier\": \"" << r.tier
+           << "\", \"bits\": " << r.bits << ", \"limbs\": " << r.limbs << ", \"iterations\": " << r.iterations
+           << ", \"real_time\": " << r.ns_per_op << ", \"min_time\": " << r.min_ns_per_op
+           << ", \"time_unit\": \"ns\", \"cycles\": ";
+        if (BIGNUM_BENCH_TSC) {
+            os << r.cycles_per_op << ", \"cycles_per_limb\": " << r.cycles_per_limb;
+        } else {
+            os << "null, \"cycles_per_limb\": null";
+        }
+        os << "}" << (i + 1 < rows.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+void writeCsv(std::ostream& os, const std::vector<Row>& rows) {
+    os << "name,op,tier,bits,limbs,iterations,real_time_ns,min_time_ns,cycles,cycles_per_limb\n";
+    os << std::setprecision(6);
+    for (const Row& r : rows) {
+        os << r.name << ',' << r.op << ',' << r.tier << ',' << r.bits << ',' << r.limbs << ','
+           << r.iterations << ',' << r.ns_per_op << ',' << r.min_ns_per_op << ',';
+        if (BIGNUM_BENCH_TSC) os << r.cycles_per_op << ',' << r.cycles_per_limb;
+        else os << ',';
+        os << "\n";
+    }
+}
+
+std::string formatTime(double ns) {
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(2);
+    if (ns >= 1e9) s << ns / 1e9 << " s";
+    else if (ns >= 1e6) s << ns / 1e6 << " ms";
+    else if (ns >= 1e3) s << ns / 1e3 << " us";
+    else s << ns << " ns";
+    return s.str();
+}
+
+void printRow(const Row& r) {
+    std::cout << "  " << std::setw(32) << std::left << r.name << std::setw(12) << std::right
+              << formatTime(r.ns_per_op);
+    if (BIGNUM_BENCH_TSC) {
+        std::cout << std::setw(14) << std::fixed << std::setprecision(0) << r.cycles_per_op << " cyc"
+                  << std::setw(12) << std::setprecision(1) << r.cycles_per_limb << " cyc/limb";
+    }
+    std::cout << std::setw(12) << r.iterations << " it\n";
+}
+
+// ---------------------------------------------------------------------------
+// Baseline comparison
+// ---------------------------------------------------------------------------
+
+// real_time (ns) by name from an earlier JSON or CSV run of this tool. The
+// JSON reader only understands the one-row-per-line layout writeJson emits.
+bool readBaseline(const std::string& path, std::map<std::string, double>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    bool csv = false;
+    bool first = true;
+    while (std::getline(in, line)) {
+        if (first) {
+            csv = line.rfind("name,", 0) == 0;
+            first = false;
+            if (csv) continue;
+        }
+        if (csv) {
+            std::vector<std::string> fields;
+            std::stringstream ss(line);
+            std::string field;
+            while (std::getline(ss, field, ',')) fields.push_back(field);
+            if (fields.size() >= 7) out[fields[0]] = std::atof(fields[6].c_str());
+            continue;
+        }
+        const size_t name = line.find("\"name\": \"");
+        const size_t time = line.find("\"real_time\": ");
+        if (name == std::string::npos || time == std::string::npos) continue;
+        const size_t begin = name + 9;
+        const size_t end = line.find('"', begin);
+        out[line.substr(begin, end - begin)] = std::atof(line.c_str() + time + 13);
+    }
+    return true;
+}
+
+// Prints every row that moved by more than the threshold and returns the
+// number of regressions
+size_t compare(const std::vector<Row>& rows, const std::map<std::string, double>& baseline, double threshold) {
+    size_t regressions = 0, matched = 0;
+    std::cerr << "\nComparison against baseline (threshold " << threshold << "%):\n";
+    for (const Row& r : rows) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second <= 0) continue;
+        ++matched;
+        const double change = (r.ns_per_op / it->second - 1) * 100;
+        if (change > threshold) {
+            ++regressions;
+        } else if (change >= -threshold) {
+            continue;
+        }
+        std::cerr << "  " << std::setw(32) << std::left << r.name << std::setw(12) << std::right
+                  << formatTime(it->second) << " -> " << std::setw(12) << formatTime(r.ns_per_op) << "  "
+                  << std::showpos << std::fixed << std::setprecision(1) << change << "%" << std::noshowpos
+                  << (change > threshold ? "  REGRESSION" : "  improved") << "\n";
+    }
+    std::cerr << "  " << matched << " rows compared, " << regressions << " regressions\n";
+    return regressions;
+}
+
+int usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " [--format console|json|csv] [--out FILE] [--filter TEXT]\n"
+              << "       [--min-bits N] [--max-bits N] [--min-time SECONDS]\n"
+              << "       [--baseline FILE] [--threshold PERCENT]\n";
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (arg == "--format" && (v = value())) opt.format = v;
+        else if (arg == "--out" && (v = value())) opt.out = v;
+        else if (arg == "--filter" && (v = value())) opt.filter = v;
+        else if (arg == "--baseline" && (v = value())) opt.baseline = v;
+        else if (arg == "--min-bits" && (v = value())) opt.min_bits = std::strtoull(v, nullptr, 10);
+        else if (arg == "--max-bits" && (v = value())) opt.max_bits = std::strtoull(v, nullptr, 10);
+        else if (arg == "--min-time" && (v = value())) opt.min_time = std::atof(v);
+        else if (arg == "--threshold" && (v = value())) opt.threshold = std::atof(v);
+        else return usage(argv[0]);
+    }
+    if (opt.format != "console" && opt.format != "json" && opt.format != "csv") return usage(argv[0]);
+
+    std::map<std::string, double> baseline;
+    if (!opt.baseline.empty() && !readBaseline(opt.baseline, baseline)) {
+        std::cerr << "bignum_bench: cannot read baseline " << opt.baseline << "\n";
+        return 2;
+    }
+
+    const bool console = opt.format == "console";
+    if (console) {
+        std::cout << "bignum_bench: kernels " << BigNum::kernels() << ", "
+                  << (BIGNUM_BENCH_TSC ? "TSC cycles" : "no cycle counter") << "\n";
+    }
+
+    // Bring the core up to its sustained clock before the first row
+    {
+        const BigNum a = BigNum::random(4096), b = BigNum::random(4096);
+        const auto until = Clock::now() + std::chrono::milliseconds(300);
+        while (Clock::now() < until) keep(a * b);
+    }
+
+    std::vector<Row> rows;
+    const BigNumTuning saved = BigNum::tuning();
+    for (const Case& c : cases()) {
+        for (size_t bits = 64; bits <= 65536; bits *= 2) {
+            if (bits < std::max(c.min_bits, opt.min_bits) || bits > std::min(c.max_bits, opt.max_bits)) continue;
+            const std::string name = c.op + "/" + c.tier + "/" + std::to_string(bits);
+            if (name.find(opt.filter) == std::string::npos) continue;
+
+            const size_t limbs = bits / 64;
+            auto op = c.make(bits);
+            BigNum::setTuning(c.tuning(limbs));
+            Row row = measure(op, opt.min_time);
+            BigNum::setTuning(saved);
+            row.name = name;
+            row.op = c.op;
+            row.tier = c.tier;
+            row.bits = bits;
+            row.limbs = limbs;
+            row.cycles_per_limb = row.cycles_per_op / limbs;
+            rows.push_back(row);
+            if (console) printRow(row);
+        }
+    }
+
+    if (!console) {
+        std::ofstream file;
+        if (!opt.out.empty()) {
+            file.open(opt.out);
+            if (!file) {
+                std::cerr << "bignum_bench: cannot write " << opt.out << "\n";
+                return 2;
+            }
+        }
+        std::ostream& os = opt.out.empty() ? std::cout : file;
+        if (opt.format == "json") writeJson(os, rows);
+        else writeCsv(os, rows);
+    }
+
+    if (!opt.baseline.empty() && compare(rows, baseline, opt.threshold) > 0) return 1;
+    return 0;
+}
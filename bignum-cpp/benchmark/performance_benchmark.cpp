@@ -1,4 +1,5 @@
 #include "bignum.h"
+#include "bignum_fixed.h"
 #include <iostream>
 #include <vector>
 #include <chrono>
@@ -7,6 +8,8 @@
 #include <functional>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
+#include <thread>
 
 // ANSI color codes for beautiful output
 #define RESET   "\033[0m"
@@ -46,17 +49,17 @@ private:
 public:
     void benchmark(const std::string& name, std::function<void()> func, double duration_seconds = 2.0) {
         std::vector<double> times;
-        auto start_benchmark = std::chrono::high_resolution_clock::now();
-        auto end_time = start_benchmark + std::chrono::duration<double>(duration_seconds);
         
         // Warmup runs
         for (int i = 0; i < 10; ++i) {
             func();
         }
         
-        // Actual benchmark runs
+        // Actual benchmark runs; at least one, however slow the operation
+        auto start_benchmark = std::chrono::high_resolution_clock::now();
+        auto end_time = start_benchmark + std::chrono::duration<double>(duration_seconds);
         int iterations = 0;
-        while (std::chrono::high_resolution_clock::now() < end_time) {
+        do {
             auto start = std::chrono::high_resolution_clock::now();
             func();
             auto end = std::chrono::high_resolution_clock::now();
@@ -64,7 +67,7 @@ public:
             double time_us = std::chrono::duration<double, std::micro>(end - start).count();
             times.push_back(time_us);
             iterations++;
-        }
+        } while (std::chrono::high_resolution_clock::now() < end_time);
         
         auto actual_duration = std::chrono::high_resolution_clock::now() - start_benchmark;
         double duration_ms = std::chrono::duration<double, std::milli>(actual_duration).count();
@@ -271,6 +274,67 @@ void benchmark_basic_arithmetic(CleanBenchmarkSuite& suite) {
     }, 2.0);
 }
 
+void benchmark_multiplication_tiers(CleanBenchmarkSuite& suite) {
+    suite.print_header("Multiplication Tiers (Karatsuba / Toom-3 / NTT)");
+    
+    // Each size runs with the top tier pinned, leaving the defaults below
+    // it, so the rows show where BIGNUM_TOOM3_THRESHOLD and
+    // BIGNUM_NTT_THRESHOLD should sit on this machine
+    const size_t never = static_cast<size_t>(-1);
+    const BigNumTuning defaults = BigNum::tuning();
+    BigNumTuning karatsuba = defaults, toom3 = defaults, ntt = defaults;
+    karatsuba.toom3_threshold = never;
+    karatsuba.ntt_threshold = never;
+    toom3.ntt_threshold = never;
+    ntt.ntt_threshold = 1;
+    
+    for (size_t limbs : {64, 160, 400, 2000, 8000}) {
+        BigNum a = BigNum::random(limbs * 64);
+        BigNum b = BigNum::random(limbs * 64);
+        std::string size = std::to_string(limbs) + "-limb Mul ";
+        double seconds = limbs >= 2000 ? 2.0 : 1.0;
+        
+        BigNum::setTuning(karatsuba);
+        suite.benchmark(size + "(Karatsuba)", [&a, &b]() { BigNum c = a * b; }, seconds);
+        toom3.toom3_threshold = std::min(limbs, defaults.toom3_threshold);
+        BigNum::setTuning(toom3);
+        suite.benchmark(size + "(Toom-3)", [&a, &b]() { BigNum c = a * b; }, seconds);
+        if (limbs >= 400) {
+            BigNum::setTuning(ntt);
+            suite.benchmark(size + "(NTT)", [&a, &b]() { BigNum c = a * b; }, seconds);
+        }
+    }
+    BigNum::setTuning(defaults);
+    
+    // Binary powering squares through every tier on the way up
+    suite.benchmark("3^100000 via pow", []() { BigNum c = BigNum(3).pow(100000); }, 2.0);
+}
+
+void benchmark_batch_modpow(CleanBenchmarkSuite& suite) {
+    suite.print_header("Batch ModPow Scaling");
+    
+    // 64 RSA-2048-sized private-key operations against four moduli, run at
+    // doubling thread counts up to the hardware concurrency
+    auto bases = generate_test_numbers(2048, 64);
+    auto exps = generate_test_numbers(2048, 64);
+    auto keys = generate_test_numbers(2048, 4);
+    std::vector<BigNum> mods;
+    for (size_t i = 0; i < bases.size(); ++i) {
+        mods.push_back(keys[i % keys.size()] | BigNum(1));
+    }
+    
+    const size_t saved = BigNum::threadCount();
+    const size_t hw = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t threads = 1;; threads = std::min(threads * 2, hw)) {
+        BigNum::setThreadCount(threads);
+        suite.benchmark("64 x 2048-bit ModPow (" + std::to_string(threads) + " threads)", [&]() {
+            auto results = BigNum::modPowBatch(bases, exps, mods);
+        }, 2.0);
+        if (threads == hw) break;
+    }
+    BigNum::setThreadCount(saved);
+}
+
 void benchmark_cryptographic_operations(CleanBenchmarkSuite& suite) {
     suite.print_header("Cryptographic Operations");
     
@@ -322,7 +386,8 @@ void benchmark_cryptographic_operations(CleanBenchmarkSuite& suite) {
         idx++;
     }, 3.0);
     
-    // Modular inverse (smaller numbers only)
+    // Modular inverse: binary algorithm for two-limb odd moduli, Lehmer's
+    // extended GCD above, Hensel lifting for 2^k
     suite.benchmark("128-bit Modular Inverse", [&bases_128, &moduli_128]() {
         static int idx = 0;
         try {
@@ -332,6 +397,90 @@ void benchmark_cryptographic_operations(CleanBenchmarkSuite& suite) {
         }
         idx++;
     }, 2.0);
+    
+    suite.benchmark("256-bit Modular Inverse", [&bases_256, &moduli_256]() {
+        static int idx = 0;
+        try {
+            BigNum result = bases_256[idx % 10].modInverse(moduli_256[idx % 5]);
+        } catch (...) {
+            // Skip if not invertible
+        }
+        idx++;
+    }, 2.0);
+    
+    auto bases_2048 = generate_test_numbers(2048, 10);
+    auto moduli_2048 = generate_test_numbers(2048, 5);
+    for (auto& mod : moduli_2048) {
+        if (mod.isEven()) mod += BigNum(1LL);
+    }
+    suite.benchmark("2048-bit Modular Inverse", [&bases_2048, &moduli_2048]() {
+        static int idx = 0;
+        try {
+            BigNum result = bases_2048[idx % 10].modInverse(moduli_2048[idx % 5]);
+        } catch (...) {
+            // Skip if not invertible
+        }
+        idx++;
+    }, 2.0);
+    
+    suite.benchmark("2048-bit Extended GCD", [&bases_2048]() {
+        static int idx = 0;
+        auto result = bases_2048[idx % 10].extendedGcd(bases_2048[(idx + 1) % 10]);
+        idx++;
+    }, 2.0);
+    
+    suite.benchmark("2048-bit Extended GCD (ScopedArena)", [&bases_2048]() {
+        static int idx = 0;
+        BigNum::ScopedArena arena;
+        auto result = bases_2048[idx % 10].extendedGcd(bases_2048[(idx + 1) % 10]);
+        idx++;
+    }, 2.0);
+    
+    // Field arithmetic on one modulus: ModArith keeps elements in Montgomery
+    // form, against the BigNum round trip through operator%
+    ModArith field(moduli_256[0]);
+    std::vector<ModArith::Element> elements_256;
+    for (const auto& b : bases_256) elements_256.push_back(field.element(b));
+    suite.benchmark("256-bit mulmod via operator%", [&bases_256, &moduli_256]() {
+        static int idx = 0;
+        BigNum result = (bases_256[idx % 10] * bases_256[(idx + 1) % 10]) % moduli_256[0];
+        idx++;
+    }, 2.0);
+    
+    suite.benchmark("256-bit ModArith mul (in place)", [&field, &elements_256]() {
+        static int idx = 0;
+        static ModArith::Element acc = field.one();
+        field.mul(acc, acc, elements_256[idx % 10]);
+        idx++;
+    }, 2.0);
+    
+    // The same product with the modulus width fixed at compile time
+    const FixedMontgomery<256> fixed_field{FixedBigNum<256>(moduli_256[0])};
+    std::vector<FixedBigNum<256>> fixed_256;
+    for (const auto& b : bases_256) fixed_256.push_back(fixed_field.toMontgomery(FixedBigNum<256>(b)));
+    suite.benchmark("256-bit FixedMontgomery mul", [&fixed_field, &fixed_256]() {
+        static int idx = 0;
+        static FixedBigNum<256> acc = fixed_field.one();
+        acc = fixed_field.mul(acc, fixed_256[idx % 10]);
+        idx++;
+    }, 2.0);
+    
+    suite.benchmark("256-bit ModArith batch inversion (x64)", [&field, &elements_256]() {
+        std::vector<ModArith::Element> xs;
+        for (int i = 0; i < 64; ++i) xs.push_back(elements_256[i % 10]);
+        try {
+            field.batchInv(xs);
+        } catch (...) {
+            // Skip if not invertible
+        }
+    }, 2.0);
+    
+    const BigNum power_2048 = BigNum(1) << 2048;
+    suite.benchmark("Inverse mod 2^2048", [&bases_2048, &power_2048]() {
+        static int idx = 0;
+        BigNum result = (bases_2048[idx % 10] | BigNum(1)).modInverse(power_2048);
+        idx++;
+    }, 2.0);
 }
 
 void benchmark_bit_operations(CleanBenchmarkSuite& suite) {
@@ -427,6 +576,22 @@ void benchmark_conversion_operations(CleanBenchmarkSuite& suite) {
         idx++;
     }, 2.0);
     
+    // Decimal conversion, from the chunked basecase up to the
+    // divide-and-conquer path
+    suite.benchmark("256-bit To Decimal String", [&nums_256]() {
+        static int idx = 0;
+        std::string dec = nums_256[idx % 20].toDecimalString();
+        idx++;
+    }, 2.0);
+    
+    for (size_t digits : {10000, 100000, 1000000}) {
+        BigNum big = BigNum::random(static_cast<size_t>(digits * 3.3219280948873623));
+        std::string dec = big.toDecimalString();
+        std::string size = std::to_string(digits) + "-digit ";
+        suite.benchmark(size + "To Decimal String", [&big]() { std::string s = big.toDecimalString(); }, 2.0);
+        suite.benchmark(size + "From Decimal String", [&dec]() { BigNum n = BigNum::fromDecimalString(dec); }, 2.0);
+    }
+    
     // Byte array conversion
     suite.benchmark("256-bit To Byte Array", [&nums_256]() {
         static int idx = 0;
@@ -439,6 +604,21 @@ void benchmark_conversion_operations(CleanBenchmarkSuite& suite) {
         auto bytes = nums_512[idx % 20].toByteArray();
         idx++;
     }, 2.0);
+    
+    // Caller-owned buffers, no allocation per call
+    suite.benchmark("256-bit To Hex Buffer", [&nums_256]() {
+        static int idx = 0;
+        char buf[72];
+        nums_256[idx % 20].toHexString(buf, sizeof(buf));
+        idx++;
+    }, 2.0);
+    
+    suite.benchmark("256-bit To 32 Bytes (big-endian)", [&nums_256]() {
+        static int idx = 0;
+        uint8_t buf[32];
+        nums_256[idx % 20].toBytes(buf, sizeof(buf));
+        idx++;
+    }, 2.0);
 }
 
 void benchmark_prime_operations(CleanBenchmarkSuite& suite) {
@@ -472,6 +652,32 @@ void benchmark_prime_operations(CleanBenchmarkSuite& suite) {
     suite.benchmark("96-bit Prime Generation", []() {
         BigNum prime = BigNum::randomPrime(96);
     }, 5.0);
+    
+    // Key-sized primes, one candidate at a time versus across the pool
+    suite.benchmark("1024-bit Prime Generation", []() {
+        BigNum prime = BigNum::randomPrime(1024);
+    }, 5.0);
+    
+    suite.benchmark("1024-bit Prime Generation (parallel)", []() {
+        BigNum prime = BigNum::randomPrime(1024, BigNum::Execution::Parallel);
+    }, 5.0);
+    
+    suite.benchmark("1024-bit Next Prime", [&candidates_128]() {
+        static int idx = 0;
+        BigNum prime = (candidates_128[idx % 20] << 896).nextPrime();
+        idx++;
+    }, 5.0);
+    
+    // 43-bit x 80-bit: just past Pollard rho, so ECM finds the small factor
+    BigNum semiprime = (BigNum(1) << 42).nextPrime() * (BigNum(1) << 80).nextPrime();
+    suite.benchmark("Factor 123-bit semiprime (rho + ECM)", [&semiprime]() {
+        auto factors = semiprime.factor();
+    }, 5.0);
+    
+    suite.benchmark("1024-bit Prime Generation (Baillie-PSW)", []() {
+        BigNum prime = BigNum::randomPrime(1024, BigNum::Execution::Sequential,
+                                           BigNum::PrimalityTest::BailliePSW);
+    }, 5.0);
 }
 
 int main() {
@@ -483,12 +689,15 @@ int main() {
     std::cout << "╚══════════════════════════════════════════════════════════════╝" RESET "\n";
     
     std::cout << YELLOW "\nTime-based benchmarking - each test runs for fixed duration" RESET "\n";
-    std::cout << YELLOW "Results show average time ± standard deviation and throughput" RESET "\n\n";
+    std::cout << YELLOW "Results show average time ± standard deviation and throughput" RESET "\n";
+    std::cout << YELLOW "Limb kernels: " << BigNum::kernels() << RESET "\n\n";
     
     try {
         // Run all benchmark categories
         benchmark_basic_arithmetic(suite);
+        benchmark_multiplication_tiers(suite);
         benchmark_cryptographic_operations(suite);
+        benchmark_batch_modpow(suite);
         benchmark_bit_operations(suite);
         benchmark_conversion_operations(suite);
         benchmark_prime_operations(suite);
@@ -0,0 +1,508 @@
+/**
+ * @file batch.cpp
+ * @brief Streaming batch mode of bignum-cli.
+ *
+ * Input is one operation per line: a name followed by hexadecimal operands,
+ * separated by spaces or tabs,
+ *
+ *   modpow 3 10001 c5f1...
+ *   mul ff -1a2b
+ *   isprime 61 = 1
+ *
+ * and each line produces exactly one output line, so results stay aligned
+ * with their inputs. Blank lines and '#' comments are copied through. A line
+ * may end in `= <expected ...>`; it then prints `ok` or `FAIL <result>`,
+ * which is how test vectors and key audits are checked in bulk. Operations
+ * that fail print `error: <message>`.
+ *
+ * The work runs as a three-stage pipeline. The reading thread splits the
+ * input into chunks of lines, straight from a memory mapping when the
+ * input is a regular file on a POSIX system and from fixed-size reads of
+ * the stream otherwise. Worker threads parse and evaluate whole chunks,
+ * serialising into per-chunk buffers with hexLength()/toHexString(char*).
+ * A writer thread emits the chunks in input order. At most a few chunks
+ * per worker are in flight, so memory stays bounded however long the input.
+ */
+
+#include "batch.h"
+#include "bignum.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BIGNUM_CLI_MMAP 1
+#else
+#define BIGNUM_CLI_MMAP 0
+#endif
+
+namespace {
+
+// --- Operations ---
+
+void appendHex(std::string& out, const BigNum& x) {
+    const size_t pos = out.size();
+    const size_t n = x.hexLength();
+    out.resize(pos + n);
+    x.toHexString(&out[pos], n);
+}
+
+void appendText(std::string& out, const char* text) {
+    out += text;
+}
+
+struct Operation {
+    const char* name;
+    size_t arity;     // Operands taken; variadic operations give their minimum
+    bool variadic;
+    const char* help;
+    void (*run)(const std::vector<BigNum>& args, std::string& out);
+};
+
+const Operation OPERATIONS[] = {
+    {"add", 2, false, "a b       a + b",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0] + a[1]); }},
+    {"sub", 2, false, "a b       a - b",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0] - a[1]); }},
+    {"mul", 2, false, "a b       a * b",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0] * a[1]); }},
+    {"sqr", 1, false, "a         a^2",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0].square()); }},
+    {"div", 2, false, "a b       quotient and remainder",
+     [](const std::vector<BigNum>& a, std::string& out) {
+         appendHex(out, a[0] / a[1]);
+         out += ' ';
+         appendHex(out, a[0] % a[1]);
+     }},
+    {"mod", 2, false, "a m       a % m",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0] % a[1]); }},
+    {"mulmod", 3, false, "a b m     a * b mod m",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, BigNum::mulMod(a[0], a[1], a[2])); }},
+    {"modpow", 3, false, "b e m     b^e mod m",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0].modPow(a[1], a[2])); }},
+    {"modpowprod", 3, true, "b1 e1 ... m  b1^e1 * b2^e2 * ... mod m",
+     [](const std::vector<BigNum>& a, std::string& out) {
+         if (a.size() % 2 == 0) throw std::invalid_argument("modpowprod takes base/exponent pairs and a modulus");
+         std::vector<BigNum> bases, exps;
+         for (size_t i = 0; i + 1 < a.size(); i += 2) {
+             bases.push_back(a[i]);
+             exps.push_back(a[i + 1]);
+         }
+         appendHex(out, BigNum::modPowProduct(bases, exps, a.back()));
+     }},
+    {"modinv", 2, false, "a m       a^-1 mod m",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0].modInverse(a[1])); }},
+    {"gcd", 2, false, "a b       gcd(a, b)",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0].gcd(a[1])); }},
+    {"cmp", 2, false, "a b       -1, 0 or 1",
+     [](const std::vector<BigNum>& a, std::string& out) {
+         appendText(out, a[0] < a[1] ? "-1" : a[0] == a[1] ? "0" : "1");
+     }},
+    {"isprime", 1, false, "n         1 if n is probably prime, else 0",
+     [](const std::vector<BigNum>& a, std::string& out) { appendText(out, a[0].isProbablePrime() ? "1" : "0"); }},
+    {"nextprime", 1, false, "n         smallest prime above n",
+     [](const std::vector<BigNum>& a, std::string& out) { appendHex(out, a[0].nextPrime()); }},
+    {"factor", 1, false, "n         prime factors, ascending",
+     [](const std::vector<BigNum>& a, std::string& out) {
+         const std::vector<BigNum> factors = a[0].factor();
+         for (size_t i = 0; i < factors.size(); ++i) {
+             if (i) out += ' ';
+             appendHex(out, factors[i]);
+         }
+     }},
+    {"rsacrt", 6, false, "c p q dP dQ qInv  c^d mod pq by CRT",
+     [](const std::vector<BigNum>& a, std::string& out) {
+         appendHex(out, RSACRTContext(a[1], a[2], a[3], a[4], a[5]).modPow(a[0]));
+     }},
+    {"dec", 1, false, "a         a in decimal",
+     [](const std::vector<BigNum>& a, std::string& out) { out += a[0].toDecimalString(); }},
+};
+
+const Operation* findOperation(std::string_view name) {
+    for (const Operation& op : OPERATIONS) {
+        if (name == op.name) return &op;
+    }
+    return nullptr;
+}
+
+// --- Evaluation ---
+
+struct Chunk {
+    size_t seq = 0;
+    std::vector<char> storage;            // Bytes read from a stream, unused for a mapping;
+                                          // not a string, whose inline buffer would move
+    std::vector<std::string_view> lines;  // Without their newlines
+    std::string out;
+    size_t failed = 0;                    // "= expected" lines that did not match
+    size_t errors = 0;
+};
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Same hexadecimal value, or the same text for non-numeric results: case,
+// a 0x prefix and leading zeros are ignored
+bool sameValue(std::string_view a, std::string_view b) {
+    auto canonical = [](std::string_view s) {
+        bool neg = !s.empty() && s[0] == '-';
+        if (neg) s.remove_prefix(1);
+        if (s.size() >= 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) s.remove_prefix(2);
+        while (s.size() > 1 && s[0] == '0') s.remove_prefix(1);
+        return std::make_pair(neg && s != "0", s);
+    };
+    auto [an, av] = canonical(a);
+    auto [bn, bv] = canonical(b);
+    return an == bn && av.size() == bv.size() &&
+           std::equal(av.begin(), av.end(), bv.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+// Scratch reused across the lines of a worker
+struct LineScratch {
+    std::vector<std::string_view> tokens;
+    std::vector<BigNum> args;
+    std::string result;
+};
+
+void evaluateLine(std::string_view line, Chunk& chunk, LineScratch& s) {
+    std::string& out = chunk.out;
+    while (!line.empty() && isBlank(line.back())) line.remove_suffix(1);
+    size_t start = 0;
+    while (start < line.size() && isBlank(line[start])) ++start;
+    if (start == line.size() || line[start] == '#') {
+        out += line;
+        out += '\n';
+        return;
+    }
+
+    s.tokens.clear();
+    for (size_t i = start; i < line.size();) {
+        size_t j = i;
+        while (j < line.size() && !isBlank(line[j])) ++j;
+        s.tokens.push_back(line.substr(i, j - i));
+        while (j < line.size() && isBlank(line[j])) ++j;
+        i = j;
+    }
+    const size_t eq = std::find(s.tokens.begin(), s.tokens.end(), "=") - s.tokens.begin();
+    const bool verify = eq < s.tokens.size();
+
+    try {
+        const Operation* op = findOperation(s.tokens[0]);
+        if (!op) throw std::invalid_argument("unknown operation '" + std::string(s.tokens[0]) + "'");
+        const size_t given = eq - 1;
+        if (op->variadic ? given < op->arity : given != op->arity) {
+            throw std::invalid_argument(std::string(op->name) + " takes " + (op->variadic ? "at least " : "") +
+                                        std::to_string(op->arity) + " operand(s)");
+        }
+        s.args.clear();
+        for (size_t i = 1; i < eq; ++i) s.args.push_back(BigNum::fromHexString(s.tokens[i]));
+
+        if (!verify) {
+            op->run(s.args, out);
+            out += '\n';
+            return;
+        }
+        s.result.clear();
+        op->run(s.args, s.result);
+
+        // Compare token by token with what follows '='
+        bool match = true;
+        size_t t = eq + 1;
+        for (size_t i = 0; match && i <= s.result.size();) {
+            size_t j = s.result.find(' ', i);
+            if (j == std::string::npos) j = s.result.size();
+            match = t < s.tokens.size() && sameValue(std::string_view(s.result).substr(i, j - i), s.tokens[t++]);
+            i = j + 1;
+        }
+        match = match && t == s.tokens.size();
+        if (match) {
+            out += "ok\n";
+        } else {
+            ++chunk.failed;
+            out += "FAIL ";
+            out += s.result;
+            out += '\n';
+        }
+    } catch (const std::exception& e) {
+        ++chunk.errors;
+        out += "error: ";
+        out += e.what();
+        out += '\n';
+    }
+}
+
+// --- Pipeline ---
+
+struct Totals {
+    size_t lines = 0;
+    size_t failed = 0;
+    size_t errors = 0;
+    bool writeFailed = false;
+};
+
+class Pipeline {
+public:
+    Pipeline(size_t threads, std::FILE* output) : output(output), window(4 * threads) {
+        for (size_t i = 0; i < threads; ++i) workers.emplace_back([this] { work(); });
+        writer = std::thread([this] { write(); });
+    }
+
+    // Queues a chunk, blocking while `window` chunks are still in flight
+    void submit(Chunk chunk) {
+        std::unique_lock<std::mutex> guard(lock);
+        slotFree.wait(guard, [this] { return inFlight < window; });
+        chunk.seq = submitted++;
+        ++inFlight;
+        totals.lines += chunk.lines.size();
+        pending.push_back(std::move(chunk));
+        workReady.notify_one();
+    }
+
+    // Waits for every submitted chunk to be written
+    Totals finish() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        workReady.notify_all();
+        doneReady.notify_all();
+        for (std::thread& t : workers) t.join();
+        writer.join();
+        return totals;
+    }
+
+private:
+    void work() {
+        LineScratch scratch;
+        for (;;) {
+            Chunk chunk;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                workReady.wait(guard, [this] { return !pending.empty() || closed; });
+                if (pending.empty()) return;
+                chunk = std::move(pending.front());
+                pending.pop_front();
+            }
+            for (std::string_view line : chunk.lines) evaluateLine(line, chunk, scratch);
+            std::lock_guard<std::mutex> guard(lock);
+            totals.failed += chunk.failed;
+            totals.errors += chunk.errors;
+            done.emplace(chunk.seq, std::move(chunk));
+            doneReady.notify_one();
+        }
+    }
+
+    void write() {
+        for (size_t seq = 0;; ++seq) {
+            Chunk chunk;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                doneReady.wait(guard, [&] { return done.count(seq) || (closed && seq == submitted); });
+                auto it = done.find(seq);
+                if (it == done.end()) break;
+                chunk = std::move(it->second);
+                done.erase(it);
+            }
+            if (std::fwrite(chunk.out.data(), 1, chunk.out.size(), output) != chunk.out.size()) {
+                totals.writeFailed = true;
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            --inFlight;
+            slotFree.notify_one();
+        }
+        std::fflush(output);
+    }
+
+    std::FILE* output;
+    const size_t window;
+    std::mutex lock;
+    std::condition_variable workReady, doneReady, slotFree;
+    std::deque<Chunk> pending;
+    std::map<size_t, Chunk> done;
+    size_t submitted = 0;
+    size_t inFlight = 0;
+    bool closed = false;
+    Totals totals;
+    std::vector<std::thread> workers;
+    std::thread writer;
+};
+
+// Submits [p, end), which holds whole lines (the last one may lack its
+// newline), as chunks of up to `chunkLines` lines. Copies the bytes into
+// the chunks unless the range outlives the pipeline, as a mapping does.
+void submitLines(Pipeline& pipeline, const char* p, const char* end, size_t chunkLines, bool copy) {
+    while (p < end) {
+        Chunk chunk;
+        const char* first = p;
+        std::vector<std::pair<size_t, size_t>> spans;
+        while (p < end && spans.size() < chunkLines) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* stop = nl ? nl : end;
+            spans.emplace_back(p - first, stop - p);
+            p = nl ? nl + 1 : end;
+        }
+        const char* base = first;
+        if (copy) {
+            chunk.storage.assign(first, p);
+            base = chunk.storage.data();
+        }
+        chunk.lines.reserve(spans.size());
+        for (auto [offset, length] : spans) chunk.lines.emplace_back(base + offset, length);
+        pipeline.submit(std::move(chunk));
+    }
+}
+
+void submitStream(Pipeline& pipeline, std::FILE* in, size_t chunkLines) {
+    constexpr size_t BLOCK = size_t(1) << 20;
+    std::string buffer;
+    size_t filled = 0;
+    for (;;) {
+        buffer.resize(filled + BLOCK);
+        const size_t got = std::fread(&buffer[filled], 1, BLOCK, in);
+        filled += got;
+        if (got == 0) break;
+        // Hand over the complete lines and keep the partial last one
+        const char* data = buffer.data();
+        const void* last = nullptr;
+        for (size_t i = filled; i-- > 0;) {
+            if (data[i] == '\n') {
+                last = data + i;
+                break;
+            }
+        }
+        if (!last) continue;
+        const size_t whole = static_cast<const char*>(last) - data + 1;
+        submitLines(pipeline, data, data + whole, chunkLines, true);
+        buffer.erase(0, whole);
+        filled -= whole;
+    }
+    submitLines(pipeline, buffer.data(), buffer.data() + filled, chunkLines, true);
+}
+
+// Read-only view of a whole file. Stays empty (and the caller streams the
+// file instead) for anything but a non-empty regular file on POSIX.
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) {
+#if BIGNUM_CLI_MMAP
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                madvise(map, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                data = static_cast<const char*>(map);
+                size = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+#else
+        (void)path;
+#endif
+    }
+
+    ~MappedFile() {
+#if BIGNUM_CLI_MMAP
+        if (data) munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+}  // namespace
+
+void printBatchUsage() {
+    std::printf("usage: bignum-cli --batch [FILE|-] [--threads N] [--chunk LINES]\n\n"
+                "Reads one operation per line from FILE (memory-mapped) or stdin and\n"
+                "prints one result per line, in input order. Operands and results are\n"
+                "hexadecimal. Append '= <expected>' to a line to check it instead:\n"
+                "it prints 'ok' or 'FAIL <result>'. Blank lines and '#' comments are\n"
+                "copied through.\n\nOperations:\n");
+    for (const Operation& op : OPERATIONS) std::printf("  %-11s %s\n", op.name, op.help);
+}
+
+int runBatch(int argc, char** argv) {
+    std::string path = "-";
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkLines = 64;
+    for (int i = 0; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto count = [&](size_t& target) {
+            const long value = i + 1 < argc ? std::strtol(argv[++i], nullptr, 10) : 0;
+            if (value <= 0) return false;
+            target = static_cast<size_t>(value);
+            return true;
+        };
+        if (arg == "--help" || arg == "-h") {
+            printBatchUsage();
+            return 0;
+        } else if (arg == "--threads" || arg == "--chunk") {
+            if (!count(arg == "--threads" ? threads : chunkLines)) {
+                std::fprintf(stderr, "bignum-cli: %s needs a positive number\n", arg.c_str());
+                return 2;
+            }
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::fprintf(stderr, "bignum-cli: unknown option %s\n", arg.c_str());
+            printBatchUsage();
+            return 2;
+        } else {
+            path = arg;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool isStdin = path == "-";
+    // Declared before the pipeline: chunks of a mapping point into it
+    MappedFile mapped(isStdin ? "" : path.c_str());
+    std::FILE* in = stdin;
+    if (!isStdin && !mapped.data) {
+        in = std::fopen(path.c_str(), "rb");
+        if (!in) {
+            std::fprintf(stderr, "bignum-cli: cannot open %s: %s\n", path.c_str(), std::strerror(errno));
+            return 1;
+        }
+    }
+
+    Pipeline pipeline(threads, stdout);
+    if (mapped.data) {
+        submitLines(pipeline, mapped.data, mapped.data + mapped.size, chunkLines, false);
+    } else {
+        submitStream(pipeline, in, chunkLines);
+    }
+    const Totals totals = pipeline.finish();
+    const bool readFailed = !mapped.data && std::ferror(in);
+    if (in != stdin) std::fclose(in);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "bignum-cli: %zu line(s), %zu failed, %zu error(s) in %.3f s on %zu thread(s)\n",
+                 totals.lines, totals.failed, totals.errors, seconds, threads);
+    if (readFailed) std::fprintf(stderr, "bignum-cli: read error on %s\n", isStdin ? "stdin" : path.c_str());
+    if (totals.writeFailed) std::fprintf(stderr, "bignum-cli: write error on stdout\n");
+    return totals.failed || totals.errors || readFailed || totals.writeFailed ? 1 : 0;
+}
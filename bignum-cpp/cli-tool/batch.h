@@ -0,0 +1,21 @@
+/**
+ * @file batch.h
+ * @brief Non-interactive batch mode of bignum-cli.
+ *
+ * `bignum-cli --batch [FILE]` evaluates one operation per line, such as
+ * `modpow <b> <e> <m>`, and prints one result line per input line in
+ * input order. See batch.cpp for the operations and the pipeline.
+ */
+
+#ifndef BIGNUM_CLI_BATCH_H
+#define BIGNUM_CLI_BATCH_H
+
+// Runs batch mode with the arguments that follow --batch and returns the
+// process exit status: 0 when every line evaluated (and matched its
+// expected value, if given), 1 otherwise, 2 for a usage error
+int runBatch(int argc, char** argv);
+
+// Usage text for --help
+void printBatchUsage();
+
+#endif // BIGNUM_CLI_BATCH_H
@@ -10,8 +10,12 @@
  *
  * All numerical inputs for BigNum objects must be provided in
  * hexadecimal format (e.g., "ff", "0x1A2B", "-DEADBEEF").
+ *
+ * `bignum-cli --batch [FILE]` skips the menu and evaluates a file or stdin
+ * of one-line operations instead; see batch.cpp.
  */
 
+#include "batch.h"
 #include "bignum.h"
 #include <iostream>
 #include <string>
@@ -288,6 +292,43 @@ void handleGeneration() {
     }
 }
 
+void handleStats() {
+    printHeader("15. Library Statistics");
+    const BigNumStats s = BigNum::stats();
+    if (!s.enabled) {
+        std::cout << YELLOW << "  Operation counters are off in this build." << RESET << std::endl;
+        std::cout << "  Configure with " << GREEN << "-DBIGNUM_STATS=ON" << RESET << " to collect them." << std::endl;
+        return;
+    }
+
+    std::cout << "  " << std::left << std::setw(22) << "Operation" << std::right << std::setw(10) << "Calls"
+              << std::setw(14) << "Total time" << "   Sizes (limbs: calls)" << std::endl;
+    std::cout << "  ──────────────────────────────────────────────────" << std::endl;
+    for (size_t i = 0; i < BigNumStats::OpCount; ++i) {
+        const BigNumStats::Counter& c = s.ops[i];
+        if (!c.calls) continue;
+        std::ostringstream sizes;
+        for (size_t b = 0; b < BigNumStats::SIZE_BUCKETS; ++b) {
+            if (c.limbs[b]) sizes << " " << (size_t(1) << b) << (b + 1 == BigNumStats::SIZE_BUCKETS ? "+" : "") << ":" << c.limbs[b];
+        }
+        std::cout << "  " << GREEN << std::left << std::setw(22) << BigNumStats::name(static_cast<BigNumStats::Op>(i))
+                  << RESET << std::right << std::setw(10) << c.calls << std::setw(11) << std::fixed
+                  << std::setprecision(3) << c.nanoseconds / 1e6 << " ms  " << sizes.str() << std::endl;
+    }
+    std::cout << "  ──────────────────────────────────────────────────" << std::endl;
+    std::cout << GREEN << "  > Heap limb buffers:  " << RESET << s.heap_allocations << " (" << s.heap_bytes << " bytes)" << std::endl;
+    std::cout << GREEN << "  > Arena limb buffers: " << RESET << s.arena_allocations << " (" << s.arena_bytes << " bytes)" << std::endl;
+    std::cout << GREEN << "  > Limb memory now:    " << RESET << s.live_bytes << " bytes, peak " << s.peak_live_bytes << std::endl;
+
+    std::cout << CYAN << "\n  > Reset the counters? (y/N): " << RESET;
+    std::string answer;
+    std::cin >> answer;
+    if (answer == "y" || answer == "Y") {
+        BigNum::resetStats();
+        std::cout << YELLOW << "  Counters reset." << RESET << std::endl;
+    }
+}
+
 void printMenu() {
     printHeader("Main Menu");
     std::cout << "  " << MAGENTA << "--- Basic Arithmetic ---" << RESET << std::endl;
@@ -308,13 +349,26 @@ void printMenu() {
     std::cout << "  " << GREEN << "13."<< RESET << " To/From Byte Array" << std::endl;
     std::cout << "  " << MAGENTA << "--- Generation ---" << RESET << std::endl;
     std::cout << "  " << GREEN << "14."<< RESET << " Random Number & Prime Generation" << std::endl;
+    std::cout << "  " << GREEN << "15."<< RESET << " Library Statistics" << std::endl;
     std::cout << "  ──────────────────────────────────────────────────" << std::endl;
     std::cout << "  " << RED   << "0." << RESET << " Exit" << std::endl;
     std::cout << CYAN << "\n  Enter your choice: " << RESET;
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        const std::string mode = argv[1];
+        if (mode == "--batch") return runBatch(argc - 2, argv + 2);
+        if (mode == "--help" || mode == "-h") {
+            std::cout << "usage: " << argv[0] << "            interactive menu" << std::endl;
+            printBatchUsage();
+            return 0;
+        }
+        std::cerr << argv[0] << ": unknown option " << mode << " (try --help)" << std::endl;
+        return 2;
+    }
+
     printHeader("BigNum Interactive CLI Calculator");
     std::cout << "Welcome! This program provides an interactive shell to use the" << std::endl;
     std::cout << "BigNum library, much like tools such as PARI/GP." << std::endl;
@@ -352,6 +406,7 @@ int main() {
             case 12: handlePrimalityTest(); break;
             case 13: handleConversion();    break;
             case 14: handleGeneration();    break;
+            case 15: handleStats();         break;
             case 0: running = false;        continue; // Skip the final pause
             default:
                 std::cout << RED << "\n  [!] Unknown option. Please try again." << RESET << std::endl;
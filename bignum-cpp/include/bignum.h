@@ -4,6 +4,16 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 
 // Check for 128-bit integer support
 #if defined(__SIZEOF_INT128__) || (defined(_INTEGRAL_MAX_BITS) && _INTEGRAL_MAX_BITS >= 128)
@@ -12,43 +22,315 @@
     #error "This implementation requires 128-bit integer support for 64-bit radix"
 #endif
 
+// Number of limbs a BigNum keeps inline before spilling to the heap
+#ifndef BIGNUM_INLINE_LIMBS
+#define BIGNUM_INLINE_LIMBS 4
+#endif
+
+// Default algorithm crossover points, in limbs. Override at build time with
+// -DBIGNUM_KARATSUBA_THRESHOLD=... or a header generated by bignum-tune
+// (-DBIGNUM_TUNING_HEADER="path"), or at run time with BigNum::setTuning().
+#ifdef BIGNUM_TUNING_HEADER
+#include BIGNUM_TUNING_HEADER
+#endif
+#ifndef BIGNUM_KARATSUBA_THRESHOLD
+#define BIGNUM_KARATSUBA_THRESHOLD 24
+#endif
+#ifndef BIGNUM_KARATSUBA_SQR_THRESHOLD
+#define BIGNUM_KARATSUBA_SQR_THRESHOLD 40
+#endif
+#ifndef BIGNUM_TOOM3_THRESHOLD
+#define BIGNUM_TOOM3_THRESHOLD 150
+#endif
+#ifndef BIGNUM_NTT_THRESHOLD
+#define BIGNUM_NTT_THRESHOLD 6000
+#endif
+#ifndef BIGNUM_MONTGOMERY_THRESHOLD
+#define BIGNUM_MONTGOMERY_THRESHOLD 4
+#endif
+#ifndef BIGNUM_BARRETT_THRESHOLD
+#define BIGNUM_BARRETT_THRESHOLD 8
+#endif
+#ifndef BIGNUM_DECIMAL_THRESHOLD
+#define BIGNUM_DECIMAL_THRESHOLD 40
+#endif
+
+// Runtime algorithm thresholds (all in limbs of the smaller operand or of
+// the modulus). The bignum-tune tool measures suitable values for a host.
+struct BigNumTuning {
+    size_t karatsuba_threshold = BIGNUM_KARATSUBA_THRESHOLD;          // Karatsuba multiply from here
+    size_t karatsuba_sqr_threshold = BIGNUM_KARATSUBA_SQR_THRESHOLD;  // Karatsuba squaring from here
+    size_t toom3_threshold = BIGNUM_TOOM3_THRESHOLD;                  // Toom-3 multiply and square from here
+    size_t ntt_threshold = BIGNUM_NTT_THRESHOLD;                      // NTT multiply and square from here
+    size_t montgomery_threshold = BIGNUM_MONTGOMERY_THRESHOLD;        // Montgomery modPow from here
+    size_t barrett_threshold = BIGNUM_BARRETT_THRESHOLD;              // Barrett reduction from here
+    size_t decimal_threshold = BIGNUM_DECIMAL_THRESHOLD;              // Divide-and-conquer decimal conversion from here
+};
+
+// Operation counters. They are collected only when the library is built
+// with BIGNUM_STATS (CMake -DBIGNUM_STATS=ON); otherwise `enabled` is false
+// and every field reads zero. Times are inclusive, so a modPow's time also
+// holds its products', and a multiplication is filed under the tier chosen
+// for its top level.
+struct BigNumStats {
+    enum Op : size_t {
+        MulBasecase, MulKaratsuba, MulToom3, MulNtt,
+        SqrBasecase, SqrKaratsuba, SqrLarge,   // SqrLarge: Toom-3 and NTT
+        Division,
+        ModPowMontgomery, ModPowBarrett, ModPowBinary, ModPowConstantTime,
+        ModPowFallback,                        // Montgomery setup failed, binary method used
+        ModPowProduct, ModPowCrt,
+        MontgomeryContext, BarrettContext,
+        BarrettFallback,                       // Barrett setup failed, operator% used
+        Gcd, ExtendedGcd, ModInverse,
+        ToDecimal, FromDecimal,
+        PrimalityTest, RandomPrime, Factor,
+        OpCount
+    };
+    
+    // Bucket i counts calls whose operand has [2^i, 2^(i+1)) limbs (the
+    // smaller factor, the divisor or the modulus); the last bucket is open
+    static constexpr size_t SIZE_BUCKETS = 16;
+    
+    struct Counter {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t limbs[SIZE_BUCKETS] = {};
+    };
+    
+    bool enabled = false;
+    Counter ops[OpCount];
+    // Spilled limb buffers: from the heap, or carved from a ScopedArena
+    uint64_t heap_allocations = 0;
+    uint64_t heap_bytes = 0;
+    uint64_t arena_allocations = 0;
+    uint64_t arena_bytes = 0;
+    // Limb memory held right now (heap buffers and arena chunks) and its
+    // high-water mark since the last reset
+    uint64_t live_bytes = 0;
+    uint64_t peak_live_bytes = 0;
+    
+    static const char* name(Op op);
+    std::string toJson() const;
+};
+
 // Forward declarations for optimization contexts
 class MontgomeryContext;
 class BarrettContext;
 
+namespace bignum {
+class ThreadPool;
+}
+
+// Contiguous limb storage with a small inline buffer.
+// Values up to INLINE_CAPACITY limbs live inside the object itself; larger
+// values spill to a heap block, or to the innermost BigNum::ScopedArena of
+// the thread when one is active. The interface mirrors the subset of
+// std::vector<uint64_t> that BigNum needs.
+class LimbVector {
+public:
+    static constexpr size_t INLINE_CAPACITY = BIGNUM_INLINE_LIMBS;
+    
+    using value_type = uint64_t;
+    using iterator = uint64_t*;
+    using const_iterator = const uint64_t*;
+    
+    LimbVector() noexcept : ptr(inline_buf), count(0), cap(INLINE_CAPACITY) {}
+    
+    explicit LimbVector(size_t n, uint64_t value = 0) : LimbVector() {
+        assign(n, value);
+    }
+    
+    LimbVector(std::initializer_list<uint64_t> init) : LimbVector() {
+        assign(init.begin(), init.end());
+    }
+    
+    LimbVector(const uint64_t* first, const uint64_t* last) : LimbVector() {
+        assign(first, last);
+    }
+    
+    LimbVector(const std::vector<uint64_t>& v) : LimbVector() {
+        assign(v.data(), v.data() + v.size());
+    }
+    
+    LimbVector(const LimbVector& other) : LimbVector() {
+        assign(other.begin(), other.end());
+    }
+    
+    LimbVector(LimbVector&& other) noexcept : LimbVector() {
+        steal(other);
+    }
+    
+    LimbVector& operator=(const LimbVector& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+    
+    LimbVector& operator=(LimbVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+    
+    ~LimbVector() { release(); }
+    
+    // Capacity
+    size_t size() const noexcept { return count; }
+    size_t capacity() const noexcept { return cap; }
+    bool empty() const noexcept { return count == 0; }
+    bool isInline() const noexcept { return ptr == inline_buf; }
+    
+    void reserve(size_t n) {
+        if (n > cap) grow(n);
+    }
+    
+    // Element access
+    uint64_t* data() noexcept { return ptr; }
+    const uint64_t* data() const noexcept { return ptr; }
+    uint64_t& operator[](size_t i) noexcept { return ptr[i]; }
+    const uint64_t& operator[](size_t i) const noexcept { return ptr[i]; }
+    uint64_t& front() noexcept { return ptr[0]; }
+    const uint64_t& front() const noexcept { return ptr[0]; }
+    uint64_t& back() noexcept { return ptr[count - 1]; }
+    const uint64_t& back() const noexcept { return ptr[count - 1]; }
+    
+    iterator begin() noexcept { return ptr; }
+    iterator end() noexcept { return ptr + count; }
+    const_iterator begin() const noexcept { return ptr; }
+    const_iterator end() const noexcept { return ptr + count; }
+    
+    // Modifiers
+    void clear() noexcept { count = 0; }
+    
+    void resize(size_t n, uint64_t value = 0) {
+        if (n > cap) grow(n);
+        for (size_t i = count; i < n; ++i) ptr[i] = value;
+        count = n;
+    }
+    
+    void assign(size_t n, uint64_t value) {
+        count = 0;
+        resize(n, value);
+    }
+    
+    void assign(const uint64_t* first, const uint64_t* last) {
+        size_t n = static_cast<size_t>(last - first);
+        if (n > cap) {
+            count = 0;
+            grow(n);
+        }
+        if (n) std::memmove(ptr, first, n * sizeof(uint64_t));
+        count = n;
+    }
+    
+    void push_back(uint64_t value) {
+        if (count == cap) grow(count + 1);
+        ptr[count++] = value;
+    }
+    
+    void pop_back() noexcept { --count; }
+    
+    void swap(LimbVector& other) noexcept {
+        LimbVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+    
+    std::vector<uint64_t> toVector() const {
+        return std::vector<uint64_t>(begin(), end());
+    }
+    
+    friend bool operator==(const LimbVector& a, const LimbVector& b) {
+        return a.count == b.count &&
+               (a.count == 0 || std::memcmp(a.ptr, b.ptr, a.count * sizeof(uint64_t)) == 0);
+    }
+    friend bool operator!=(const LimbVector& a, const LimbVector& b) { return !(a == b); }
+    friend bool operator==(const LimbVector& a, const std::vector<uint64_t>& b) {
+        return a.count == b.size() &&
+               (a.count == 0 || std::memcmp(a.ptr, b.data(), a.count * sizeof(uint64_t)) == 0);
+    }
+    friend bool operator==(const std::vector<uint64_t>& a, const LimbVector& b) { return b == a; }
+    friend bool operator!=(const LimbVector& a, const std::vector<uint64_t>& b) { return !(a == b); }
+    friend bool operator!=(const std::vector<uint64_t>& a, const LimbVector& b) { return !(b == a); }
+    
+private:
+    uint64_t* ptr;
+    size_t count;
+    size_t cap;
+    uint64_t inline_buf[INLINE_CAPACITY];
+    
+    void grow(size_t minCapacity);
+    void release() noexcept;
+    
+    // Takes over other's contents and leaves it empty
+    void steal(LimbVector& other) noexcept {
+        if (other.isInline()) {
+            std::memcpy(inline_buf, other.inline_buf, other.count * sizeof(uint64_t));
+            ptr = inline_buf;
+            cap = INLINE_CAPACITY;
+        } else {
+            ptr = other.ptr;
+            cap = other.cap;
+            other.ptr = other.inline_buf;
+            other.cap = INLINE_CAPACITY;
+        }
+        count = other.count;
+        other.count = 0;
+    }
+};
+
 class BigNum {
 private:
-    std::vector<uint64_t> digits;  // Little-endian representation
+    LimbVector digits;  // Little-endian representation
     bool negative;
     static const uint32_t BASE_BITS = 64;
     
-    // Algorithm thresholds
-    static const size_t KARATSUBA_THRESHOLD = 8;    // Switch to Karatsuba above this digit count
-    static const size_t MONTGOMERY_THRESHOLD = 4;   // Use Montgomery for modpow above this size
-    static const size_t BARRETT_THRESHOLD = 8;      // Use Barrett reduction above this size
-    
     // Helper functions
+    static BigNum withCapacity(size_t limbs);
+    static void addSigned(BigNum& r, const BigNum& a, const BigNum& b, bool bNegative);
     void removeLeadingZeros();
     int compare(const BigNum& other) const;
+    int compareAbs(const BigNum& other) const;
     BigNum addUnsigned(const BigNum& other) const;
     BigNum subtractUnsigned(const BigNum& other) const;
     BigNum multiplyUnsigned(const BigNum& other) const;
     std::pair<BigNum, BigNum> divideUnsigned(const BigNum& divisor) const;
+    void accumulateProduct(const BigNum& a, const BigNum& b, bool subtract);
     
     // Optimized multiplication algorithms
-    BigNum multiplyKaratsuba(const BigNum& other) const;
+    BigNum multiplyLarge(const BigNum& other) const;  // Karatsuba, Toom-3 or NTT
     BigNum multiplySchoolbook(const BigNum& other) const;
     
     // Optimized modular arithmetic
     BigNum modPowMontgomery(const BigNum& exponent, const BigNum& modulus) const;
     BigNum modPowBinary(const BigNum& exponent, const BigNum& modulus) const;
     
+    // Lehmer's algorithm: Euclid steps are simulated on the leading 62 bits
+    // and applied to the full values as one word-sized cofactor matrix.
+    // a, b >= 0; fills s and t, when non-null, so that a s + b t = gcd.
+    static BigNum lehmerGcd(BigNum a, BigNum b, BigNum* s, BigNum* t);
+    
+    // Inverse fast paths: Kaliski's binary almost-inverse on fixed-size limb
+    // buffers for small odd moduli, Newton-Hensel lifting for moduli 2^k
+    BigNum modInverseBinary(const BigNum& modulus) const;
+    BigNum modInversePowerOfTwo(size_t k) const;
+    
+    // Decimal conversion. The basecase peels 19 digits per limb operation;
+    // the recursive forms split on cached powers 10^(19 * 2^level).
+    void appendDecimalBasecase(std::string& out, size_t width) const;
+    void appendDecimalRecursive(std::string& out, size_t level, size_t width) const;
+    static BigNum fromDecimalBasecase(const char* str, size_t len);
+    static BigNum fromDecimalRecursive(const char* str, size_t len);
+    
 public:
     // Constructors
     BigNum();
     BigNum(int64_t value);
     BigNum(const std::string& hexStr);
     BigNum(const std::vector<uint64_t>& digits, bool neg = false);
+    BigNum(LimbVector&& digits, bool neg = false);
     
     // Copy constructor and assignment
     BigNum(const BigNum& other);
@@ -67,6 +349,10 @@ public:
     BigNum operator*(const BigNum& other) const;
     BigNum operator/(const BigNum& other) const;
     BigNum operator%(const BigNum& other) const;
+    BigNum square() const;
+    // this^exponent by binary powering on the odd part, the power of two
+    // applied as one shift; throws std::overflow_error past 2^31 - 1 bits
+    BigNum pow(uint64_t exponent) const;
     
     // In-place operations
     BigNum& operator+=(const BigNum& other);
@@ -75,6 +361,16 @@ public:
     BigNum& operator/=(const BigNum& other);
     BigNum& operator%=(const BigNum& other);
     
+    // Fused forms of *this += a * b, *this -= a * b and (a * b) % m. The
+    // product is accumulated row by row into this value's own limbs (or,
+    // past the Karatsuba threshold, produced once into scratch) and the
+    // reduction divides the product buffer in place, so no intermediate
+    // BigNum is built. Signs follow the unfused expressions; bignum_expr.h
+    // maps expressions onto these.
+    BigNum& addMul(const BigNum& a, const BigNum& b);
+    BigNum& subMul(const BigNum& a, const BigNum& b);
+    static BigNum mulMod(const BigNum& a, const BigNum& b, const BigNum& modulus);
+    
     // Comparison operations
     bool operator==(const BigNum& other) const;
     bool operator!=(const BigNum& other) const;
@@ -101,8 +397,44 @@ public:
     
     // Cryptographic operations
     BigNum modPow(const BigNum& exponent, const BigNum& modulus) const;
+    BigNum modPow(const BigNum& exponent, const MontgomeryContext& ctx) const;
+    
+    // Constant-time modular exponentiation for secret exponents (odd moduli
+    // only). Running time and memory access depend only on the limb counts
+    // of the exponent and modulus, never on their values. A base that is
+    // not already below the modulus is reduced first in variable time.
+    enum class ConstantTimeMethod { FixedWindow, Ladder };
+    BigNum modPowConstantTime(const BigNum& exponent, const BigNum& modulus,
+                              ConstantTimeMethod method = ConstantTimeMethod::FixedWindow) const;
+    BigNum modPowConstantTime(const BigNum& exponent, const MontgomeryContext& ctx,
+                              ConstantTimeMethod method = ConstantTimeMethod::FixedWindow) const;
+    
+    // Batch modular exponentiation on the library thread pool. exponents and
+    // moduli hold either one entry per base or a single entry shared by all
+    // items; items with the same odd modulus share one MontgomeryContext.
+    // Results come back in input order, and the first exception an item
+    // throws is rethrown once the batch has finished.
+    static std::vector<BigNum> modPowBatch(const std::vector<BigNum>& bases,
+                                           const std::vector<BigNum>& exponents,
+                                           const std::vector<BigNum>& moduli);
+    // Product of powers bases[0]^exponents[0] * bases[1]^exponents[1] * ...
+    // mod modulus, as needed by DSA/Schnorr verification. Odd moduli run
+    // Straus interleaving: one sliding window per base over a shared chain
+    // of Montgomery squarings, so n exponents cost about one exponentiation's
+    // squarings. Even moduli multiply separate modPow results. Throws
+    // std::invalid_argument for mismatched sizes or a negative exponent.
+    static BigNum modPowProduct(const std::vector<BigNum>& bases,
+                                const std::vector<BigNum>& exponents,
+                                const BigNum& modulus);
+    static BigNum modPowProduct(const std::vector<BigNum>& bases,
+                                const std::vector<BigNum>& exponents,
+                                const MontgomeryContext& ctx);
+    // Inverse in [0, modulus); throws std::invalid_argument when none exists.
+    // Odd moduli and powers of two take dedicated fast paths.
     BigNum modInverse(const BigNum& modulus) const;
     BigNum gcd(const BigNum& other) const;
+    // {g, {s, t}} with this * s + other * t = g, the cofactors being the ones
+    // Euclid's algorithm produces
     std::pair<BigNum, std::pair<BigNum, BigNum>> extendedGcd(const BigNum& other) const;
     
     // Utility functions
@@ -120,16 +452,158 @@ public:
     int64_t toInt64() const;
     std::vector<uint8_t> toByteArray() const;
     
-    // Random number generation
+    // Buffer serializers. hexLength() is the exact size toHexString(char*)
+    // writes (sign included, no terminator); it throws std::length_error when
+    // the buffer is shorter. toBytes writes the magnitude into exactly `len`
+    // bytes, zero-padded, and throws std::length_error if it does not fit.
+    enum class ByteOrder { BigEndian, LittleEndian };
+    size_t hexLength() const;
+    size_t toHexString(char* out, size_t capacity) const;
+    void toBytes(uint8_t* out, size_t len, ByteOrder order = ByteOrder::BigEndian) const;
+    
+    // Algorithm thresholds. setTuning is meant for program startup; it is
+    // not synchronised with arithmetic running on other threads.
+    static const BigNumTuning& tuning();
+    static void setTuning(const BigNumTuning& t);
+    
+    // Tuning profiles: one "field = value" line per BigNumTuning member
+    // ("karatsuba_threshold = 22"), '#' comments; fields left out keep their
+    // defaults. bignum-tune --profile writes them. parseTuning throws
+    // std::invalid_argument for an unknown field or a bad value, loadTuning
+    // also std::runtime_error for an unreadable file. A profile named by the
+    // BIGNUM_TUNING environment variable is installed at startup, and
+    // ignored if it does not load.
+    static BigNumTuning parseTuning(const std::string& profile);
+    static std::string formatTuning(const BigNumTuning& t);
+    static void loadTuning(const std::string& path);
+    
+    // Snapshot of the BigNumStats counters, and a reset to zero (the live
+    // byte count is kept). Counting is process-wide and thread-safe.
+    static BigNumStats stats();
+    static void resetStats();
+    
+    // Threads used by the batch APIs, the calling thread included; 0 (the
+    // default) means std::thread::hardware_concurrency(). Like setTuning,
+    // meant for program startup.
+    static size_t threadCount();
+    static void setThreadCount(size_t threads);
+    
+    // Limb kernel set, chosen once at startup from what the CPU supports
+    // ("x86-64-mulx-adx", else "portable"); the BIGNUM_KERNELS environment
+    // variable overrides the choice. setKernels throws std::invalid_argument
+    // for a set this CPU cannot run. It swaps the whole set atomically, so it
+    // is safe while other threads are computing: every kernel call sees one
+    // complete set.
+    static std::string kernels();
+    static std::vector<std::string> availableKernels();
+    static void setKernels(const std::string& name);
+    
+    // Bump arena for limb storage. While a guard is alive, every limb buffer
+    // that outgrows the inline storage on this thread is carved from the
+    // guard's chunks, and the guard's exit hands the chunks back in one step
+    // (each thread keeps one empty chunk for the next guard). Values that
+    // leave the scope stay valid: a chunk they still occupy is freed with
+    // the last of them, from any thread. Copy a long-lived result after the
+    // scope if its chunk should not stay pinned. Guards nest; the innermost
+    // one serves allocations.
+    class ScopedArena {
+    public:
+        static constexpr size_t DEFAULT_CHUNK_BYTES = 64 * 1024;
+        
+        explicit ScopedArena(size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+        ~ScopedArena();
+        ScopedArena(const ScopedArena&) = delete;
+        ScopedArena& operator=(const ScopedArena&) = delete;
+        
+        // Chunk memory this guard currently holds, in bytes
+        size_t reservedBytes() const;
+        
+    private:
+        friend class LimbVector;
+        struct Chunk;
+        struct Spare;
+        
+        ScopedArena* previous;
+        Chunk* chunks;
+        size_t chunkLimbs;
+        
+        static Chunk* takeSpare(size_t limbs) noexcept;
+        static bool keepSpare(Chunk* chunk) noexcept;
+        static Chunk* newChunk(size_t limbs);
+        static void freeChunk(Chunk* chunk) noexcept;
+        static uint64_t* allocate(size_t limbs);
+        static void deallocate(uint64_t* block, size_t limbs) noexcept;
+        static bool extend(uint64_t* block, size_t limbs, size_t newLimbs) noexcept;
+    };
+    
+    // Cooperative cancellation. While a guard is alive, the long-running
+    // loops of this thread's calls (modPow windows, prime searches,
+    // Miller-Rabin and Lucas rounds, pow, factoring) poll `requested` every
+    // few dozen steps and throw BigNum::Cancelled once it returns true; the
+    // pool threads working for such a call poll it too, so it must be safe
+    // to call from any thread. Guards nest, and any enclosing predicate
+    // cancels as well. Without a guard the checks cost one thread-local load.
+    class Cancelled : public std::runtime_error {
+    public:
+        Cancelled() : std::runtime_error("Operation cancelled") {}
+    };
+    
+    class CancelScope {
+    public:
+        explicit CancelScope(std::function<bool()> requested);
+        ~CancelScope();
+        CancelScope(const CancelScope&) = delete;
+        CancelScope& operator=(const CancelScope&) = delete;
+        
+        // Throws Cancelled when a guard of this thread asks for it; only
+        // every POLL_INTERVAL-th call consults the predicates
+        static constexpr unsigned POLL_INTERVAL = 64;
+        static void checkpoint();
+        
+    private:
+        friend class bignum::ThreadPool;
+        
+        CancelScope* previous;
+        std::function<bool()> requested;
+        
+        static CancelScope*& active() noexcept;
+        static void poll();
+    };
+    
+    // Random number generation and prime testing. Execution::Parallel runs
+    // Miller-Rabin witnesses, or prime candidates, concurrently on the
+    // library thread pool and stops the remaining work at the first
+    // composite witness, or the first prime found. Both trial-divide by a
+    // table of small primes first; randomPrime sieves a window of candidates
+    // after each random start and only tests the survivors.
+    enum class Execution { Sequential, Parallel };
+    enum class PrimalityTest { MillerRabin, BailliePSW };  // 20 random rounds, or Baillie-PSW
     static BigNum random(size_t bitLength);
-    static BigNum randomPrime(size_t bitLength);
+    static BigNum randomPrime(size_t bitLength, Execution mode = Execution::Sequential,
+                              PrimalityTest test = PrimalityTest::MillerRabin);
+    bool isProbablePrime(int rounds = 20, Execution mode = Execution::Sequential) const;
+    // Smallest prime greater than this, searched through sieved windows
+    BigNum nextPrime(PrimalityTest test = PrimalityTest::MillerRabin) const;
+    
+    // Prime factors of |this| in ascending order, repeated by multiplicity
+    // (empty for 1); throws std::invalid_argument for zero. Trial division
+    // below 2^16, then Pollard rho (Brent) and ECM on what remains, with
+    // Baillie-PSW deciding primality. The time grows with the second largest
+    // factor: up to ~40 digits is practical, RSA-sized semiprimes are not.
+    // The ECM stage has a fixed curve budget (about 8000 curves up to
+    // B1 = 3e6, which can take hours on large inputs); throws
+    // std::runtime_error when it runs out. A CancelScope bounds it sooner.
+    std::vector<BigNum> factor() const;
     
-    // Prime testing
-    bool isProbablePrime(int rounds = 20) const;
+    // Baillie-PSW: a strong base-2 Miller-Rabin test followed by a strong
+    // Lucas test with Selfridge parameters. No composite is known to pass.
+    bool isBailliePSWPrime() const;
     
     // Factory methods
     static BigNum fromByteArray(const std::vector<uint8_t>& bytes);
-    static BigNum fromHexString(const std::string& hexStr);
+    static BigNum fromBytes(const uint8_t* data, size_t len, ByteOrder order = ByteOrder::BigEndian);
+    static BigNum fromHexString(std::string_view hexStr);
+    static BigNum fromDecimalString(std::string_view decStr);
     static BigNum zero();
     static BigNum one();
     static BigNum two();
@@ -139,26 +613,124 @@ public:
     friend std::istream& operator>>(std::istream& is, BigNum& num);
     
     // Access to internal representation (for advanced users)
-    const std::vector<uint64_t>& getDigits() const { return digits; }
+    const LimbVector& getDigits() const { return digits; }
     bool isNeg() const { return negative; }
 };
 
-// Montgomery arithmetic context for fast modular operations
+// Montgomery arithmetic context for fast modular operations.
+// Construction costs one division (for R^2 mod modulus), so a context built
+// once can be reused across many BigNum::modPow(exponent, ctx) calls. All
+// methods only read the context, so one context may be shared between
+// threads; the kernels work in per-thread scratch.
 class MontgomeryContext {
 public:
     BigNum modulus;
     BigNum r;          // R = 2^(k*64) where k = modulus.digits.size()
+    BigNum r2;         // R^2 mod modulus
     BigNum r_inv;      // R^(-1) mod modulus
-    BigNum n_prime;    // -modulus^(-1) mod R
+    uint64_t n0;       // -modulus^(-1) mod 2^64
     size_t k;          // Number of digits
     
     MontgomeryContext(const BigNum& mod);
     BigNum reduce(const BigNum& a) const;
     BigNum multiply(const BigNum& a, const BigNum& b) const;
+    BigNum square(const BigNum& a) const;
     BigNum toMontgomery(const BigNum& a) const;
     BigNum fromMontgomery(const BigNum& a) const;
 };
 
+// Bounded LRU cache of Montgomery contexts keyed by modulus, for callers
+// that exponentiate against a small set of moduli over and over. Lookups
+// are thread-safe; returned contexts stay valid after eviction.
+class MontgomeryCache {
+public:
+    explicit MontgomeryCache(size_t capacity = 16);
+    
+    // Returns the context for mod, building it on a miss
+    std::shared_ptr<const MontgomeryContext> get(const BigNum& mod);
+    
+    size_t size() const;
+    size_t capacity() const { return max_entries; }
+    void clear();
+    
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const MontgomeryContext>>;
+    
+    size_t max_entries;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    mutable std::mutex lock;
+};
+
+// Arithmetic in Z/mZ for one odd modulus m. Elements stay in Montgomery
+// form in fixed-width buffers of exactly limbs() limbs, so chains of field
+// operations never go through BigNum::operator%. The in-place forms write
+// to r, which may alias an operand, and do not allocate once r has been
+// sized by this field; values with at most BIGNUM_INLINE_LIMBS limbs never
+// touch the heap at all. All operations are const and thread-safe.
+class ModArith {
+public:
+    class Element {
+    public:
+        Element() = default;  // Unsized until a ModArith writes to it
+        
+        bool operator==(const Element& other) const {
+            return limbs.size() == other.limbs.size() &&
+                   std::memcmp(limbs.data(), other.limbs.data(), limbs.size() * sizeof(uint64_t)) == 0;
+        }
+        bool operator!=(const Element& other) const { return !(*this == other); }
+        
+    private:
+        friend class ModArith;
+        LimbVector limbs;  // x * R mod m, below m
+    };
+    
+    // Throws std::invalid_argument for an even or zero modulus; a negative
+    // one is taken by absolute value
+    explicit ModArith(const BigNum& modulus);
+    
+    const BigNum& modulus() const { return mont.modulus; }
+    size_t limbs() const { return mont.k; }
+    
+    // Conversion; element() reduces any BigNum, negative ones included
+    Element element(const BigNum& value) const;
+    BigNum toBigNum(const Element& x) const;
+    Element zero() const;
+    Element one() const;
+    bool isZero(const Element& x) const;
+    
+    void add(Element& r, const Element& a, const Element& b) const;
+    void sub(Element& r, const Element& a, const Element& b) const;
+    void neg(Element& r, const Element& a) const;
+    void mul(Element& r, const Element& a, const Element& b) const;
+    void sqr(Element& r, const Element& a) const;
+    // Throws std::invalid_argument when a has no inverse (a = 0, or a
+    // shares a factor with a composite modulus)
+    void inv(Element& r, const Element& a) const;
+    // Sliding-window exponentiation; a negative exponent inverts a first
+    void pow(Element& r, const Element& a, const BigNum& exponent) const;
+    
+    Element add(const Element& a, const Element& b) const;
+    Element sub(const Element& a, const Element& b) const;
+    Element neg(const Element& a) const;
+    Element mul(const Element& a, const Element& b) const;
+    Element sqr(const Element& a) const;
+    Element inv(const Element& a) const;
+    Element pow(const Element& a, const BigNum& exponent) const;
+    
+    // Montgomery's trick: inverts every element in place with a single
+    // field inversion and 3(n - 1) multiplications. Throws like inv() when
+    // any element is not invertible, leaving the input untouched.
+    void batchInv(std::vector<Element>& xs) const;
+    
+private:
+    void check(const Element& x) const;
+    
+    MontgomeryContext mont;  // modulus, n0 and R^2 mod m
+    LimbVector oneMont;      // R mod m
+    LimbVector r3;           // R^3 mod m, lifts modInverse(x R) back to x^-1 R
+};
+
 // Barrett reduction context for fast modular reduction
 class BarrettContext {
 public:
@@ -170,4 +742,31 @@ public:
     BigNum reduce(const BigNum& a) const;
 };
 
+// RSA private-key operation by the Chinese remainder theorem. The exponent
+// is split into dP = d mod (p - 1) and dQ = d mod (q - 1), so one full-size
+// exponentiation becomes two with half-size moduli and exponents, about a
+// quarter of the work each, recombined with Garner's formula
+// m = m_q + q * (qInv * (m_p - m_q) mod p). Both Montgomery contexts are
+// built once; modPow only reads them and may be called from many threads.
+class RSACRTContext {
+public:
+    // p and q odd and distinct, qInv = q^(-1) mod p. Throws
+    // std::invalid_argument for an even or trivial factor or a qInv that does
+    // not invert q.
+    RSACRTContext(const BigNum& p, const BigNum& q, const BigNum& dP, const BigNum& dQ,
+                  const BigNum& qInv);
+    
+    // c^d mod p*q for c in [0, p*q); Parallel runs the two halves on the
+    // library thread pool
+    BigNum modPow(const BigNum& c, BigNum::Execution mode = BigNum::Execution::Sequential) const;
+    
+    const BigNum& modulus() const { return n; }
+    
+private:
+    BigNum dP, dQ, qInv;
+    BigNum n;                 // p * q
+    MontgomeryContext montP;  // its modulus is p
+    MontgomeryContext montQ;  // its modulus is q
+};
+
 #endif // BIGNUM_H
\ No newline at end of file
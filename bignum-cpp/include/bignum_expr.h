@@ -0,0 +1,169 @@
+/**
+ * @file bignum_expr.h
+ * @brief Opt-in lazy BigNum expressions that fuse products into sums and
+ *        reductions.
+ *
+ * Wrapping one operand in lazy() makes +, -, * and % build a small
+ * expression tree instead of a BigNum per operator. The tree is evaluated
+ * when it is converted or assigned to a BigNum, and the shapes that matter
+ * in modular and polynomial code skip their intermediate products:
+ *
+ *   Z + X * Y, Z - X * Y      BigNum::addMul / subMul into a copy of Z
+ *   (X * Y) % M               BigNum::mulMod, reducing the product buffer
+ *   r += X * Y, r -= X * Y    r.addMul / r.subMul in place
+ *
+ * Results are identical to the plain operators. Expressions hold references
+ * to their operands, so evaluate them within the full expression that
+ * builds them rather than storing one in an auto variable.
+ *
+ * Header-only on top of bignum.h.
+ */
+
+#ifndef BIGNUM_EXPR_H
+#define BIGNUM_EXPR_H
+
+#include "bignum.h"
+#include <type_traits>
+
+namespace bignum_expr_detail {
+
+// A BigNum operand, held by reference
+struct Ref {
+    const BigNum& value;
+    BigNum eval() const { return value; }
+};
+
+template <typename L, typename R> struct Mul;
+template <typename L, typename R> struct Add;
+template <typename L, typename R> struct Sub;
+template <typename L, typename R> struct Mod;
+
+template <typename T> struct IsMul : std::false_type {};
+template <typename L, typename R> struct IsMul<Mul<L, R>> : std::true_type {};
+
+// Operands of a node: leaves by reference, subtrees evaluated
+inline const BigNum& value(const Ref& r) { return r.value; }
+template <typename N> BigNum value(const N& node) { return node.eval(); }
+
+template <typename L, typename R>
+struct Mul {
+    L l;
+    R r;
+    BigNum eval() const { return value(l) * value(r); }
+};
+
+template <typename L, typename R>
+struct Add {
+    L l;
+    R r;
+    BigNum eval() const {
+        if constexpr (IsMul<R>::value) {
+            BigNum z = l.eval();
+            z.addMul(value(r.l), value(r.r));
+            return z;
+        } else if constexpr (IsMul<L>::value) {
+            BigNum z = r.eval();
+            z.addMul(value(l.l), value(l.r));
+            return z;
+        } else {
+            return value(l) + value(r);
+        }
+    }
+};
+
+template <typename L, typename R>
+struct Sub {
+    L l;
+    R r;
+    BigNum eval() const {
+        if constexpr (IsMul<R>::value) {
+            BigNum z = l.eval();
+            z.subMul(value(r.l), value(r.r));
+            return z;
+        } else if constexpr (IsMul<L>::value) {
+            BigNum z = -value(r);
+            z.addMul(value(l.l), value(l.r));
+            return z;
+        } else {
+            return value(l) - value(r);
+        }
+    }
+};
+
+template <typename L, typename R>
+struct Mod {
+    L l;
+    R r;
+    BigNum eval() const {
+        if constexpr (IsMul<L>::value) {
+            return BigNum::mulMod(value(l.l), value(l.r), value(r));
+        } else {
+            return value(l) % value(r);
+        }
+    }
+};
+
+template <typename N>
+struct Expr {
+    N node;
+    operator BigNum() const { return node.eval(); }
+};
+
+template <typename T> struct IsExpr : std::false_type {};
+template <typename N> struct IsExpr<Expr<N>> : std::true_type {};
+
+template <typename T>
+constexpr bool IS_OPERAND = IsExpr<T>::value || std::is_same<T, BigNum>::value;
+
+// Operators apply when at least one side is already lazy
+template <typename L, typename R>
+using EnableLazy = std::enable_if_t<IS_OPERAND<L> && IS_OPERAND<R> &&
+                                    (IsExpr<L>::value || IsExpr<R>::value)>;
+
+inline Ref node(const BigNum& v) { return Ref{v}; }
+template <typename N> const N& node(const Expr<N>& e) { return e.node; }
+
+template <template <typename, typename> class Op, typename L, typename R>
+auto combine(const L& l, const R& r) {
+    using Node = Op<std::decay_t<decltype(node(l))>, std::decay_t<decltype(node(r))>>;
+    return Expr<Node>{Node{node(l), node(r)}};
+}
+
+template <typename L, typename R, typename = EnableLazy<L, R>>
+auto operator*(const L& l, const R& r) { return combine<Mul>(l, r); }
+
+template <typename L, typename R, typename = EnableLazy<L, R>>
+auto operator+(const L& l, const R& r) { return combine<Add>(l, r); }
+
+template <typename L, typename R, typename = EnableLazy<L, R>>
+auto operator-(const L& l, const R& r) { return combine<Sub>(l, r); }
+
+template <typename L, typename R, typename = EnableLazy<L, R>>
+auto operator%(const L& l, const R& r) { return combine<Mod>(l, r); }
+
+template <typename N>
+BigNum& operator+=(BigNum& target, const Expr<N>& e) {
+    if constexpr (IsMul<N>::value) {
+        return target.addMul(value(e.node.l), value(e.node.r));
+    } else {
+        return target += e.node.eval();
+    }
+}
+
+template <typename N>
+BigNum& operator-=(BigNum& target, const Expr<N>& e) {
+    if constexpr (IsMul<N>::value) {
+        return target.subMul(value(e.node.l), value(e.node.r));
+    } else {
+        return target -= e.node.eval();
+    }
+}
+
+}  // namespace bignum_expr_detail
+
+// Starts a lazy expression at `v`
+inline bignum_expr_detail::Expr<bignum_expr_detail::Ref> lazy(const BigNum& v) {
+    return {{v}};
+}
+
+#endif // BIGNUM_EXPR_H
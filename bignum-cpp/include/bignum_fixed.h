@@ -0,0 +1,333 @@
+/**
+ * @file bignum_fixed.h
+ * @brief Compile-time fixed-width unsigned integers and Montgomery arithmetic.
+ *
+ * FixedBigNum<Bits> keeps its value in a std::array of Bits / 64 limbs and
+ * never allocates. Arithmetic wraps modulo 2^Bits like the built-in unsigned
+ * types, the kernels are unrolled over the limb count at compile time, and
+ * everything except the BigNum conversions is constexpr. FixedMontgomery<Bits>
+ * is the matching Montgomery context for odd moduli below 2^Bits. Widths
+ * are whole limbs; a P-521 value lives in a FixedBigNum<576>.
+ *
+ * Header-only; only the BigNum conversions need the library.
+ */
+
+#ifndef BIGNUM_FIXED_H
+#define BIGNUM_FIXED_H
+
+#include "bignum.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace bignum_fixed_detail {
+
+// Calls f(std::integral_constant<size_t, I>{}) for I = 0, ..., N - 1 as one
+// straight-line sequence, so carry chains over the limbs are fully unrolled
+template <size_t... I, typename F>
+constexpr void unrollImpl(std::index_sequence<I...>, F&& f) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+// Widths up to this many limbs (512 bits, the ECC sizes) are unrolled
+// completely; wider ones keep loops with compile-time trip counts, which
+// the optimiser unrolls as far as it finds worthwhile
+constexpr size_t FULL_UNROLL_LIMBS = 8;
+
+template <size_t N, typename F>
+constexpr void forLimbs(F&& f) {
+    if constexpr (N <= FULL_UNROLL_LIMBS) {
+        unrollImpl(std::make_index_sequence<N>{}, f);
+    } else {
+        for (size_t i = 0; i < N; ++i) f(i);
+    }
+}
+
+constexpr int clz(uint64_t x) {
+    int n = 0;
+    for (uint64_t bit = uint64_t(1) << 63; bit && !(x & bit); bit >>= 1) ++n;
+    return n;
+}
+
+}  // namespace bignum_fixed_detail
+
+template <size_t Bits>
+class FixedBigNum {
+    static_assert(Bits > 0 && Bits % 64 == 0, "FixedBigNum widths are whole 64-bit limbs");
+
+public:
+    static constexpr size_t BITS = Bits;
+    static constexpr size_t LIMBS = Bits / 64;
+    using Limbs = std::array<uint64_t, LIMBS>;
+
+    constexpr FixedBigNum() : limbs{} {}
+    constexpr FixedBigNum(uint64_t value) : limbs{} { limbs[0] = value; }
+    static constexpr FixedBigNum fromLimbs(const Limbs& l) {
+        FixedBigNum r;
+        r.limbs = l;
+        return r;
+    }
+
+    // Throws std::invalid_argument for a negative value and
+    // std::overflow_error when it needs more than Bits bits
+    explicit FixedBigNum(const BigNum& value) : limbs{} {
+        if (value.isNegative()) {
+            throw std::invalid_argument("FixedBigNum holds unsigned values");
+        }
+        if (value.bitLength() > Bits) {
+            throw std::overflow_error("BigNum value is too large for this FixedBigNum");
+        }
+        const auto& d = value.getDigits();
+        for (size_t i = 0; i < d.size() && i < LIMBS; ++i) limbs[i] = d[i];
+    }
+
+    BigNum toBigNum() const {
+        return BigNum(std::vector<uint64_t>(limbs.begin(), limbs.end()), false);
+    }
+
+    constexpr const Limbs& data() const { return limbs; }
+    constexpr uint64_t operator[](size_t i) const { return limbs[i]; }
+
+    constexpr bool isZero() const {
+        uint64_t any = 0;
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) { any |= limbs[i]; });
+        return any == 0;
+    }
+    constexpr bool isOdd() const { return limbs[0] & 1; }
+    constexpr bool bit(size_t i) const { return (limbs[i / 64] >> (i % 64)) & 1; }
+    constexpr size_t bitLength() const {
+        for (size_t i = LIMBS; i-- > 0;) {
+            if (limbs[i]) return i * 64 + 64 - bignum_fixed_detail::clz(limbs[i]);
+        }
+        return 0;
+    }
+
+    // r = a + b mod 2^Bits; returns the carry out. r may alias a or b.
+    static constexpr uint64_t addCarry(FixedBigNum& r, const FixedBigNum& a, const FixedBigNum& b) {
+        uint64_t carry = 0;
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) {
+            const __uint128_t s = static_cast<__uint128_t>(a.limbs[i]) + b.limbs[i] + carry;
+            r.limbs[i] = static_cast<uint64_t>(s);
+            carry = static_cast<uint64_t>(s >> 64);
+        });
+        return carry;
+    }
+
+    // r = a - b mod 2^Bits; returns the borrow out. r may alias a or b.
+    static constexpr uint64_t subBorrow(FixedBigNum& r, const FixedBigNum& a, const FixedBigNum& b) {
+        uint64_t borrow = 0;
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) {
+            const __uint128_t d = static_cast<__uint128_t>(a.limbs[i]) - b.limbs[i] - borrow;
+            r.limbs[i] = static_cast<uint64_t>(d);
+            borrow = static_cast<uint64_t>(d >> 64) & 1;
+        });
+        return borrow;
+    }
+
+    // Full 2 * LIMBS-limb product, low limb first
+    static constexpr std::array<uint64_t, 2 * LIMBS> mulWide(const FixedBigNum& a, const FixedBigNum& b) {
+        std::array<uint64_t, 2 * LIMBS> r{};
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) {
+            uint64_t carry = 0;
+            bignum_fixed_detail::forLimbs<LIMBS>([&](auto j) {
+                const __uint128_t p = static_cast<__uint128_t>(a.limbs[j]) * b.limbs[i] + r[i + j] + carry;
+                r[i + j] = static_cast<uint64_t>(p);
+                carry = static_cast<uint64_t>(p >> 64);
+            });
+            r[i + LIMBS] = carry;
+        });
+        return r;
+    }
+
+    constexpr FixedBigNum operator+(const FixedBigNum& o) const { FixedBigNum r; addCarry(r, *this, o); return r; }
+    constexpr FixedBigNum operator-(const FixedBigNum& o) const { FixedBigNum r; subBorrow(r, *this, o); return r; }
+    constexpr FixedBigNum operator*(const FixedBigNum& o) const {
+        // Only the low LIMBS limbs of the product survive the wrap
+        FixedBigNum r;
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) {
+            uint64_t carry = 0;
+            bignum_fixed_detail::forLimbs<LIMBS>([&](auto j) {
+                if (i + j < LIMBS) {
+                    const __uint128_t p = static_cast<__uint128_t>(limbs[j]) * o.limbs[i] + r.limbs[i + j] + carry;
+                    r.limbs[i + j] = static_cast<uint64_t>(p);
+                    carry = static_cast<uint64_t>(p >> 64);
+                }
+            });
+        });
+        return r;
+    }
+    constexpr FixedBigNum& operator+=(const FixedBigNum& o) { addCarry(*this, *this, o); return *this; }
+    constexpr FixedBigNum& operator-=(const FixedBigNum& o) { subBorrow(*this, *this, o); return *this; }
+    constexpr FixedBigNum& operator*=(const FixedBigNum& o) { return *this = *this * o; }
+
+    constexpr FixedBigNum operator<<(size_t shift) const {
+        FixedBigNum r;
+        if (shift >= Bits) return r;
+        const size_t words = shift / 64, bits = shift % 64;
+        for (size_t i = LIMBS; i-- > words;) {
+            uint64_t v = limbs[i - words] << bits;
+            if (bits && i > words) v |= limbs[i - words - 1] >> (64 - bits);
+            r.limbs[i] = v;
+        }
+        return r;
+    }
+    constexpr FixedBigNum operator>>(size_t shift) const {
+        FixedBigNum r;
+        if (shift >= Bits) return r;
+        const size_t words = shift / 64, bits = shift % 64;
+        for (size_t i = 0; i + words < LIMBS; ++i) {
+            uint64_t v = limbs[i + words] >> bits;
+            if (bits && i + words + 1 < LIMBS) v |= limbs[i + words + 1] << (64 - bits);
+            r.limbs[i] = v;
+        }
+        return r;
+    }
+
+    constexpr bool operator==(const FixedBigNum& o) const {
+        uint64_t diff = 0;
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) { diff |= limbs[i] ^ o.limbs[i]; });
+        return diff == 0;
+    }
+    constexpr bool operator!=(const FixedBigNum& o) const { return !(*this == o); }
+    constexpr bool operator<(const FixedBigNum& o) const {
+        FixedBigNum unused;
+        return subBorrow(unused, *this, o) != 0;
+    }
+    constexpr bool operator>(const FixedBigNum& o) const { return o < *this; }
+    constexpr bool operator<=(const FixedBigNum& o) const { return !(o < *this); }
+    constexpr bool operator>=(const FixedBigNum& o) const { return !(*this < o); }
+
+private:
+    Limbs limbs;
+};
+
+// Montgomery arithmetic modulo an odd FixedBigNum<Bits> with R = 2^Bits.
+// Elements are FixedBigNum<Bits> values in Montgomery form, below
+// the modulus. The whole context is constexpr, so a modulus known at
+// compile time yields n0' and R^2 mod m as constants.
+template <size_t Bits>
+class FixedMontgomery {
+public:
+    using Value = FixedBigNum<Bits>;
+    static constexpr size_t LIMBS = Value::LIMBS;
+
+    // Throws std::invalid_argument for an even modulus
+    constexpr explicit FixedMontgomery(const Value& modulus) : m(modulus), n0(0), r2(), one_() {
+        if (!modulus.isOdd()) {
+            throw std::invalid_argument("Montgomery form requires odd modulus");
+        }
+        // -m^-1 mod 2^64 by Newton iteration; each step doubles the
+        // correct low bits, starting from the three that m[0] gives
+        uint64_t inv = m[0];
+        for (int i = 0; i < 6; ++i) inv *= 2 - m[0] * inv;
+        n0 = 0 - inv;
+
+        // R mod m and R^2 mod m by modular doubling from 1
+        Value x(1);
+        for (size_t i = 0; i < 128 * LIMBS; ++i) {
+            x = add(x, x);
+            if (i + 1 == 64 * LIMBS) one_ = x;
+        }
+        r2 = x;
+    }
+
+    constexpr const Value& modulus() const { return m; }
+    constexpr Value one() const { return one_; }
+    constexpr Value toMontgomery(const Value& x) const { return mul(reduce(x), r2); }
+    constexpr Value fromMontgomery(const Value& x) const { return mul(x, Value(1)); }
+
+    constexpr Value add(const Value& a, const Value& b) const {
+        Value r;
+        const uint64_t carry = Value::addCarry(r, a, b);
+        Value t;
+        const uint64_t borrow = Value::subBorrow(t, r, m);
+        return carry || !borrow ? t : r;
+    }
+    constexpr Value sub(const Value& a, const Value& b) const {
+        Value r;
+        if (Value::subBorrow(r, a, b)) Value::addCarry(r, r, m);
+        return r;
+    }
+    constexpr Value neg(const Value& a) const { return a.isZero() ? a : sub(m, a); }
+
+    // CIOS Montgomery product a * b / R mod m, unrolled over the limbs
+    constexpr Value mul(const Value& a, const Value& b) const {
+        std::array<uint64_t, LIMBS + 2> t{};
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) {
+            uint64_t carry = 0;
+            bignum_fixed_detail::forLimbs<LIMBS>([&](auto j) {
+                const __uint128_t p = static_cast<__uint128_t>(a[j]) * b[i] + t[j] + carry;
+                t[j] = static_cast<uint64_t>(p);
+                carry = static_cast<uint64_t>(p >> 64);
+            });
+            __uint128_t s = static_cast<__uint128_t>(t[LIMBS]) + carry;
+            t[LIMBS] = static_cast<uint64_t>(s);
+            t[LIMBS + 1] = static_cast<uint64_t>(s >> 64);
+
+            const uint64_t q = t[0] * n0;
+            __uint128_t p = static_cast<__uint128_t>(q) * m[0] + t[0];
+            carry = static_cast<uint64_t>(p >> 64);
+            bignum_fixed_detail::forLimbs<LIMBS - 1>([&](auto j) {
+                p = static_cast<__uint128_t>(q) * m[j + 1] + t[j + 1] + carry;
+                t[j] = static_cast<uint64_t>(p);
+                carry = static_cast<uint64_t>(p >> 64);
+            });
+            s = static_cast<__uint128_t>(t[LIMBS]) + carry;
+            t[LIMBS - 1] = static_cast<uint64_t>(s);
+            t[LIMBS] = t[LIMBS + 1] + static_cast<uint64_t>(s >> 64);
+        });
+
+        // t < 2m: one conditional subtraction
+        typename Value::Limbs low{};
+        bignum_fixed_detail::forLimbs<LIMBS>([&](auto i) { low[i] = t[i]; });
+        Value r = Value::fromLimbs(low);
+        Value d;
+        const uint64_t borrow = Value::subBorrow(d, r, m);
+        return t[LIMBS] || !borrow ? d : r;
+    }
+    constexpr Value sqr(const Value& a) const { return mul(a, a); }
+
+    // Left-to-right 4-bit fixed-window exponentiation of a Montgomery-form
+    // base by a plain exponent of any width
+    template <size_t EBits>
+    constexpr Value pow(const Value& base, const FixedBigNum<EBits>& exponent) const {
+        std::array<Value, 16> table{};
+        table[0] = one_;
+        for (size_t i = 1; i < 16; ++i) table[i] = mul(table[i - 1], base);
+        Value acc = one_;
+        const size_t bits = exponent.bitLength();
+        for (size_t w = (bits + 3) / 4; w-- > 0;) {
+            for (int s = 0; s < 4; ++s) acc = sqr(acc);
+            size_t digit = 0;
+            for (size_t b = 4; b-- > 0;) {
+                const size_t pos = 4 * w + b;
+                digit = (digit << 1) | (pos < EBits && exponent.bit(pos));
+            }
+            acc = mul(acc, table[digit]);
+        }
+        return acc;
+    }
+
+private:
+    constexpr Value reduce(const Value& x) const {
+        // Conversions accept any x < 2^Bits, which may exceed m by many
+        // multiples; shifted subtraction brings it below m
+        Value r = x;
+        if (r < m) return r;
+        const size_t shift = r.bitLength() - m.bitLength();
+        for (size_t s = shift + 1; s-- > 0;) {
+            const Value ms = m << s;
+            if ((ms >> s) == m && !(r < ms)) r = r - ms;
+        }
+        return r;
+    }
+
+    Value m;
+    uint64_t n0;  // -m^-1 mod 2^64
+    Value r2;     // R^2 mod m
+    Value one_;   // R mod m
+};
+
+#endif  // BIGNUM_FIXED_H
@@ -9,13 +9,440 @@
  */
 
 #include "bignum.h"
+#include "bignum_mpn.h"
+#include "bignum_thread_pool.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <new>
 #include <random>
-#include <iomanip>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 
+namespace mpn = bignum::mpn;
+
+#ifndef BIGNUM_STATS
+#define BIGNUM_STATS 0
+#endif
+
+//------------------------------------------------------------------------------
+// Operation counters
+//------------------------------------------------------------------------------
+
+namespace {
+
+// One static block of relaxed atomics: zero-initialised before any code
+// runs and never destroyed, so allocations during static initialisation or
+// thread exit can still be counted
+struct StatStorage {
+    struct Op {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> nanoseconds;
+        std::atomic<uint64_t> limbs[BigNumStats::SIZE_BUCKETS];
+    };
+    Op ops[BigNumStats::OpCount];
+    std::atomic<uint64_t> heapAllocations, heapBytes, arenaAllocations, arenaBytes;
+    std::atomic<int64_t> liveBytes, peakLiveBytes;
+};
+
+[[maybe_unused]] StatStorage statStorage;
+
+#if BIGNUM_STATS
+
+void statCount(BigNumStats::Op op, size_t limbs) {
+    StatStorage::Op& s = statStorage.ops[op];
+    s.calls.fetch_add(1, std::memory_order_relaxed);
+    size_t bucket = 0;
+    while (bucket + 1 < BigNumStats::SIZE_BUCKETS && (limbs >> (bucket + 1)) != 0) ++bucket;
+    s.limbs[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void statLive(int64_t delta) {
+    const int64_t now = statStorage.liveBytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+    int64_t peak = statStorage.peakLiveBytes.load(std::memory_order_relaxed);
+    while (now > peak && !statStorage.peakLiveBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+// Counts a call on construction and adds its duration on destruction
+class StatScope {
+public:
+    StatScope(BigNumStats::Op op, size_t limbs) : op(op), start(std::chrono::steady_clock::now()) {
+        statCount(op, limbs);
+    }
+    ~StatScope() {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        statStorage.ops[op].nanoseconds.fetch_add(static_cast<uint64_t>(ns.count()), std::memory_order_relaxed);
+    }
+    StatScope(const StatScope&) = delete;
+    StatScope& operator=(const StatScope&) = delete;
+    
+private:
+    BigNumStats::Op op;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define BIGNUM_STAT_SCOPE(op, limbs) StatScope bignumStatScope(BigNumStats::op, (limbs))
+#define BIGNUM_STAT_EVENT(op, limbs) statCount(BigNumStats::op, (limbs))
+#define BIGNUM_STAT_ALLOC(kind, bytes)                                                       \
+    (statStorage.kind##Allocations.fetch_add(1, std::memory_order_relaxed),                   \
+     statStorage.kind##Bytes.fetch_add((bytes), std::memory_order_relaxed))
+#define BIGNUM_STAT_LIVE(delta) statLive(static_cast<int64_t>(delta))
+
+#else
+
+#define BIGNUM_STAT_SCOPE(op, limbs) ((void)0)
+#define BIGNUM_STAT_EVENT(op, limbs) ((void)0)
+#define BIGNUM_STAT_ALLOC(kind, bytes) ((void)0)
+#define BIGNUM_STAT_LIVE(delta) ((void)0)
+
+#endif
+
+}  // namespace
+
+BigNumStats BigNum::stats() {
+    BigNumStats r;
+    r.enabled = BIGNUM_STATS != 0;
+    for (size_t i = 0; i < BigNumStats::OpCount; ++i) {
+        const StatStorage::Op& s = statStorage.ops[i];
+        r.ops[i].calls = s.calls.load(std::memory_order_relaxed);
+        r.ops[i].nanoseconds = s.nanoseconds.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < BigNumStats::SIZE_BUCKETS; ++b) {
+            r.ops[i].limbs[b] = s.limbs[b].load(std::memory_order_relaxed);
+        }
+    }
+    r.heap_allocations = statStorage.heapAllocations.load(std::memory_order_relaxed);
+    r.heap_bytes = statStorage.heapBytes.load(std::memory_order_relaxed);
+    r.arena_allocations = statStorage.arenaAllocations.load(std::memory_order_relaxed);
+    r.arena_bytes = statStorage.arenaBytes.load(std::memory_order_relaxed);
+    r.live_bytes = static_cast<uint64_t>(std::max<int64_t>(0, statStorage.liveBytes.load(std::memory_order_relaxed)));
+    r.peak_live_bytes = static_cast<uint64_t>(std::max<int64_t>(0, statStorage.peakLiveBytes.load(std::memory_order_relaxed)));
+    return r;
+}
+
+void BigNum::resetStats() {
+    for (StatStorage::Op& s : statStorage.ops) {
+        s.calls.store(0, std::memory_order_relaxed);
+        s.nanoseconds.store(0, std::memory_order_relaxed);
+        for (auto& b : s.limbs) b.store(0, std::memory_order_relaxed);
+    }
+    statStorage.heapAllocations.store(0, std::memory_order_relaxed);
+    statStorage.heapBytes.store(0, std::memory_order_relaxed);
+    statStorage.arenaAllocations.store(0, std::memory_order_relaxed);
+    statStorage.arenaBytes.store(0, std::memory_order_relaxed);
+    statStorage.peakLiveBytes.store(statStorage.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+const char* BigNumStats::name(Op op) {
+    static const char* const names[OpCount] = {
+        "mul_basecase", "mul_karatsuba", "mul_toom3", "mul_ntt",
+        "sqr_basecase", "sqr_karatsuba", "sqr_large",
+        "division",
+        "modpow_montgomery", "modpow_barrett", "modpow_binary", "modpow_constant_time",
+        "modpow_fallback",
+        "modpow_product", "modpow_crt",
+        "montgomery_context", "barrett_context",
+        "barrett_fallback",
+        "gcd", "extended_gcd", "mod_inverse",
+        "to_decimal", "from_decimal",
+        "primality_test", "random_prime", "factor",
+    };
+    return op < OpCount ? names[op] : "unknown";
+}
+
+std::string BigNumStats::toJson() const {
+    std::string out = "{\"enabled\": ";
+    out += enabled ? "true" : "false";
+    out += ", \"ops\": {";
+    bool first = true;
+    for (size_t i = 0; i < OpCount; ++i) {
+        const Counter& c = ops[i];
+        if (!c.calls) continue;
+        out += first ? "" : ", ";
+        first = false;
+        out += "\"" + std::string(name(static_cast<Op>(i))) + "\": {\"calls\": " + std::to_string(c.calls) +
+               ", \"nanoseconds\": " + std::to_string(c.nanoseconds) + ", \"limbs\": [";
+        for (size_t b = 0; b < SIZE_BUCKETS; ++b) {
+            out += (b ? ", " : "") + std::to_string(c.limbs[b]);
+        }
+        out += "]}";
+    }
+    out += "}, \"heap_allocations\": " + std::to_string(heap_allocations) +
+           ", \"heap_bytes\": " + std::to_string(heap_bytes) +
+           ", \"arena_allocations\": " + std::to_string(arena_allocations) +
+           ", \"arena_bytes\": " + std::to_string(arena_bytes) +
+           ", \"live_bytes\": " + std::to_string(live_bytes) +
+           ", \"peak_live_bytes\": " + std::to_string(peak_live_bytes) + "}";
+    return out;
+}
+
+//------------------------------------------------------------------------------
+// LimbVector storage
+//------------------------------------------------------------------------------
+
+void LimbVector::grow(size_t minCapacity) {
+    size_t newCap = std::max(minCapacity, cap * 2);
+    if (!isInline() && BigNum::ScopedArena::extend(ptr, cap, newCap)) {
+        cap = newCap;
+        return;
+    }
+    uint64_t* block = BigNum::ScopedArena::allocate(newCap);
+    if (count) std::memcpy(block, ptr, count * sizeof(uint64_t));
+    release();
+    ptr = block;
+    cap = newCap;
+}
+
+void LimbVector::release() noexcept {
+    if (!isInline()) {
+        BigNum::ScopedArena::deallocate(ptr, cap);
+        ptr = inline_buf;
+        cap = INLINE_CAPACITY;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Limb arenas
+//------------------------------------------------------------------------------
+
+// Every spilled limb buffer is preceded by one header limb holding the chunk
+// it was carved from, or zero for a plain heap block. A chunk counts the
+// blocks it has handed out: frees by the owning arena, on its own thread,
+// decrement `live` without synchronisation and may pop the bump pointer;
+// any other free decrements `remote`. When the arena exits it folds `live`
+// into `remote`, which from then on is the number of blocks outstanding.
+struct BigNum::ScopedArena::Chunk {
+    std::atomic<ScopedArena*> owner;
+    Chunk* next;
+    size_t capacity;   // limbs after the chunk header
+    size_t top;        // limbs handed out so far
+    size_t live;
+    std::atomic<ptrdiff_t> remote;
+    
+    uint64_t* base() { return reinterpret_cast<uint64_t*>(this + 1); }
+    bool empty() const { return static_cast<ptrdiff_t>(live) + remote.load(std::memory_order_acquire) == 0; }
+};
+
+// One empty chunk per thread survives between guards. Its destructor runs at
+// thread exit; `closed` then keeps late frees from parking a chunk again.
+struct BigNum::ScopedArena::Spare {
+    static thread_local Chunk* chunk;
+    static thread_local bool closed;
+    
+    ~Spare() {
+        closed = true;
+        if (chunk) freeChunk(chunk);
+        chunk = nullptr;
+    }
+};
+
+thread_local BigNum::ScopedArena::Chunk* BigNum::ScopedArena::Spare::chunk = nullptr;
+thread_local bool BigNum::ScopedArena::Spare::closed = false;
+
+namespace {
+
+thread_local BigNum::ScopedArena* currentArena = nullptr;
+
+}  // namespace
+
+BigNum::ScopedArena::Chunk* BigNum::ScopedArena::takeSpare(size_t limbs) noexcept {
+    Chunk* chunk = Spare::chunk;
+    if (!chunk || chunk->capacity < limbs) return nullptr;
+    Spare::chunk = nullptr;
+    return chunk;
+}
+
+bool BigNum::ScopedArena::keepSpare(Chunk* chunk) noexcept {
+    // Oversized chunks are not worth pinning for the rest of the thread
+    if (Spare::closed || Spare::chunk || chunk->capacity * sizeof(uint64_t) > 4 * DEFAULT_CHUNK_BYTES) return false;
+    thread_local Spare reaper;
+    (void)reaper;
+    chunk->next = nullptr;
+    chunk->top = 0;
+    chunk->live = 0;
+    chunk->remote.store(0, std::memory_order_relaxed);
+    Spare::chunk = chunk;
+    return true;
+}
+
+BigNum::ScopedArena::Chunk* BigNum::ScopedArena::newChunk(size_t limbs) {
+    static_assert(sizeof(Chunk) % alignof(uint64_t) == 0, "Chunk data must stay limb aligned");
+    void* raw = ::operator new(sizeof(Chunk) + limbs * sizeof(uint64_t));
+    BIGNUM_STAT_LIVE(sizeof(Chunk) + limbs * sizeof(uint64_t));
+    Chunk* chunk = new (raw) Chunk;
+    chunk->owner.store(nullptr, std::memory_order_relaxed);
+    chunk->next = nullptr;
+    chunk->capacity = limbs;
+    chunk->top = 0;
+    chunk->live = 0;
+    chunk->remote.store(0, std::memory_order_relaxed);
+    return chunk;
+}
+
+void BigNum::ScopedArena::freeChunk(Chunk* chunk) noexcept {
+    BIGNUM_STAT_LIVE(-static_cast<int64_t>(sizeof(Chunk) + chunk->capacity * sizeof(uint64_t)));
+    chunk->~Chunk();
+    ::operator delete(chunk);
+}
+
+BigNum::ScopedArena::ScopedArena(size_t chunkBytes)
+    : previous(currentArena), chunks(nullptr),
+      chunkLimbs(std::max<size_t>(chunkBytes / sizeof(uint64_t), 64)) {
+    chunks = takeSpare(chunkLimbs);
+    if (chunks) chunks->owner.store(this, std::memory_order_relaxed);
+    currentArena = this;
+}
+
+BigNum::ScopedArena::~ScopedArena() {
+    currentArena = previous;
+    for (Chunk* chunk = chunks; chunk;) {
+        Chunk* next = chunk->next;
+        chunk->owner.store(nullptr, std::memory_order_release);
+        ptrdiff_t live = static_cast<ptrdiff_t>(chunk->live);
+        if (chunk->remote.fetch_add(live, std::memory_order_acq_rel) + live == 0 && !keepSpare(chunk)) {
+            freeChunk(chunk);
+        }
+        // Otherwise the last outstanding block frees the chunk
+        chunk = next;
+    }
+}
+
+size_t BigNum::ScopedArena::reservedBytes() const {
+    size_t limbs = 0;
+    for (Chunk* chunk = chunks; chunk; chunk = chunk->next) limbs += chunk->capacity;
+    return limbs * sizeof(uint64_t);
+}
+
+uint64_t* BigNum::ScopedArena::allocate(size_t limbs) {
+    const size_t need = limbs + 1;
+    ScopedArena* arena = currentArena;
+    if (!arena) {
+        uint64_t* block = static_cast<uint64_t*>(::operator new(need * sizeof(uint64_t)));
+        BIGNUM_STAT_ALLOC(heap, need * sizeof(uint64_t));
+        BIGNUM_STAT_LIVE(need * sizeof(uint64_t));
+        block[0] = 0;
+        return block + 1;
+    }
+    
+    Chunk* chunk = arena->chunks;
+    if (chunk && chunk->capacity - chunk->top < need) {
+        // Out-of-order frees leave holes, so before reserving more memory
+        // look for a chunk whose blocks have all come back and restart it
+        Chunk** link = &arena->chunks;
+        while (*link && !((*link)->capacity >= need && (*link)->empty())) link = &(*link)->next;
+        if (*link) {
+            Chunk* reused = *link;
+            *link = reused->next;
+            reused->top = 0;
+            reused->next = arena->chunks;
+            arena->chunks = reused;
+        }
+        chunk = arena->chunks;
+    }
+    if (!chunk || chunk->capacity - chunk->top < need) {
+        // Buffers too big to share a chunk get one of their own behind the
+        // current chunk, which keeps serving the small ones
+        bool dedicated = need > arena->chunkLimbs / 2;
+        Chunk* fresh = newChunk(dedicated ? need : arena->chunkLimbs);
+        fresh->owner.store(arena, std::memory_order_relaxed);
+        if (dedicated && chunk) {
+            fresh->next = chunk->next;
+            chunk->next = fresh;
+        } else {
+            fresh->next = chunk;
+            arena->chunks = fresh;
+        }
+        chunk = fresh;
+    }
+    
+    BIGNUM_STAT_ALLOC(arena, need * sizeof(uint64_t));
+    uint64_t* block = chunk->base() + chunk->top;
+    block[0] = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(chunk));
+    chunk->top += need;
+    ++chunk->live;
+    return block + 1;
+}
+
+void BigNum::ScopedArena::deallocate(uint64_t* block, size_t limbs) noexcept {
+    Chunk* chunk = reinterpret_cast<Chunk*>(static_cast<uintptr_t>(block[-1]));
+    if (!chunk) {
+        BIGNUM_STAT_LIVE(-static_cast<int64_t>((limbs + 1) * sizeof(uint64_t)));
+        ::operator delete(block - 1);
+        return;
+    }
+    ScopedArena* arena = currentArena;
+    if (arena && chunk->owner.load(std::memory_order_relaxed) == arena) {
+        --chunk->live;
+        if (chunk->empty()) {
+            chunk->top = 0;
+        } else if (block + limbs == chunk->base() + chunk->top) {
+            chunk->top -= limbs + 1;
+        }
+        return;
+    }
+    if (chunk->remote.fetch_sub(1, std::memory_order_acq_rel) == 1 && !keepSpare(chunk)) freeChunk(chunk);
+}
+
+bool BigNum::ScopedArena::extend(uint64_t* block, size_t limbs, size_t newLimbs) noexcept {
+    ScopedArena* arena = currentArena;
+    if (!arena) return false;
+    Chunk* chunk = reinterpret_cast<Chunk*>(static_cast<uintptr_t>(block[-1]));
+    if (!chunk || chunk->owner.load(std::memory_order_relaxed) != arena) return false;
+    if (block + limbs != chunk->base() + chunk->top || chunk->capacity - chunk->top < newLimbs - limbs) {
+        return false;
+    }
+    chunk->top += newLimbs - limbs;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Cancellation
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Checkpoints left on this thread before the predicates are consulted again
+thread_local unsigned cancelCountdown = BigNum::CancelScope::POLL_INTERVAL;
+
+}  // namespace
+
+BigNum::CancelScope*& BigNum::CancelScope::active() noexcept {
+    thread_local CancelScope* scope = nullptr;
+    return scope;
+}
+
+BigNum::CancelScope::CancelScope(std::function<bool()> requested)
+    : previous(active()), requested(std::move(requested)) {
+    active() = this;
+}
+
+BigNum::CancelScope::~CancelScope() {
+    active() = previous;
+}
+
+void BigNum::CancelScope::checkpoint() {
+    if (active() && --cancelCountdown == 0) poll();
+}
+
+void BigNum::CancelScope::poll() {
+    cancelCountdown = POLL_INTERVAL;
+    for (CancelScope* scope = active(); scope; scope = scope->previous) {
+        if (scope->requested && scope->requested()) {
+            // A predicate that fired usually stays true; the next
+            // checkpoint asks again at once
+            cancelCountdown = 1;
+            throw Cancelled();
+        }
+    }
+}
+
 // Constructors
 BigNum::BigNum() : negative(false) {
     digits.push_back(0);
@@ -38,6 +465,17 @@ BigNum::BigNum(const std::string& hexStr) : negative(false) {
 
 BigNum::BigNum(const std::vector<uint64_t>& digits, bool neg) 
     : digits(digits), negative(neg) {
+    if (this->digits.empty()) {
+        this->digits.push_back(0);
+    }
+    removeLeadingZeros();
+}
+
+BigNum::BigNum(LimbVector&& digits, bool neg)
+    : digits(std::move(digits)), negative(neg) {
+    if (this->digits.empty()) {
+        this->digits.push_back(0);
+    }
     removeLeadingZeros();
 }
 
@@ -51,23 +489,34 @@ BigNum& BigNum::operator=(const BigNum& other) {
     return *this;
 }
 
+// A moved-from BigNum is left holding zero, which costs nothing with inline storage
 BigNum::BigNum(BigNum&& other) noexcept 
-    : digits(std::move(other.digits)), negative(other.negative) {}
+    : digits(std::move(other.digits)), negative(other.negative) {
+    other.digits.push_back(0);
+    other.negative = false;
+}
 
 BigNum& BigNum::operator=(BigNum&& other) noexcept {
     if (this != &other) {
         digits = std::move(other.digits);
         negative = other.negative;
+        other.digits.push_back(0);
+        other.negative = false;
     }
     return *this;
 }
 
 // Helper functions
+BigNum BigNum::withCapacity(size_t limbs) {
+    BigNum result;
+    result.digits.reserve(limbs);
+    return result;
+}
+
 void BigNum::removeLeadingZeros() {
-    while (digits.size() > 1 && digits.back() == 0) {
-        digits.pop_back();
-    }
-    if (digits.size() == 1 && digits[0] == 0) {
+    size_t n = mpn::normalizedSize(digits.data(), digits.size());
+    digits.resize(n > 0 ? n : 1);
+    if (n == 0) {
         negative = false;
     }
 }
@@ -78,222 +527,401 @@ int BigNum::compare(const BigNum& other) const {
     }
     
     int sign = negative ? -1 : 1;
-    
-    if (digits.size() != other.digits.size()) {
-        return sign * (digits.size() < other.digits.size() ? -1 : 1);
-    }
-    
-    for (int i = digits.size() - 1; i >= 0; --i) {
-        if (digits[i] != other.digits[i]) {
-            return sign * (digits[i] < other.digits[i] ? -1 : 1);
-        }
+    return sign * compareAbs(other);
+}
+
+int BigNum::compareAbs(const BigNum& other) const {
+    return mpn::cmp(digits.data(), digits.size(), other.digits.data(), other.digits.size());
+}
+
+void BigNum::addSigned(BigNum& r, const BigNum& a, const BigNum& b, bool bNegative) {
+    // r may be a itself (compound assignment), so every pointer is taken
+    // after r has been resized and the sizes are captured up front.
+    const size_t an = a.digits.size();
+    const size_t bn = b.digits.size();
+    
+    if (a.negative == bNegative) {
+        const bool aLonger = an >= bn;
+        const size_t n = aLonger ? an : bn;
+        r.digits.resize(n + 1);
+        const uint64_t* up = aLonger ? a.digits.data() : b.digits.data();
+        const uint64_t* vp = aLonger ? b.digits.data() : a.digits.data();
+        uint64_t* rp = r.digits.data();
+        rp[n] = mpn::add(rp, up, n, vp, aLonger ? bn : an);
+        r.negative = bNegative;
+    } else if (a.compareAbs(b) >= 0) {
+        // |a| >= |b|: the result takes the sign of a
+        const bool aNegative = a.negative;
+        r.digits.resize(an);
+        mpn::sub(r.digits.data(), a.digits.data(), an, b.digits.data(), bn);
+        r.negative = aNegative;
+    } else {
+        // |a| < |b|: the result takes the sign of b
+        r.digits.resize(bn);
+        mpn::sub(r.digits.data(), b.digits.data(), bn, a.digits.data(), an);
+        r.negative = bNegative;
     }
     
-    return 0;
+    r.removeLeadingZeros();
 }
 
 BigNum BigNum::addUnsigned(const BigNum& other) const {
-    const std::vector<uint64_t>& a = digits;
-    const std::vector<uint64_t>& b = other.digits;
-    
-    size_t maxSize = std::max(a.size(), b.size());
-    std::vector<uint64_t> result;
-    result.reserve(maxSize + 1);
-    
-    __uint128_t carry = 0;
-    for (size_t i = 0; i < maxSize || carry; ++i) {
-        __uint128_t sum = carry;
-        if (i < a.size()) sum += a[i];
-        if (i < b.size()) sum += b[i];
-        
-        result.push_back(static_cast<uint64_t>(sum & 0xFFFFFFFFFFFFFFFFULL));
-        carry = sum >> 64;
-    }
-    
-    return BigNum(result, false);
+    const bool thisLonger = digits.size() >= other.digits.size();
+    const BigNum& u = thisLonger ? *this : other;
+    const BigNum& v = thisLonger ? other : *this;
+    const size_t n = u.digits.size();
+    
+    BigNum result = withCapacity(n + 1);
+    result.digits.resize(n + 1);
+    result.digits[n] = mpn::add(result.digits.data(), u.digits.data(), n, v.digits.data(), v.digits.size());
+    result.removeLeadingZeros();
+    return result;
 }
 
 BigNum BigNum::subtractUnsigned(const BigNum& other) const {
     // This function assumes |this| >= |other|
-    const std::vector<uint64_t>& a = digits;
-    const std::vector<uint64_t>& b = other.digits;
-    
-    std::vector<uint64_t> result;
-    result.reserve(a.size());
-    
-    uint64_t borrow = 0;
-    for (size_t i = 0; i < a.size(); ++i) {
-        uint64_t ai = a[i];
-        uint64_t bi = (i < b.size()) ? b[i] : 0;
+    BigNum result = withCapacity(digits.size());
+    result.digits.resize(digits.size());
+    mpn::sub(result.digits.data(), digits.data(), digits.size(), other.digits.data(), other.digits.size());
+    result.removeLeadingZeros();
+    return result;
+}
+
+namespace {
+
+// Profile field names, in the order formatTuning writes them
+const std::pair<const char*, size_t BigNumTuning::*> TUNING_FIELDS[] = {
+    {"karatsuba_threshold", &BigNumTuning::karatsuba_threshold},
+    {"karatsuba_sqr_threshold", &BigNumTuning::karatsuba_sqr_threshold},
+    {"toom3_threshold", &BigNumTuning::toom3_threshold},
+    {"ntt_threshold", &BigNumTuning::ntt_threshold},
+    {"montgomery_threshold", &BigNumTuning::montgomery_threshold},
+    {"barrett_threshold", &BigNumTuning::barrett_threshold},
+    {"decimal_threshold", &BigNumTuning::decimal_threshold},
+};
+
+void validateTuning(const BigNumTuning& t) {
+    // The Karatsuba and Toom-3 kernels split at least once, so they need two
+    // and three limbs
+    if (t.karatsuba_threshold < 2 || t.karatsuba_sqr_threshold < 2) {
+        throw std::invalid_argument("Karatsuba thresholds must be at least 2 limbs");
+    }
+    if (t.toom3_threshold < 3) {
+        throw std::invalid_argument("Toom-3 threshold must be at least 3 limbs");
+    }
+    if (t.decimal_threshold < 1) {
+        throw std::invalid_argument("Decimal threshold must be at least 1 limb");
+    }
+}
+
+std::string readProfile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot read tuning profile: " + path);
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+BigNumTuning& tuningStorage() {
+    static BigNumTuning t = [] {
+        const char* path = std::getenv("BIGNUM_TUNING");
+        if (path && *path) {
+            try {
+                BigNumTuning loaded = BigNum::parseTuning(readProfile(path));
+                validateTuning(loaded);
+                return loaded;
+            } catch (const std::exception&) {
+                // Keep the built-in defaults
+            }
+        }
+        return BigNumTuning();
+    }();
+    return t;
+}
+
+}  // namespace
+
+const BigNumTuning& BigNum::tuning() {
+    return tuningStorage();
+}
+
+namespace {
+
+std::atomic<size_t> threadSetting{0};
+
+}  // namespace
+
+size_t BigNum::threadCount() {
+    const size_t n = threadSetting.load();
+    if (n) return n;
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+void BigNum::setThreadCount(size_t threads) {
+    threadSetting.store(threads);
+}
+
+std::string BigNum::kernels() {
+    return mpn::currentKernels().name;
+}
+
+std::vector<std::string> BigNum::availableKernels() {
+    size_t count = 0;
+    const mpn::Kernels* sets = mpn::availableKernels(&count);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; ++i) names.push_back(sets[i].name);
+    return names;
+}
+
+void BigNum::setKernels(const std::string& name) {
+    if (!mpn::selectKernels(name.c_str())) {
+        throw std::invalid_argument("Kernel set not available on this CPU: " + name);
+    }
+}
+
+void BigNum::setTuning(const BigNumTuning& t) {
+    validateTuning(t);
+    tuningStorage() = t;
+}
+
+BigNumTuning BigNum::parseTuning(const std::string& profile) {
+    BigNumTuning t;
+    std::istringstream in(profile);
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        const size_t eq = line.find('=');
+        auto trim = [](std::string s) {
+            const size_t b = s.find_first_not_of(" \t\r");
+            if (b == std::string::npos) return std::string();
+            return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+        };
+        const std::string key = trim(line.substr(0, eq));
+        if (key.empty() && eq == std::string::npos) continue;
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Tuning profile line without '=': " + key);
+        }
+        const std::string value = trim(line.substr(eq + 1));
         
-        if (ai >= bi + borrow) {
-            result.push_back(ai - bi - borrow);
-            borrow = 0;
-        } else {
-            // Need to borrow
-            result.push_back(ai + (UINT64_MAX + 1) - bi - borrow);
-            borrow = 1;
+        auto field = std::find_if(std::begin(TUNING_FIELDS), std::end(TUNING_FIELDS),
+                                  [&key](const auto& f) { return key == f.first; });
+        if (field == std::end(TUNING_FIELDS)) {
+            throw std::invalid_argument("Unknown tuning field: " + key);
+        }
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::invalid_argument("Bad value for " + key + ": " + value);
+        }
+        try {
+            t.*(field->second) = static_cast<size_t>(std::stoull(value));
+        } catch (const std::out_of_range&) {
+            throw std::invalid_argument("Bad value for " + key + ": " + value);
         }
     }
-    
-    return BigNum(result, false);
+    return t;
+}
+
+std::string BigNum::formatTuning(const BigNumTuning& t) {
+    std::string out;
+    for (const auto& field : TUNING_FIELDS) {
+        out += field.first;
+        out += " = " + std::to_string(t.*(field.second)) + "\n";
+    }
+    return out;
+}
+
+void BigNum::loadTuning(const std::string& path) {
+    setTuning(parseTuning(readProfile(path)));
+}
+
+namespace {
+
+mpn::MulThresholds mulThresholds() {
+    const BigNumTuning& t = BigNum::tuning();
+    return {t.karatsuba_threshold, t.toom3_threshold, t.ntt_threshold};
 }
 
+}  // namespace
+
 BigNum BigNum::multiplyUnsigned(const BigNum& other) const {
-    // Choose algorithm based on input size
-    size_t maxSize = std::max(digits.size(), other.digits.size());
+    // Choose algorithm based on the smaller operand; the recursive tiers
+    // slice unbalanced products themselves
+    size_t minSize = std::min(digits.size(), other.digits.size());
     
-    if (maxSize >= KARATSUBA_THRESHOLD) {
-        return multiplyKaratsuba(other);
+    if (minSize >= tuning().karatsuba_threshold) {
+        return multiplyLarge(other);
     } else {
+        BIGNUM_STAT_SCOPE(MulBasecase, minSize);
         return multiplySchoolbook(other);
     }
 }
 
 BigNum BigNum::multiplySchoolbook(const BigNum& other) const {
-    const std::vector<uint64_t>& a = digits;
-    const std::vector<uint64_t>& b = other.digits;
-    
-    std::vector<uint64_t> result(a.size() + b.size(), 0);
+    const size_t an = digits.size();
+    const size_t bn = other.digits.size();
     
-    for (size_t i = 0; i < a.size(); ++i) {
-        __uint128_t carry = 0;
-        for (size_t j = 0; j < b.size() || carry; ++j) {
-            __uint128_t prod = static_cast<__uint128_t>(result[i + j]) + carry;
-            if (j < b.size()) {
-                prod += static_cast<__uint128_t>(a[i]) * b[j];
-            }
-            
-            result[i + j] = static_cast<uint64_t>(prod & 0xFFFFFFFFFFFFFFFFULL);
-            carry = prod >> 64;
-        }
+    LimbVector result(an + bn);
+    if (an >= bn) {
+        mpn::mul_basecase(result.data(), digits.data(), an, other.digits.data(), bn);
+    } else {
+        mpn::mul_basecase(result.data(), other.digits.data(), bn, digits.data(), an);
     }
     
-    return BigNum(result, false);
+    return BigNum(std::move(result), false);
 }
 
-BigNum BigNum::multiplyKaratsuba(const BigNum& other) const {
-    // Base case: use schoolbook for small numbers
-    size_t maxSize = std::max(digits.size(), other.digits.size());
-    if (maxSize < KARATSUBA_THRESHOLD) {
-        return multiplySchoolbook(other);
-    }
-    
-    // Pad to equal sizes
-    size_t n = maxSize;
-    if (n % 2 != 0) n++; // Make even for easier splitting
-    
-    BigNum a = *this;
-    BigNum b = other;
-    
-    // Pad with zeros if necessary
-    while (a.digits.size() < n) a.digits.push_back(0);
-    while (b.digits.size() < n) b.digits.push_back(0);
-    
-    // Split in half
-    size_t half = n / 2;
-    
-    // a = a1 * R^half + a0
-    BigNum a0(std::vector<uint64_t>(a.digits.begin(), a.digits.begin() + half), false);
-    BigNum a1(std::vector<uint64_t>(a.digits.begin() + half, a.digits.end()), false);
+BigNum BigNum::multiplyLarge(const BigNum& other) const {
+    const LimbVector* a = &digits;
+    const LimbVector* b = &other.digits;
+    if (a->size() < b->size()) std::swap(a, b);
     
-    // b = b1 * R^half + b0  
-    BigNum b0(std::vector<uint64_t>(b.digits.begin(), b.digits.begin() + half), false);
-    BigNum b1(std::vector<uint64_t>(b.digits.begin() + half, b.digits.end()), false);
+    // One scratch block for the whole recursion
+    const mpn::MulThresholds t = mulThresholds();
+#if BIGNUM_STATS
+    const size_t bn = b->size();
+    StatScope statScope(bn >= t.ntt ? BigNumStats::MulNtt
+                        : bn >= t.toom3 && mpn::toom3_fits(a->size(), bn) ? BigNumStats::MulToom3
+                        : BigNumStats::MulKaratsuba, bn);
+#endif
+    LimbVector result(a->size() + b->size());
+    LimbVector scratch(mpn::mul_scratch(a->size(), b->size(), t));
+    mpn::mul(result.data(), a->data(), a->size(), b->data(), b->size(), scratch.data(), t);
     
-    // Recursive calls
-    BigNum z0 = a0.multiplyUnsigned(b0);  // Low part
-    BigNum z2 = a1.multiplyUnsigned(b1);  // High part
-    BigNum z1 = (a1 + a0).multiplyUnsigned(b1 + b0) - z2 - z0;  // Middle part
-    
-    // Combine: result = z2 * R^n + z1 * R^half + z0
-    BigNum result = z0;
-    result += z1 << (half * 64);
-    result += z2 << (n * 64);
-
-    return result;
+    return BigNum(std::move(result), false);
 }
 
 std::pair<BigNum, BigNum> BigNum::divideUnsigned(const BigNum& divisor) const {
+    BIGNUM_STAT_SCOPE(Division, divisor.digits.size());
+    // Operates on magnitudes; callers apply the signs
     if (divisor.isZero()) {
         throw std::invalid_argument("Division by zero");
     }
     
-    if (compare(divisor) < 0) {
-        return {BigNum(0LL), *this};
+    if (compareAbs(divisor) < 0) {
+        return {BigNum(0LL), BigNum(LimbVector(digits))};
     }
     
-    BigNum remainder = *this;
-    BigNum quotient(0LL);
-    BigNum temp = divisor;
+    const size_t n = divisor.digits.size();
+    const size_t m = digits.size() - n;
+    LimbVector quotient(m + 1);
     
-    // Find the highest bit position
-    int shift = 0;
-    while (temp <= remainder) {
-        temp <<= 1;
-        shift++;
+    // Fast path: single-limb divisor
+    if (n == 1) {
+        uint64_t rem = mpn::divrem_1(quotient.data(), digits.data(), digits.size(), divisor.digits[0]);
+        return {BigNum(std::move(quotient)), BigNum(LimbVector{rem})};
     }
     
-    temp >>= 1;
-    shift--;
+    // Normalize: shift both operands so the divisor's top limb has its MSB set.
+    // The remainder buffer doubles as the working dividend, and its tail holds
+    // the shifted divisor, so only the quotient and remainder are allocated.
+    const unsigned s = mpn::clz(divisor.digits.back());
+    LimbVector remainder(m + n + 1 + (s ? n : 0));
+    uint64_t* un = remainder.data();
+    const uint64_t* vn = divisor.digits.data();
     
-    for (int i = shift; i >= 0; --i) {
-        if (remainder >= temp) {
-            remainder -= temp;
-            quotient += (BigNum(1LL) << i);
-        }
-        temp >>= 1;
+    if (s == 0) {
+        mpn::copy(un, digits.data(), m + n);
+        un[m + n] = 0;
+    } else {
+        uint64_t* vs = un + m + n + 1;
+        mpn::lshift(vs, divisor.digits.data(), n, s);
+        vn = vs;
+        un[m + n] = mpn::lshift(un, digits.data(), m + n, s);
+    }
+    
+    mpn::divrem_knuth(quotient.data(), un, vn, m, n);
+    
+    // Denormalize the remainder in place
+    if (s != 0) {
+        mpn::rshift(un, un, n, s);
     }
+    remainder.resize(n);
     
-    return {quotient, remainder};
+    return {BigNum(std::move(quotient)), BigNum(std::move(remainder))};
 }
 
 // Arithmetic operations
 BigNum BigNum::operator+(const BigNum& other) const {
-    if (negative == other.negative) {
-        BigNum result = addUnsigned(other);
-        result.negative = negative;
-        return result;
-    } else {
-        // Different signs: this is actually subtraction
-        // Compare absolute values
-        int abs_compare = 0;
-        if (digits.size() != other.digits.size()) {
-            abs_compare = digits.size() < other.digits.size() ? -1 : 1;
-        } else {
-            for (int i = digits.size() - 1; i >= 0; --i) {
-                if (digits[i] != other.digits[i]) {
-                    abs_compare = digits[i] < other.digits[i] ? -1 : 1;
-                    break;
-                }
-            }
-        }
-        
-        if (abs_compare >= 0) {
-            // |this| >= |other|
-            BigNum result = subtractUnsigned(other);
-            result.negative = negative;
-            return result;
-        } else {
-            // |this| < |other|
-            BigNum result = other.subtractUnsigned(*this);
-            result.negative = other.negative;
-            return result;
-        }
-    }
+    BigNum result = withCapacity(std::max(digits.size(), other.digits.size()) + 1);
+    addSigned(result, *this, other, other.negative);
+    return result;
 }
 
 BigNum BigNum::operator-(const BigNum& other) const {
-    return *this + (-other);
+    BigNum result = withCapacity(std::max(digits.size(), other.digits.size()) + 1);
+    addSigned(result, *this, other, !other.negative);
+    return result;
 }
 
 BigNum BigNum::operator*(const BigNum& other) const {
+    if (&other == this) {
+        return square();
+    }
     BigNum result = multiplyUnsigned(other);
     result.negative = negative ^ other.negative;
     result.removeLeadingZeros();
     return result;
 }
 
+BigNum BigNum::square() const {
+    // The square is never negative
+    const size_t n = digits.size();
+    LimbVector result(2 * n);
+    const size_t threshold = tuning().karatsuba_sqr_threshold;
+#if BIGNUM_STATS
+    StatScope statScope(n < threshold ? BigNumStats::SqrBasecase
+                        : n >= tuning().toom3_threshold ? BigNumStats::SqrLarge
+                        : BigNumStats::SqrKaratsuba, n);
+#endif
+    if (n < threshold) {
+        mpn::sqr_basecase(result.data(), digits.data(), n);
+    } else if (n >= tuning().toom3_threshold) {
+        // Toom-3 and NTT have no dedicated squaring; the NTT still
+        // transforms a repeated operand only once
+        const mpn::MulThresholds t = mulThresholds();
+        LimbVector scratch(mpn::mul_scratch(n, n, t));
+        mpn::mul(result.data(), digits.data(), n, digits.data(), n, scratch.data(), t);
+    } else {
+        LimbVector scratch(mpn::sqr_karatsuba_scratch(n, threshold));
+        mpn::sqr_karatsuba(result.data(), digits.data(), n, scratch.data(), threshold);
+    }
+    return BigNum(std::move(result), false);
+}
+
+BigNum BigNum::pow(uint64_t exponent) const {
+    if (exponent == 0) return BigNum(1LL);
+    if (exponent == 1 || isZero()) return *this;
+    const bool neg = negative && (exponent & 1);
+    if (digits.size() == 1 && digits[0] == 1) return neg ? BigNum(-1LL) : BigNum(1LL);
+    
+    // The result has at most bitLength() * exponent bits, and the final
+    // shift takes an int
+    if (exponent > static_cast<uint64_t>(INT_MAX) / bitLength()) {
+        throw std::overflow_error("Power too large to represent");
+    }
+    
+    // |this| = odd * 2^shift: only the odd part goes through the binary
+    // powering, the power of two becomes one shift at the end
+    size_t shift = 0;
+    while (digits[shift / 64] == 0) shift += 64;
+    shift += mpn::ctz(digits[shift / 64]);
+    BigNum odd = *this >> static_cast<int>(shift);
+    odd.negative = false;
+    
+    BigNum result = odd;
+    if (!odd.isOne()) {
+        for (int bit = 62 - mpn::clz(exponent); bit >= 0; --bit) {
+            BigNum::CancelScope::checkpoint();
+            result = result.square();
+            if ((exponent >> bit) & 1) result *= odd;
+        }
+    }
+    result <<= static_cast<int>(shift * exponent);
+    result.negative = neg;
+    return result;
+}
+
 BigNum BigNum::operator/(const BigNum& other) const {
     auto result = divideUnsigned(other);
     result.first.negative = negative ^ other.negative;
@@ -310,12 +938,12 @@ BigNum BigNum::operator%(const BigNum& other) const {
 
 // In-place operations
 BigNum& BigNum::operator+=(const BigNum& other) {
-    *this = *this + other;
+    addSigned(*this, *this, other, other.negative);
     return *this;
 }
 
 BigNum& BigNum::operator-=(const BigNum& other) {
-    *this = *this - other;
+    addSigned(*this, *this, other, !other.negative);
     return *this;
 }
 
@@ -334,6 +962,121 @@ BigNum& BigNum::operator%=(const BigNum& other) {
     return *this;
 }
 
+// |*this| += |a| |b|, or -= when `subtract`; the sign of *this flips if
+// the subtraction goes below zero
+void BigNum::accumulateProduct(const BigNum& a, const BigNum& b, bool subtract) {
+    if (a.isZero() || b.isZero()) return;
+    // The rows read a and b while the limbs of *this change
+    if (&a == this) return accumulateProduct(BigNum(a), b, subtract);
+    if (&b == this) return accumulateProduct(a, BigNum(b), subtract);
+    
+    const LimbVector* up = &a.digits;
+    const LimbVector* vp = &b.digits;
+    if (up->size() < vp->size()) std::swap(up, vp);
+    const size_t an = up->size(), bn = vp->size();
+    
+    // One spare limb takes the final carry, so only a subtraction can run
+    // out of the top
+    const size_t len = std::max(digits.size(), an + bn) + 1;
+    digits.resize(len);
+    mpn::limb_t* rp = digits.data();
+    mpn::limb_t borrow = 0;
+    
+    if (bn < tuning().karatsuba_threshold) {
+        for (size_t i = 0; i < bn; ++i) {
+            mpn::limb_t* row = rp + i;
+            if (subtract) {
+                const mpn::limb_t hi = mpn::submul_1(row, up->data(), an, (*vp)[i]);
+                borrow |= mpn::sub_1(row + an, row + an, len - i - an, hi);
+            } else {
+                const mpn::limb_t hi = mpn::addmul_1(row, up->data(), an, (*vp)[i]);
+                mpn::add_1(row + an, row + an, len - i - an, hi);
+            }
+        }
+    } else {
+        const mpn::MulThresholds t = mulThresholds();
+        LimbVector product(an + bn);
+        LimbVector scratch(mpn::mul_scratch(an, bn, t));
+        mpn::mul(product.data(), up->data(), an, vp->data(), bn, scratch.data(), t);
+        if (subtract) {
+            borrow = mpn::sub(rp, rp, len, product.data(), an + bn);
+        } else {
+            mpn::add(rp, rp, len, product.data(), an + bn);
+        }
+    }
+    
+    // Each row only lowers the value, so a borrow anywhere means it ended
+    // below zero and the limbs hold its two's complement
+    if (borrow) {
+        for (size_t i = 0; i < len; ++i) rp[i] = ~rp[i];
+        mpn::add_1(rp, rp, len, 1);
+        negative = !negative;
+    }
+    removeLeadingZeros();
+}
+
+BigNum& BigNum::addMul(const BigNum& a, const BigNum& b) {
+    accumulateProduct(a, b, (a.negative != b.negative) != negative);
+    return *this;
+}
+
+BigNum& BigNum::subMul(const BigNum& a, const BigNum& b) {
+    accumulateProduct(a, b, (a.negative != b.negative) == negative);
+    return *this;
+}
+
+BigNum BigNum::mulMod(const BigNum& a, const BigNum& b, const BigNum& modulus) {
+    if (modulus.isZero()) {
+        throw std::invalid_argument("Division by zero");
+    }
+    const bool neg = a.negative != b.negative;
+    const LimbVector* up = &a.digits;
+    const LimbVector* vp = &b.digits;
+    if (up->size() < vp->size()) std::swap(up, vp);
+    const size_t an = up->size(), bn = vp->size();
+    const size_t n = modulus.digits.size();
+    const size_t pn = an + bn;
+    if (a.isZero() || b.isZero() || pn < n) {
+        return a * b;  // already below the modulus
+    }
+    
+    // Product (plus the spill limb of the normalising shift), quotient,
+    // shifted divisor and multiplication scratch share one block
+    const mpn::MulThresholds t = mulThresholds();
+    const size_t m = pn - n;
+    const size_t scratchLimbs = mpn::mul_scratch(an, bn, t);
+    LimbVector work(pn + 1 + (m + 1) + n + scratchLimbs);
+    mpn::limb_t* un = work.data();
+    mpn::limb_t* qp = un + pn + 1;
+    mpn::limb_t* vs = qp + m + 1;
+    if (up == vp && an < tuning().karatsuba_sqr_threshold) {
+        mpn::sqr_basecase(un, up->data(), an);
+    } else {
+        mpn::mul(un, up->data(), an, vp->data(), bn, vs + n, t);
+    }
+    
+    LimbVector remainder;
+    if (n == 1) {
+        remainder.push_back(mpn::mod_1(un, pn, modulus.digits[0]));
+    } else {
+        const unsigned s = mpn::clz(modulus.digits.back());
+        const mpn::limb_t* vn = modulus.digits.data();
+        if (s == 0) {
+            un[pn] = 0;
+        } else {
+            mpn::lshift(vs, modulus.digits.data(), n, s);
+            vn = vs;
+            un[pn] = mpn::lshift(un, un, pn, s);
+        }
+        mpn::divrem_knuth(qp, un, vn, m, n);
+        if (s != 0) mpn::rshift(un, un, n, s);
+        remainder.resize(n);
+        mpn::copy(remainder.data(), un, n);
+    }
+    BigNum result(std::move(remainder), neg);
+    return result;
+}
+
 // Comparison operations
 bool BigNum::operator==(const BigNum& other) const {
     return compare(other) == 0;
@@ -376,121 +1119,198 @@ BigNum BigNum::operator+() const {
 BigNum BigNum::operator<<(int shift) const {
     if (shift <= 0) return *this;
     
-    int wordShift = shift / 64;
-    int bitShift = shift % 64;
+    BigNum result = withCapacity(digits.size() + shift / 64 + 1);
+    result = *this;
+    result <<= shift;
+    return result;
+}
+
+BigNum BigNum::operator>>(int shift) const {
+    if (shift <= 0) return *this;
+    
+    BigNum result = *this;
+    result >>= shift;
+    return result;
+}
+
+BigNum& BigNum::operator<<=(int shift) {
+    if (shift <= 0 || isZero()) return *this;
+    
+    const size_t wordShift = shift / 64;
+    const unsigned bitShift = shift % 64;
+    const size_t n = digits.size();
     
-    std::vector<uint64_t> result(digits.size() + wordShift + 1, 0);
+    digits.resize(n + wordShift + 1);
+    uint64_t* rp = digits.data();
     
+    // Move the limbs up first; lshift walks from the top so it can work in place
     if (bitShift == 0) {
-        std::copy(digits.begin(), digits.end(), result.begin() + wordShift);
+        rp[n + wordShift] = 0;
+        std::copy_backward(rp, rp + n, rp + n + wordShift);
     } else {
-        uint64_t carry = 0;
-        for (size_t i = 0; i < digits.size(); ++i) {
-            __uint128_t temp = (static_cast<__uint128_t>(digits[i]) << bitShift) | carry;
-            result[i + wordShift] = static_cast<uint64_t>(temp & 0xFFFFFFFFFFFFFFFFULL);
-            carry = static_cast<uint64_t>(temp >> 64);
-        }
-        if (carry) {
-            result[digits.size() + wordShift] = carry;
-        }
+        rp[n + wordShift] = mpn::lshift(rp + wordShift, rp, n, bitShift);
     }
+    mpn::zero(rp, wordShift);
     
-    return BigNum(result, negative);
+    removeLeadingZeros();
+    return *this;
 }
 
-BigNum BigNum::operator>>(int shift) const {
+BigNum& BigNum::operator>>=(int shift) {
     if (shift <= 0) return *this;
     
-    int wordShift = shift / 64;
-    int bitShift = shift % 64;
+    const size_t wordShift = shift / 64;
+    const unsigned bitShift = shift % 64;
+    const size_t n = digits.size();
     
-    if (wordShift >= static_cast<int>(digits.size())) {
-        return BigNum::zero();
+    if (wordShift >= n) {
+        digits.assign(1, 0);
+        negative = false;
+        return *this;
     }
     
-    std::vector<uint64_t> result(digits.size() - wordShift);
-    
+    uint64_t* rp = digits.data();
     if (bitShift == 0) {
-        std::copy(digits.begin() + wordShift, digits.end(), result.begin());
+        mpn::copy(rp, rp + wordShift, n - wordShift);
     } else {
-        uint64_t carry = 0;
-        for (int i = digits.size() - 1; i >= wordShift; --i) {
-            __uint128_t temp = (static_cast<__uint128_t>(carry) << 64) | digits[i];
-            result[i - wordShift] = static_cast<uint64_t>(temp >> bitShift);
-            carry = static_cast<uint64_t>(temp & ((1ULL << bitShift) - 1));
-        }
+        mpn::rshift(rp, rp + wordShift, n - wordShift, bitShift);
     }
+    digits.resize(n - wordShift);
     
-    return BigNum(result, negative);
-}
-
-BigNum& BigNum::operator<<=(int shift) {
-    *this = *this << shift;
-    return *this;
-}
-
-BigNum& BigNum::operator>>=(int shift) {
-    *this = *this >> shift;
+    removeLeadingZeros();
     return *this;
 }
 
 // Bitwise operations
 BigNum BigNum::operator&(const BigNum& other) const {
-    size_t maxSize = std::max(digits.size(), other.digits.size());
-    std::vector<uint64_t> result(maxSize, 0);
-    
-    for (size_t i = 0; i < maxSize; ++i) {
-        uint64_t a_digit = (i < digits.size()) ? digits[i] : 0;
-        uint64_t b_digit = (i < other.digits.size()) ? other.digits[i] : 0;
-        result[i] = a_digit & b_digit;
-    }
-    
-    return BigNum(result, false);
+    BigNum result = *this;
+    result &= other;
+    return result;
 }
 
 BigNum BigNum::operator|(const BigNum& other) const {
-    size_t maxSize = std::max(digits.size(), other.digits.size());
-    std::vector<uint64_t> result(maxSize, 0);
-    
-    for (size_t i = 0; i < maxSize; ++i) {
-        uint64_t a_digit = (i < digits.size()) ? digits[i] : 0;
-        uint64_t b_digit = (i < other.digits.size()) ? other.digits[i] : 0;
-        result[i] = a_digit | b_digit;
-    }
-    
-    return BigNum(result, false);
+    BigNum result = withCapacity(std::max(digits.size(), other.digits.size()));
+    result = *this;
+    result |= other;
+    return result;
 }
 
 BigNum BigNum::operator^(const BigNum& other) const {
-    size_t maxSize = std::max(digits.size(), other.digits.size());
-    std::vector<uint64_t> result(maxSize, 0);
-    
-    for (size_t i = 0; i < maxSize; ++i) {
-        uint64_t a_digit = (i < digits.size()) ? digits[i] : 0;
-        uint64_t b_digit = (i < other.digits.size()) ? other.digits[i] : 0;
-        result[i] = a_digit ^ b_digit;
-    }
-    
-    return BigNum(result, false);
+    BigNum result = withCapacity(std::max(digits.size(), other.digits.size()));
+    result = *this;
+    result ^= other;
+    return result;
 }
 
 BigNum& BigNum::operator&=(const BigNum& other) {
-    *this = *this & other;
+    // Bits above the shorter operand are always cleared
+    size_t n = std::min(digits.size(), other.digits.size());
+    digits.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        digits[i] &= other.digits[i];
+    }
+    negative = false;
+    removeLeadingZeros();
     return *this;
 }
 
 BigNum& BigNum::operator|=(const BigNum& other) {
-    *this = *this | other;
+    if (digits.size() < other.digits.size()) {
+        digits.resize(other.digits.size(), 0);
+    }
+    for (size_t i = 0; i < other.digits.size(); ++i) {
+        digits[i] |= other.digits[i];
+    }
+    negative = false;
+    removeLeadingZeros();
     return *this;
 }
 
 BigNum& BigNum::operator^=(const BigNum& other) {
-    *this = *this ^ other;
+    if (digits.size() < other.digits.size()) {
+        digits.resize(other.digits.size(), 0);
+    }
+    for (size_t i = 0; i < other.digits.size(); ++i) {
+        digits[i] ^= other.digits[i];
+    }
+    negative = false;
+    removeLeadingZeros();
     return *this;
 }
 
-// Optimized modular exponentiation
-BigNum BigNum::modPow(const BigNum& exponent, const BigNum& modulus) const {
+namespace {
+
+// Writes x mod modulus into dst as exactly k limbs (zero padded). Values that
+// are already reduced are copied straight through.
+void loadReduced(mpn::limb_t* dst, const BigNum& x, const BigNum& modulus, size_t k) {
+    const LimbVector* src = &x.getDigits();
+    BigNum reduced;
+    if (x.isNegative() || x >= modulus) {
+        reduced = x % modulus;
+        if (reduced.isNegative()) {
+            reduced += modulus;
+        }
+        src = &reduced.getDigits();
+    }
+    size_t n = mpn::normalizedSize(src->data(), src->size());
+    mpn::copy(dst, src->data(), n);
+    mpn::zero(dst + n, k - n);
+}
+
+// Window width for sliding-window exponentiation, by exponent bit length.
+// Each extra bit doubles the odd-powers table but saves a multiplication
+// every ~w bits; these cutoffs minimise the total multiplication count.
+size_t expWindowBits(size_t bits) {
+    if (bits > 671) return 6;
+    if (bits > 239) return 5;
+    if (bits > 79) return 4;
+    if (bits > 23) return 3;
+    return 1;
+}
+
+inline bool expBit(const LimbVector& e, size_t i) {
+    return (e[i / 64] >> (i % 64)) & 1;
+}
+
+// Left-to-right sliding-window scan over the bits of e, read in place.
+// The table holds odd powers: set(i)/mul(i) load or multiply the accumulator
+// by base^(2i + 1), and sqr() squares it. The leading window seeds the
+// accumulator, so no squarings of one are ever done.
+template <typename Set, typename Mul, typename Sqr>
+void slidingWindow(const LimbVector& e, size_t bits, size_t w, Set set, Mul mul, Sqr sqr) {
+    bool started = false;
+    size_t i = bits;
+    while (i > 0) {
+        BigNum::CancelScope::checkpoint();
+        if (!expBit(e, i - 1)) {
+            sqr();
+            --i;
+            continue;
+        }
+        
+        // Longest window of at most w bits ending in a set bit
+        size_t lo = i > w ? i - w : 0;
+        while (!expBit(e, lo)) ++lo;
+        size_t value = 0;
+        for (size_t j = i; j-- > lo;) {
+            value = (value << 1) | expBit(e, j);
+        }
+        
+        if (started) {
+            for (size_t j = lo; j < i; ++j) sqr();
+            mul(value >> 1);
+        } else {
+            set(value >> 1);
+            started = true;
+        }
+        i = lo;
+    }
+}
+
+}  // namespace
+
+// Optimized modular exponentiation
+BigNum BigNum::modPow(const BigNum& exponent, const BigNum& modulus) const {
     if (modulus.isZero()) {
         throw std::invalid_argument("Modulus cannot be zero");
     }
@@ -504,7 +1324,7 @@ BigNum BigNum::modPow(const BigNum& exponent, const BigNum& modulus) const {
     }
     
     // Choose algorithm based on modulus size and whether it's odd
-    if (modulus.getDigits().size() >= MONTGOMERY_THRESHOLD && modulus.isOdd()) {
+    if (modulus.getDigits().size() >= tuning().montgomery_threshold && modulus.isOdd()) {
         return modPowMontgomery(exponent, modulus);
     } else {
         return modPowBinary(exponent, modulus);
@@ -514,85 +1334,563 @@ BigNum BigNum::modPow(const BigNum& exponent, const BigNum& modulus) const {
 BigNum BigNum::modPowMontgomery(const BigNum& exponent, const BigNum& modulus) const {
     try {
         MontgomeryContext mont(modulus);
+        return modPow(exponent, mont);
+    } catch (const Cancelled&) {
+        throw;
+    } catch (const std::exception&) {
+        // Fall back to binary method if Montgomery setup fails
+        BIGNUM_STAT_EVENT(ModPowFallback, modulus.getDigits().size());
+        return modPowBinary(exponent, modulus);
+    }
+}
+
+BigNum BigNum::modPow(const BigNum& exponent, const MontgomeryContext& mont) const {
+    BIGNUM_STAT_SCOPE(ModPowMontgomery, mont.k);
+    const BigNum& modulus = mont.modulus;
+    if (exponent.isZero()) {
+        return modulus.isOne() ? BigNum::zero() : BigNum::one();
+    }
+    
+    const size_t k = mont.k;
+    const mpn::limb_t* np = modulus.getDigits().data();
+    
+    const auto& e = exponent.getDigits();
+    const size_t bits = exponent.bitLength();
+    const size_t w = expWindowBits(bits);
+    const size_t entries = size_t(1) << (w - 1);
+    
+    // The loop runs on raw limbs in a local buffer, apart from the
+    // context kernels' scratch: odd powers (entries * k), accumulator (k), base^2 (k)
+    // and kernel scratch (2k + 2)
+    LimbVector work((entries + 2) * k + 2 * k + 2);
+    mpn::limb_t* table = work.data();
+    mpn::limb_t* acc = table + entries * k;
+    mpn::limb_t* b2 = acc + k;
+    mpn::limb_t* tp = b2 + k;
+    
+    // Convert the base to Montgomery form: REDC(x * R^2) = x * R mod N
+    loadReduced(table, *this, modulus, k);
+    const auto& r2 = mont.r2.getDigits();
+    mpn::copy(b2, r2.data(), r2.size());
+    mpn::zero(b2 + r2.size(), k - r2.size());
+    mpn::mont_mul(table, table, b2, np, k, mont.n0, tp);
+    
+    // Odd powers base^1, base^3, ..., base^(2 * entries - 1), all in
+    // Montgomery form
+    if (entries > 1) {
+        mpn::mont_sqr(b2, table, np, k, mont.n0, tp);
+        for (size_t i = 1; i < entries; ++i) {
+            mpn::mont_mul(table + i * k, table + (i - 1) * k, b2, np, k, mont.n0, tp);
+        }
+    }
+    
+    slidingWindow(e, bits, w,
+        [&](size_t i) { mpn::copy(acc, table + i * k, k); },
+        [&](size_t i) { mpn::mont_mul(acc, acc, table + i * k, np, k, mont.n0, tp); },
+        [&]() { mpn::mont_sqr(acc, acc, np, k, mont.n0, tp); });
+    
+    // Convert result back from Montgomery form
+    mpn::copy(tp, acc, k);
+    mpn::zero(tp + k, k);
+    LimbVector result(k);
+    mpn::mont_redc(result.data(), tp, np, k, mont.n0);
+    return BigNum(std::move(result), false);
+}
+
+std::vector<BigNum> BigNum::modPowBatch(const std::vector<BigNum>& bases,
+                                        const std::vector<BigNum>& exponents,
+                                        const std::vector<BigNum>& moduli) {
+    const size_t n = bases.size();
+    auto broadcastable = [n](size_t size) { return size == n || size == 1; };
+    if (!broadcastable(exponents.size()) || !broadcastable(moduli.size())) {
+        throw std::invalid_argument("modPowBatch needs one exponent and modulus per base, or a single shared one");
+    }
+    if (n == 0) return {};
+    
+    // Odd moduli on the Montgomery path get one context per distinct value,
+    // keyed on sign and raw limb bytes like MontgomeryCache
+    std::unordered_map<std::string, size_t> contextIndex;
+    std::vector<const BigNum*> contextModuli;
+    std::vector<size_t> itemContext(moduli.size(), SIZE_MAX);
+    for (size_t i = 0; i < moduli.size(); ++i) {
+        const BigNum& m = moduli[i];
+        if (m.isZero() || m.isOne() || m.isEven() || m.digits.size() < tuning().montgomery_threshold) continue;
+        std::string key(1, m.negative ? '-' : '+');
+        key.append(reinterpret_cast<const char*>(m.digits.data()), m.digits.size() * sizeof(uint64_t));
+        auto inserted = contextIndex.emplace(std::move(key), contextModuli.size());
+        if (inserted.second) contextModuli.push_back(&m);
+        itemContext[i] = inserted.first->second;
+    }
+    
+    auto pool = bignum::ThreadPool::shared();
+    std::vector<std::unique_ptr<MontgomeryContext>> contexts(contextModuli.size());
+    pool->parallelFor(contexts.size(), [&](size_t i) {
+        contexts[i] = std::make_unique<MontgomeryContext>(*contextModuli[i]);
+    });
+    
+    std::vector<BigNum> results(n);
+    pool->parallelFor(n, [&](size_t i) {
+        const BigNum& e = exponents[exponents.size() == 1 ? 0 : i];
+        const size_t m = moduli.size() == 1 ? 0 : i;
+        if (itemContext[m] != SIZE_MAX && !e.isZero()) {
+            results[i] = bases[i].modPow(e, *contexts[itemContext[m]]);
+        } else {
+            results[i] = bases[i].modPow(e, moduli[m]);
+        }
+    });
+    return results;
+}
+
+namespace {
+
+void checkProductArgs(const std::vector<BigNum>& bases, const std::vector<BigNum>& exponents) {
+    if (bases.size() != exponents.size()) {
+        throw std::invalid_argument("modPowProduct needs one exponent per base");
+    }
+    for (const BigNum& e : exponents) {
+        if (e.isNegative()) throw std::invalid_argument("modPowProduct exponents must be non-negative");
+    }
+}
+
+}  // namespace
+
+BigNum BigNum::modPowProduct(const std::vector<BigNum>& bases, const std::vector<BigNum>& exponents,
+                             const BigNum& modulus) {
+    checkProductArgs(bases, exponents);
+    if (modulus.isZero()) {
+        throw std::invalid_argument("Modulus cannot be zero");
+    }
+    if (modulus.isOne()) {
+        return BigNum::zero();
+    }
+    if (modulus.isOdd()) {
+        MontgomeryContext mont(modulus);
+        return modPowProduct(bases, exponents, mont);
+    }
+    
+    BigNum result = BigNum::one();
+    for (size_t i = 0; i < bases.size(); ++i) {
+        if (exponents[i].isZero()) continue;
+        result = mulMod(result, bases[i].modPow(exponents[i], modulus), modulus);
+    }
+    return result;
+}
+
+BigNum BigNum::modPowProduct(const std::vector<BigNum>& bases, const std::vector<BigNum>& exponents,
+                             const MontgomeryContext& mont) {
+    checkProductArgs(bases, exponents);
+    BIGNUM_STAT_SCOPE(ModPowProduct, mont.k);
+    const BigNum& modulus = mont.modulus;
+    if (modulus.isOne()) {
+        return BigNum::zero();
+    }
+    
+    // Bases with a zero exponent contribute nothing
+    std::vector<size_t> live;
+    size_t bits = 0, tableLimbs = 0;
+    for (size_t i = 0; i < bases.size(); ++i) {
+        const size_t b = exponents[i].bitLength();
+        if (!b) continue;
+        live.push_back(i);
+        bits = std::max(bits, b);
+        tableLimbs += (size_t(1) << (expWindowBits(b) - 1)) * mont.k;
+    }
+    if (live.empty()) {
+        return BigNum::one();
+    }
+    
+    const size_t k = mont.k;
+    const mpn::limb_t* np = modulus.getDigits().data();
+    
+    // Odd-power tables of every base back to back, then accumulator (k),
+    // base^2 (k) and kernel scratch (2k + 2), as in modPow(exponent, ctx)
+    LimbVector work(tableLimbs + 2 * k + 2 * k + 2);
+    mpn::limb_t* acc = work.data() + tableLimbs;
+    mpn::limb_t* b2 = acc + k;
+    mpn::limb_t* tp = b2 + k;
+    const auto& r2 = mont.r2.getDigits();
+    
+    // Each base's sliding windows, top first: once the squaring chain
+    // reaches bit `lo` the accumulator multiplies in `entry` of that base
+    struct Window {
+        size_t lo;
+        const mpn::limb_t* entry;
+    };
+    std::vector<std::vector<Window>> windows(live.size());
+    mpn::limb_t* table = work.data();
+    for (size_t j = 0; j < live.size(); ++j) {
+        const BigNum& base = bases[live[j]];
+        const LimbVector& e = exponents[live[j]].getDigits();
+        const size_t eb = exponents[live[j]].bitLength();
+        const size_t w = expWindowBits(eb);
+        const size_t entries = size_t(1) << (w - 1);
         
-        // Convert base to Montgomery form
-        BigNum base_mont = mont.toMontgomery(*this % modulus);
-        BigNum result_mont = mont.toMontgomery(BigNum(1LL));
-        
-        // Binary exponentiation in Montgomery form
-        BigNum exp = exponent;
-        BigNum current_base = base_mont;
+        loadReduced(table, base, modulus, k);
+        mpn::copy(b2, r2.data(), r2.size());
+        mpn::zero(b2 + r2.size(), k - r2.size());
+        mpn::mont_mul(table, table, b2, np, k, mont.n0, tp);
+        if (entries > 1) {
+            mpn::mont_sqr(b2, table, np, k, mont.n0, tp);
+            for (size_t i = 1; i < entries; ++i) {
+                mpn::mont_mul(table + i * k, table + (i - 1) * k, b2, np, k, mont.n0, tp);
+            }
+        }
         
-        while (!exp.isZero()) {
-            if (exp.isOdd()) {
-                result_mont = mont.multiply(result_mont, current_base);
+        // Same windows slidingWindow picks: longest run of at most w bits
+        // ending in a set bit, from the top
+        for (size_t i = eb; i > 0;) {
+            if (!expBit(e, i - 1)) {
+                --i;
+                continue;
+            }
+            size_t lo = i > w ? i - w : 0;
+            while (!expBit(e, lo)) ++lo;
+            size_t value = 0;
+            for (size_t b = i; b-- > lo;) {
+                value = (value << 1) | expBit(e, b);
+            }
+            windows[j].push_back({lo, table + (value >> 1) * k});
+            i = lo;
+        }
+        table += entries * k;
+    }
+    
+    // One squaring chain from the top bit down; at each position every base
+    // whose window ends there multiplies in. The first window seeds the
+    // accumulator, so no squarings of one are done.
+    std::vector<size_t> next(live.size(), 0);
+    bool started = false;
+    for (size_t i = bits; i-- > 0;) {
+        BigNum::CancelScope::checkpoint();
+        if (started) mpn::mont_sqr(acc, acc, np, k, mont.n0, tp);
+        for (size_t j = 0; j < live.size(); ++j) {
+            if (next[j] == windows[j].size() || windows[j][next[j]].lo != i) continue;
+            const mpn::limb_t* entry = windows[j][next[j]++].entry;
+            if (started) {
+                mpn::mont_mul(acc, acc, entry, np, k, mont.n0, tp);
+            } else {
+                mpn::copy(acc, entry, k);
+                started = true;
             }
-            current_base = mont.multiply(current_base, current_base);
-            exp >>= 1;
         }
+    }
+    
+    mpn::copy(tp, acc, k);
+    mpn::zero(tp + k, k);
+    LimbVector result(k);
+    mpn::mont_redc(result.data(), tp, np, k, mont.n0);
+    return BigNum(std::move(result), false);
+}
+
+BigNum BigNum::modPowConstantTime(const BigNum& exponent, const BigNum& modulus,
+                                  ConstantTimeMethod method) const {
+    MontgomeryContext mont(modulus);
+    return modPowConstantTime(exponent, mont, method);
+}
+
+BigNum BigNum::modPowConstantTime(const BigNum& exponent, const MontgomeryContext& mont,
+                                  ConstantTimeMethod method) const {
+    BIGNUM_STAT_SCOPE(ModPowConstantTime, mont.k);
+    const BigNum& modulus = mont.modulus;
+    const size_t k = mont.k;
+    const mpn::limb_t* np = modulus.getDigits().data();
+    const mpn::limb_t n0 = mont.n0;
+    
+    // The exponent is processed at a fixed width that depends only on its
+    // limb count and the modulus size; one spare zero limb lets windows run
+    // past the top without a bounds check
+    const auto& e = exponent.getDigits();
+    const size_t elimbs = std::max(e.size(), k);
+    const size_t bits = elimbs * 64;
+    LimbVector ebuf(elimbs + 1);
+    mpn::copy(ebuf.data(), e.data(), e.size());
+    
+    LimbVector result(k);
+    
+    if (method == ConstantTimeMethod::Ladder) {
+        // Montgomery ladder: r0 = base^(prefix), r1 = base^(prefix + 1), and
+        // every bit does one multiply and one square whatever its value
+        LimbVector work(6 * k + 2);
+        mpn::limb_t* r0 = work.data();
+        mpn::limb_t* r1 = r0 + k;
+        mpn::limb_t* r2 = r1 + k;
+        mpn::limb_t* tp = r2 + k;
         
-        // Convert result back from Montgomery form
-        return mont.fromMontgomery(result_mont);
+        loadReduced(r1, *this, modulus, k);
+        const auto& rr = mont.r2.getDigits();
+        mpn::copy(r2, rr.data(), rr.size());
+        mpn::zero(r2 + rr.size(), k - rr.size());
+        mpn::mont_mul_ct(r0, r1, r2, np, k, n0, tp);
+        mpn::copy(r1, r0, k);
+        mpn::copy(tp, r2, k);
+        mpn::zero(tp + k, k);
+        mpn::mont_redc_ct(r0, tp, np, k, n0);  // R mod N, i.e. one
         
-    } catch (const std::exception&) {
-        // Fall back to binary method if Montgomery setup fails
-        return modPowBinary(exponent, modulus);
+        for (size_t i = bits; i-- > 0;) {
+            CancelScope::checkpoint();
+            mpn::limb_t mask = 0 - ((ebuf[i / 64] >> (i % 64)) & 1);
+            mpn::cnd_swap(r0, r1, k, mask);
+            mpn::mont_mul_ct(r1, r0, r1, np, k, n0, tp);
+            mpn::mont_sqr_ct(r0, r0, np, k, n0, tp);
+            mpn::cnd_swap(r0, r1, k, mask);
+        }
+        
+        mpn::copy(tp, r0, k);
+        mpn::zero(tp + k, k);
+        mpn::mont_redc_ct(result.data(), tp, np, k, n0);
+        return BigNum(std::move(result), false);
+    }
+    
+    // Fixed window: table[j] = base^j in Montgomery form for every j below
+    // 2^w, stored interleaved and read back with a masked gather
+    const size_t w = std::min<size_t>(expWindowBits(bits), 5);
+    const size_t entries = size_t(1) << w;
+    LimbVector work((entries + 2) * k + 2 * k + 2);
+    mpn::limb_t* table = work.data();
+    mpn::limb_t* acc = table + entries * k;
+    mpn::limb_t* tmp = acc + k;
+    mpn::limb_t* tp = tmp + k;
+    
+    loadReduced(tmp, *this, modulus, k);
+    const auto& rr = mont.r2.getDigits();
+    mpn::copy(acc, rr.data(), rr.size());
+    mpn::zero(acc + rr.size(), k - rr.size());
+    mpn::mont_mul_ct(tp + k + 2, tmp, acc, np, k, n0, tp);  // base * R
+    mpn::copy(tmp, tp + k + 2, k);
+    mpn::copy(tp, acc, k);
+    mpn::zero(tp + k, k);
+    mpn::mont_redc_ct(acc, tp, np, k, n0);  // R mod N, i.e. one
+    mpn::scatter(table, entries, acc, k, 0);
+    for (size_t j = 1; j < entries; ++j) {
+        mpn::mont_mul_ct(acc, acc, tmp, np, k, n0, tp);
+        mpn::scatter(table, entries, acc, k, j);
+    }
+    
+    auto window = [&](size_t pos) {
+        size_t limb = pos / 64, shift = pos % 64;
+        mpn::limb_t v = ebuf[limb] >> shift;
+        if (shift + w > 64) v |= ebuf[limb + 1] << (64 - shift);
+        return static_cast<size_t>(v & (entries - 1));
+    };
+    
+    const size_t windows = (bits + w - 1) / w;
+    mpn::gather(acc, table, entries, k, window((windows - 1) * w));
+    for (size_t win = windows - 1; win-- > 0;) {
+        CancelScope::checkpoint();
+        for (size_t j = 0; j < w; ++j) {
+            mpn::mont_sqr_ct(acc, acc, np, k, n0, tp);
+        }
+        mpn::gather(tmp, table, entries, k, window(win * w));
+        mpn::mont_mul_ct(acc, acc, tmp, np, k, n0, tp);
     }
+    
+    mpn::copy(tp, acc, k);
+    mpn::zero(tp + k, k);
+    mpn::mont_redc_ct(result.data(), tp, np, k, n0);
+    return BigNum(std::move(result), false);
 }
 
 BigNum BigNum::modPowBinary(const BigNum& exponent, const BigNum& modulus) const {
-    BigNum result(1LL);
     BigNum base = *this % modulus;
-    BigNum exp = exponent;
+    if (base.isNegative()) {
+        base += modulus;
+    }
     
-    // Use Barrett reduction for large moduli
-    if (modulus.getDigits().size() >= BARRETT_THRESHOLD) {
+    // Use Barrett reduction for large moduli, basic modular reduction
+    // otherwise
+    std::unique_ptr<BarrettContext> barrett;
+    if (modulus.getDigits().size() >= tuning().barrett_threshold) {
         try {
-            BarrettContext barrett(modulus);
-            
-            while (!exp.isZero()) {
-                if (exp.isOdd()) {
-                    result = barrett.reduce(result * base);
-                }
-                base = barrett.reduce(base * base);
-                exp >>= 1;
-            }
-            
-            return result;
+            barrett.reset(new BarrettContext(modulus));
         } catch (const std::exception&) {
             // Fall back to basic modular arithmetic
+            BIGNUM_STAT_EVENT(BarrettFallback, modulus.getDigits().size());
         }
     }
-    
-    // Basic binary exponentiation with simple modular reduction
-    while (!exp.isZero()) {
-        if (exp.isOdd()) {
-            result = (result * base) % modulus;
+#if BIGNUM_STATS
+    StatScope statScope(barrett ? BigNumStats::ModPowBarrett : BigNumStats::ModPowBinary, modulus.getDigits().size());
+#endif
+    auto reduce = [&](const BigNum& x) {
+        return barrett ? barrett->reduce(x) : x % modulus;
+    };
+    
+    const size_t bits = exponent.bitLength();
+    const size_t w = expWindowBits(bits);
+    
+    // Odd powers base^1, base^3, ..., base^(2^w - 1)
+    std::vector<BigNum> table(size_t(1) << (w - 1));
+    table[0] = base;
+    if (table.size() > 1) {
+        BigNum b2 = reduce(base.square());
+        for (size_t i = 1; i < table.size(); ++i) {
+            table[i] = reduce(table[i - 1] * b2);
         }
-        base = (base * base) % modulus;
-        exp >>= 1;
     }
     
+    BigNum result;
+    slidingWindow(exponent.getDigits(), bits, w,
+        [&](size_t i) { result = table[i]; },
+        [&](size_t i) { result = reduce(result * table[i]); },
+        [&]() { result = reduce(result.square()); });
+    
     return result;
 }
 
+namespace {
+
+// Largest odd modulus (in limbs) inverted by the binary algorithm; above it
+// Lehmer's extended GCD, which retires ~62 bits per pass, is faster
+constexpr size_t BINARY_INVERSE_LIMBS = 2;
+
+}  // namespace
+
 BigNum BigNum::gcd(const BigNum& other) const {
+    BIGNUM_STAT_SCOPE(Gcd, std::min(digits.size(), other.digits.size()));
     BigNum a = *this;
     BigNum b = other;
     
     if (a.negative) a = -a;
     if (b.negative) b = -b;
     
+    return lehmerGcd(std::move(a), std::move(b), nullptr, nullptr);
+}
+
+BigNum BigNum::lehmerGcd(BigNum a, BigNum b, BigNum* sOut, BigNum* tOut) {
+    // Cofactors of a (s_a, t_a) and of b (s_b, t_b) over the inputs
+    BigNum sa(1), sb(0), ta(0), tb(1);
+    
+    // x * p - y * q for non-negative words p, q and a non-negative result
+    auto combine = [](const BigNum& x, uint64_t p, const BigNum& y, uint64_t q) {
+        const size_t n = std::max(x.digits.size(), y.digits.size()) + 1;
+        LimbVector r(n, 0);
+        r[x.digits.size()] = mpn::mul_1(r.data(), x.digits.data(), x.digits.size(), p);
+        const size_t yn = y.digits.size();
+        mpn::limb_t borrow = mpn::submul_1(r.data(), y.digits.data(), yn, q);
+        mpn::sub_1(r.data() + yn, r.data() + yn, n - yn, borrow);
+        return BigNum(std::move(r), false);
+    };
+    // x * p + y * q for signed words, on signed cofactors
+    auto combineSigned = [](const BigNum& x, int64_t p, const BigNum& y, int64_t q) {
+        BigNum r = x * BigNum(p);
+        return r.addMul(y, BigNum(q));
+    };
+    // Top 62 bits of x at the bit offset that puts a's top bit at bit 61
+    auto leading = [](const BigNum& x, size_t n, int shift) -> int64_t {
+        const mpn::limb_t hi = x.digits.size() >= n ? x.digits[n - 1] : 0;
+        const mpn::limb_t lo = n >= 2 && x.digits.size() >= n - 1 ? x.digits[n - 2] : 0;
+        const mpn::dlimb_t window = (static_cast<mpn::dlimb_t>(hi) << 64) | lo;
+        return static_cast<int64_t>((window << shift) >> 66);
+    };
+    
     while (!b.isZero()) {
-        BigNum temp = b;
-        b = a % b;
-        a = temp;
+        if (a.compareAbs(b) < 0) {
+            // Euclid's step with quotient 0
+            std::swap(a, b);
+            std::swap(sa, sb);
+            std::swap(ta, tb);
+            continue;
+        }
+        
+        const size_t n = a.digits.size();
+        if (n == 1) {
+            // Both fit a word: finish in registers, carrying the cofactor
+            // matrix (entries bounded by the inputs) in 128-bit integers
+            mpn::limb_t x = a.digits[0], y = b.digits[0];
+            __int128_t A = 1, B = 0, C = 0, D = 1;
+            while (y != 0) {
+                const mpn::limb_t q = x / y;
+                mpn::limb_t r = x - q * y; x = y; y = r;
+                __int128_t T = A - static_cast<__int128_t>(q) * C; A = C; C = T;
+                T = B - static_cast<__int128_t>(q) * D; B = D; D = T;
+            }
+            auto wide = [](__int128_t v) {
+                const __uint128_t m = v < 0 ? -static_cast<__uint128_t>(v) : v;
+                BigNum r(std::vector<uint64_t>{static_cast<uint64_t>(m), static_cast<uint64_t>(m >> 64)}, false);
+                return v < 0 ? -r : r;
+            };
+            a = BigNum(std::vector<uint64_t>{x}, false);
+            if (sOut) (sa *= wide(A)).addMul(sb, wide(B));
+            if (tOut) (ta *= wide(A)).addMul(tb, wide(B));
+            break;
+        }
+        
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        {
+            const int shift = mpn::clz(a.digits[n - 1]);
+            int64_t x = leading(a, n, shift);
+            int64_t y = leading(b, n, shift);
+            // Knuth, TAOCP vol. 2, 4.5.2 Algorithm L: a quotient is only
+            // taken when both ends of its uncertainty interval agree
+            for (;;) {
+                if (y + C <= 0 || y + D <= 0) break;
+                const int64_t q = (x + A) / (y + C);
+                if (q != (x + B) / (y + D)) break;
+                int64_t T = A - q * C; A = C; C = T;
+                T = B - q * D; B = D; D = T;
+                T = x - q * y; x = y; y = T;
+            }
+        }
+        
+        if (B == 0) {
+            // No usable matrix (b much shorter than a): one full-precision
+            // Euclid step
+            auto qr = a.divideUnsigned(b);
+            a = std::move(b);
+            b = std::move(qr.second);
+            if (sOut) {
+                sa.subMul(qr.first, sb);
+                std::swap(sa, sb);
+            }
+            if (tOut) {
+                ta.subMul(qr.first, tb);
+                std::swap(ta, tb);
+            }
+            continue;
+        }
+        
+        // A and B (like C and D) never share a strict sign; both new values
+        // are non-negative
+        BigNum na = B <= 0 ? combine(a, A, b, -B) : combine(b, B, a, -A);
+        BigNum nb = D <= 0 ? combine(a, C, b, -D) : combine(b, D, a, -C);
+        a = std::move(na);
+        b = std::move(nb);
+        if (sOut) {
+            BigNum ns = combineSigned(sa, A, sb, B);
+            sb = combineSigned(sa, C, sb, D);
+            sa = std::move(ns);
+        }
+        if (tOut) {
+            BigNum nt = combineSigned(ta, A, tb, B);
+            tb = combineSigned(ta, C, tb, D);
+            ta = std::move(nt);
+        }
     }
     
+    if (sOut) *sOut = std::move(sa);
+    if (tOut) *tOut = std::move(ta);
     return a;
 }
 
 BigNum BigNum::modInverse(const BigNum& modulus) const {
+    BIGNUM_STAT_SCOPE(ModInverse, modulus.digits.size());
+    if (!modulus.isNegative() && modulus > BigNum(1)) {
+        const auto& m = modulus.digits;
+        if (modulus.isOdd()) {
+            if (m.size() <= BINARY_INVERSE_LIMBS) return modInverseBinary(modulus);
+            // Only a's cofactor is needed: a s + m t = 1 gives a^-1 = s
+            BigNum a = *this % modulus;
+            if (a.isNegative()) a += modulus;
+            BigNum s;
+            if (!lehmerGcd(std::move(a), modulus, &s, nullptr).isOne()) {
+                throw std::invalid_argument("Modular inverse does not exist");
+            }
+            return s.isNegative() ? s + modulus : s;
+        }
+        if (mpn::normalizedSize(m.data(), m.size() - 1) == 0 && (m.back() & (m.back() - 1)) == 0) {
+            return modInversePowerOfTwo(modulus.bitLength() - 1);
+        }
+    }
+    
     auto result = extendedGcd(modulus);
     if (!result.first.isOne()) {
         throw std::invalid_argument("Modular inverse does not exist");
@@ -606,39 +1904,128 @@ BigNum BigNum::modInverse(const BigNum& modulus) const {
     return inv % modulus;
 }
 
+BigNum BigNum::modInverseBinary(const BigNum& modulus) const {
+    // Kaliski's almost inverse: a binary GCD on (m, a) that shifts out whole
+    // runs of zeros yields -a^-1 2^k mod m for some k in [bits, 2 bits], and
+    // word-sized Montgomery reduction steps then divide out 2^k. Everything
+    // runs in one buffer allocated up front.
+    const size_t n = modulus.digits.size();
+    const mpn::limb_t* mp = modulus.digits.data();
+    
+    BigNum reduced = *this % modulus;
+    if (reduced.isNegative()) reduced += modulus;
+    
+    // u, v < m take n limbs; the cofactors r, s < 2m take n + 1
+    LimbVector work(4 * n + 2, 0);
+    mpn::limb_t* u = work.data();
+    mpn::limb_t* v = u + n;
+    mpn::limb_t* r = v + n;
+    mpn::limb_t* s = r + n + 1;
+    mpn::copy(u, mp, n);
+    mpn::copy(v, reduced.digits.data(), reduced.digits.size());
+    s[0] = 1;
+    
+    // Invariant: u s + v r = m
+    size_t k = 0;
+    auto shiftOut = [&](mpn::limb_t* p, mpn::limb_t* x) {
+        const unsigned zeros = p[0] ? static_cast<unsigned>(std::min(mpn::ctz(p[0]), 63)) : 63;
+        mpn::rshift(p, p, n, zeros);
+        mpn::lshift(x, x, n + 1, zeros);
+        k += zeros;
+    };
+    while (mpn::normalizedSize(v, n) != 0) {
+        if (!(u[0] & 1)) {
+            shiftOut(u, s);
+        } else if (!(v[0] & 1)) {
+            shiftOut(v, r);
+        } else if (mpn::cmp(u, v, n) > 0) {
+            mpn::sub_n(u, u, v, n);
+            mpn::add_n(r, r, s, n + 1);
+            shiftOut(u, s);
+        } else {
+            mpn::sub_n(v, v, u, n);
+            mpn::add_n(s, s, r, n + 1);
+            if (mpn::normalizedSize(v, n) == 0) {
+                mpn::lshift(r, r, n + 1, 1);
+                ++k;
+            } else {
+                shiftOut(v, r);
+            }
+        }
+    }
+    if (u[0] != 1 || mpn::normalizedSize(u + 1, n - 1) != 0) {
+        throw std::invalid_argument("Modular inverse does not exist");
+    }
+    
+    // x = m - (r mod m) = a^-1 2^k mod m, kept in n + 1 limbs
+    auto reduceOnce = [&](mpn::limb_t* p) {
+        if (p[n] != 0 || mpn::cmp(p, mp, n) >= 0) mpn::sub(p, p, n + 1, mp, n);
+    };
+    mpn::limb_t* x = r;
+    reduceOnce(r);
+    mpn::sub_n(x, mp, r, n);
+    
+    const mpn::limb_t n0 = 0 - mpn::binvert_limb(mp[0]);
+    while (k > 0) {
+        // x <- (x + q m) / 2^j with q chosen to clear the low j bits
+        const unsigned j = static_cast<unsigned>(std::min<size_t>(k, mpn::LIMB_BITS));
+        mpn::limb_t q = x[0] * n0;
+        if (j < mpn::LIMB_BITS) q &= (mpn::limb_t(1) << j) - 1;
+        x[n] = mpn::addmul_1(x, mp, n, q);
+        if (j == mpn::LIMB_BITS) {
+            for (size_t i = 0; i < n; ++i) x[i] = x[i + 1];
+            x[n] = 0;
+        } else {
+            mpn::rshift(x, x, n + 1, j);
+        }
+        reduceOnce(x);
+        k -= j;
+    }
+    return BigNum(LimbVector(x, x + n), false);
+}
+
+BigNum BigNum::modInversePowerOfTwo(size_t k) const {
+    // Newton-Hensel lifting x <- x (2 - a x), doubling the correct low bits
+    // from the 64 that binvert_limb provides
+    if (isEven()) {
+        throw std::invalid_argument("Modular inverse does not exist");
+    }
+    BigNum a = *this;
+    if (a.negative) {
+        // -a mod 2^k as the two's complement of |a| in k bits
+        a.negative = false;
+        a = (BigNum(1) << static_cast<int>(k)) - (a & ((BigNum(1) << static_cast<int>(k)) - BigNum(1)));
+    }
+    
+    BigNum x(std::vector<uint64_t>{mpn::binvert_limb(a.digits[0])}, false);
+    for (size_t bits = 64; bits < k; bits *= 2) {
+        const size_t next = std::min(2 * bits, k);
+        const BigNum mask = (BigNum(1) << static_cast<int>(next)) - BigNum(1);
+        const BigNum ax = ((a & mask) * x) & mask;
+        // 2 - a x, taken modulo 2^next
+        const BigNum twoMinus = ((mask + BigNum(3)) - ax) & mask;
+        x = (x * twoMinus) & mask;
+    }
+    return x & ((BigNum(1) << static_cast<int>(k)) - BigNum(1));
+}
+
 std::pair<BigNum, std::pair<BigNum, BigNum>> BigNum::extendedGcd(const BigNum& other) const {
-    BigNum old_r = *this;
-    BigNum r = other;
-    BigNum old_s = BigNum(1LL);
-    BigNum s = BigNum(0LL);
-    BigNum old_t = BigNum(0LL);
-    BigNum t = BigNum(1LL);
+    BIGNUM_STAT_SCOPE(ExtendedGcd, std::min(digits.size(), other.digits.size()));
+    BigNum a = *this;
+    BigNum b = other;
     
     // Make sure we work with absolute values
-    if (old_r.isNegative()) old_r = -old_r;
-    if (r.isNegative()) r = -r;
+    if (a.isNegative()) a = -a;
+    if (b.isNegative()) b = -b;
     
-    while (!r.isZero()) {
-        BigNum quotient = old_r / r;
-        
-        BigNum temp_r = r;
-        r = old_r - quotient * r;
-        old_r = temp_r;
-        
-        BigNum temp_s = s;
-        s = old_s - quotient * s;
-        old_s = temp_s;
-        
-        BigNum temp_t = t;
-        t = old_t - quotient * t;
-        old_t = temp_t;
-    }
+    BigNum s, t;
+    BigNum g = lehmerGcd(std::move(a), std::move(b), &s, &t);
     
     // Adjust signs if the original inputs were negative
-    if (this->isNegative()) old_s = -old_s;
-    if (other.isNegative()) old_t = -old_t;
+    if (this->isNegative()) s = -s;
+    if (other.isNegative()) t = -t;
     
-    return {old_r, {old_s, old_t}};
+    return {g, {s, t}};
 }
 
 // Utility functions
@@ -681,44 +2068,272 @@ size_t BigNum::byteLength() const {
 }
 
 // Conversion functions
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+// Nibble value of each character, 0xff for anything that is not a hex digit
+struct HexDecodeTable {
+    uint8_t value[256];
+    constexpr HexDecodeTable() : value() {
+        for (int c = 0; c < 256; ++c) value[c] = 0xff;
+        for (int c = '0'; c <= '9'; ++c) value[c] = static_cast<uint8_t>(c - '0');
+        for (int c = 'a'; c <= 'f'; ++c) value[c] = static_cast<uint8_t>(c - 'a' + 10);
+        for (int c = 'A'; c <= 'F'; ++c) value[c] = static_cast<uint8_t>(c - 'A' + 10);
+    }
+};
+constexpr HexDecodeTable HEX_DECODE;
+
+// Limb bytes in the requested order, so a bswap on little-endian hosts and
+// nothing otherwise
+inline uint64_t limbToBigEndian(uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return __builtin_bswap64(v);
+#endif
+}
+
+inline uint64_t limbToLittleEndian(uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap64(v);
+#else
+    return v;
+#endif
+}
+
+}  // namespace
+
+size_t BigNum::hexLength() const {
+    if (isZero()) return 1;
+    const size_t top = 16 - mpn::clz(digits.back()) / 4;
+    return (negative ? 1 : 0) + (digits.size() - 1) * 16 + top;
+}
+
+size_t BigNum::toHexString(char* out, size_t capacity) const {
+    const size_t len = hexLength();
+    if (capacity < len) {
+        throw std::length_error("Buffer too small for hex string");
+    }
+    
+    // Fill from the least significant nibble backwards
+    char* p = out + len;
+    for (size_t i = 0; i + 1 < digits.size(); ++i) {
+        uint64_t limb = digits[i];
+        for (int j = 0; j < 16; ++j) {
+            *--p = HEX_DIGITS[limb & 15];
+            limb >>= 4;
+        }
+    }
+    uint64_t limb = digits.back();
+    do {
+        *--p = HEX_DIGITS[limb & 15];
+        limb >>= 4;
+    } while (limb);
+    if (negative) *--p = '-';
+    return len;
+}
+
 std::string BigNum::toHexString() const {
-    if (isZero()) return "0";
+    std::string result(hexLength(), '\0');
+    toHexString(&result[0], result.size());
+    return result;
+}
+
+namespace {
+
+constexpr uint64_t DECIMAL_CHUNK = 10000000000000000000ULL;  // 10^19
+constexpr size_t DECIMAL_CHUNK_DIGITS = 19;
+
+// floor(2^(2k) / m) for m of bit length k, by Newton iteration from the
+// reciprocal of the top half of m so the cost is a few multiplications
+BigNum reciprocal(const BigNum& m) {
+    const size_t k = m.bitLength();
+    const BigNum one(1);
+    if (k <= 4096) {
+        return (one << static_cast<int>(2 * k)) / m;
+    }
     
-    std::stringstream ss;
-    if (negative) ss << "-";
+    // The truncated reciprocal is good to about h bits, one Newton step
+    // doubles that past k, and the guard bits absorb the truncation errors
+    const size_t h = k / 2 + 32;
+    BigNum y = reciprocal(m >> static_cast<int>(k - h)) << static_cast<int>(k - h);
+    const BigNum scale = one << static_cast<int>(2 * k);
+    BigNum e = scale;
+    e.subMul(m, y);
+    BigNum step = (y * (e.isNegative() ? -e : e)) >> static_cast<int>(2 * k);
+    y = e.isNegative() ? y - step : y + step;
     
-    ss << std::hex;
-    bool first = true;
-    for (int i = digits.size() - 1; i >= 0; --i) {
-        if (first) {
-            ss << digits[i];
-            first = false;
-        } else {
-            ss << std::setfill('0') << std::setw(16) << digits[i];
-        }
+    BigNum r = scale;
+    r.subMul(m, y);
+    while (r.isNegative()) {
+        y -= one;
+        r += m;
     }
+    while (r >= m) {
+        y += one;
+        r -= m;
+    }
+    return y;
+}
+
+// 10^(19 * 2^level) together with its Barrett reciprocal, which only the
+// printing direction needs and is therefore built on first use
+struct DecimalPower {
+    BigNum power;
+    size_t digits;
+    size_t bits;
+    mutable BigNum mu;
+    mutable std::once_flag muOnce;
     
-    return ss.str();
+    DecimalPower(BigNum p, size_t d) : power(std::move(p)), digits(d), bits(power.bitLength()) {}
+};
+
+// Powers are computed once per process and kept; the largest one is about
+// half the size of the largest number converted so far
+const DecimalPower& decimalPower(size_t level) {
+    static std::mutex mutex;
+    static std::deque<DecimalPower> powers;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (powers.empty()) {
+        powers.emplace_back(BigNum(std::vector<uint64_t>{DECIMAL_CHUNK}), DECIMAL_CHUNK_DIGITS);
+    }
+    while (powers.size() <= level) {
+        const DecimalPower& last = powers.back();
+        powers.emplace_back(last.power.square(), 2 * last.digits);
+    }
+    // deque growth never moves existing elements, so the reference stays valid
+    return powers[level];
 }
 
-std::vector<uint8_t> BigNum::toByteArray() const {
-    size_t byteLen = byteLength();
-    std::vector<uint8_t> result(byteLen);
+// {x / p, x % p} for 0 <= x < p^2 using the cached reciprocal
+std::pair<BigNum, BigNum> divideByPower(const BigNum& x, const DecimalPower& p) {
+    std::call_once(p.muOnce, [&p]() { p.mu = reciprocal(p.power); });
+    const int k = static_cast<int>(p.bits);
+    BigNum q = ((x >> (k - 1)) * p.mu) >> (k + 1);
+    BigNum r = x;
+    r.subMul(q, p.power);
+    const BigNum one(1);
+    while (r.isNegative()) {
+        q -= one;
+        r += p.power;
+    }
+    while (r >= p.power) {
+        q += one;
+        r -= p.power;
+    }
+    return {std::move(q), std::move(r)};
+}
+
+}  // namespace
+
+std::string BigNum::toDecimalString() const {
+    BIGNUM_STAT_SCOPE(ToDecimal, digits.size());
+    if (isZero()) return "0";
     
-    for (size_t i = 0; i < byteLen; ++i) {
-        size_t digitIndex = i / 8;
-        size_t byteIndex = i % 8;
-        
-        if (digitIndex < digits.size()) {
-            result[byteLen - 1 - i] = static_cast<uint8_t>(
-                (digits[digitIndex] >> (byteIndex * 8)) & 0xFF
-            );
+    std::string out;
+    // log10(2) < 0.30103, plus room for the sign
+    out.reserve(static_cast<size_t>(bitLength() * 0.30103) + 2);
+    if (negative) out.push_back('-');
+    
+    BigNum magnitude = *this;
+    magnitude.negative = false;
+    if (digits.size() < tuning().decimal_threshold) {
+        magnitude.appendDecimalBasecase(out, 0);
+        return out;
+    }
+    
+    // Smallest level whose square exceeds the value, so the first split
+    // leaves both halves below the level's power
+    size_t level = 0;
+    while (!(magnitude < decimalPower(level + 1).power)) ++level;
+    magnitude.appendDecimalRecursive(out, level, 0);
+    return out;
+}
+
+void BigNum::appendDecimalBasecase(std::string& out, size_t width) const {
+    // Every limb yields at most 20 digits, and every division by 10^19 at
+    // least 63 bits, so this many chunks always fits
+    const size_t capacity = (digits.size() + 1) * 20;
+    char* buf = static_cast<char*>(::operator new(capacity));
+    size_t pos = capacity;
+    
+    LimbVector t(digits);
+    size_t n = mpn::normalizedSize(t.data(), t.size());
+    while (n > 0) {
+        uint64_t chunk = mpn::divrem_1(t.data(), t.data(), n, DECIMAL_CHUNK);
+        n = mpn::normalizedSize(t.data(), n);
+        for (size_t i = 0; i < DECIMAL_CHUNK_DIGITS; ++i) {
+            buf[--pos] = static_cast<char>('0' + chunk % 10);
+            chunk /= 10;
         }
     }
+    while (pos < capacity && buf[pos] == '0') ++pos;
     
+    const size_t len = capacity - pos;
+    if (width > len) {
+        out.append(width - len, '0');
+    } else if (width == 0 && len == 0) {
+        out.push_back('0');
+    }
+    out.append(buf + pos, len);
+    ::operator delete(buf);
+}
+
+void BigNum::appendDecimalRecursive(std::string& out, size_t level, size_t width) const {
+    if (level == 0 || digits.size() < tuning().decimal_threshold) {
+        appendDecimalBasecase(out, width);
+        return;
+    }
+    
+    // Callers guarantee *this < power(level + 1) = power(level)^2
+    const DecimalPower& p = decimalPower(level);
+    if (*this < p.power) {
+        appendDecimalRecursive(out, level - 1, width);
+        return;
+    }
+    auto qr = divideByPower(*this, p);
+    qr.first.appendDecimalRecursive(out, level - 1, width > p.digits ? width - p.digits : 0);
+    qr.second.appendDecimalRecursive(out, level - 1, p.digits);
+}
+
+std::vector<uint8_t> BigNum::toByteArray() const {
+    std::vector<uint8_t> result(byteLength());
+    toBytes(result.data(), result.size(), ByteOrder::BigEndian);
     return result;
 }
 
+void BigNum::toBytes(uint8_t* out, size_t len, ByteOrder order) const {
+    if (len < byteLength()) {
+        throw std::length_error("Buffer too small for BigNum bytes");
+    }
+    if (len == 0) return;
+    
+    // Whole limbs go out as one bswap-and-store each; only the top limb
+    // can be cut short by `len`
+    const size_t full = std::min(digits.size(), len / 8);
+    const size_t tail = std::min(len - full * 8, full < digits.size() ? size_t(8) : size_t(0));
+    if (order == ByteOrder::BigEndian) {
+        for (size_t i = 0; i < full; ++i) {
+            uint64_t v = limbToBigEndian(digits[i]);
+            std::memcpy(out + len - 8 * (i + 1), &v, 8);
+        }
+        uint64_t v = tail ? limbToBigEndian(digits[full]) : 0;
+        const size_t used = full * 8 + tail;
+        std::memcpy(out + len - used, reinterpret_cast<const uint8_t*>(&v) + 8 - tail, tail);
+        std::memset(out, 0, len - used);
+    } else {
+        for (size_t i = 0; i < full; ++i) {
+            uint64_t v = limbToLittleEndian(digits[i]);
+            std::memcpy(out + 8 * i, &v, 8);
+        }
+        uint64_t v = tail ? limbToLittleEndian(digits[full]) : 0;
+        const size_t used = full * 8 + tail;
+        std::memcpy(out + full * 8, &v, tail);
+        std::memset(out + used, 0, len - used);
+    }
+}
+
 int64_t BigNum::toInt64() const {
     // Check if the number is too large to fit in any 64-bit integer
     if (digits.size() > 1) {
@@ -751,66 +2366,141 @@ int64_t BigNum::toInt64() const {
 
 // Factory methods
 BigNum BigNum::fromByteArray(const std::vector<uint8_t>& bytes) {
-    if (bytes.empty()) return BigNum::zero();
-    
-    // Calculate number of 64-bit digits needed
-    size_t numDigits = (bytes.size() + 7) / 8;
-    std::vector<uint64_t> digits(numDigits, 0);
+    return fromBytes(bytes.data(), bytes.size(), ByteOrder::BigEndian);
+}
+
+BigNum BigNum::fromBytes(const uint8_t* data, size_t len, ByteOrder order) {
+    if (len == 0) return BigNum::zero();
     
-    // Fill digits from big-endian byte array
-    for (size_t i = 0; i < bytes.size(); ++i) {
-        size_t digitIndex = (bytes.size() - 1 - i) / 8;
-        size_t byteIndex = (bytes.size() - 1 - i) % 8;
-        
-        digits[digitIndex] |= static_cast<uint64_t>(bytes[i]) << (byteIndex * 8);
+    const size_t full = len / 8;
+    const size_t tail = len % 8;
+    LimbVector limbs(full + (tail ? 1 : 0));
+    if (order == ByteOrder::BigEndian) {
+        for (size_t i = 0; i < full; ++i) {
+            uint64_t v;
+            std::memcpy(&v, data + len - 8 * (i + 1), 8);
+            limbs[i] = limbToBigEndian(v);
+        }
+        if (tail) {
+            uint64_t v = 0;
+            std::memcpy(reinterpret_cast<uint8_t*>(&v) + 8 - tail, data, tail);
+            limbs[full] = limbToBigEndian(v);
+        }
+    } else {
+        for (size_t i = 0; i < full; ++i) {
+            uint64_t v;
+            std::memcpy(&v, data + 8 * i, 8);
+            limbs[i] = limbToLittleEndian(v);
+        }
+        if (tail) {
+            uint64_t v = 0;
+            std::memcpy(&v, data + full * 8, tail);
+            limbs[full] = limbToLittleEndian(v);
+        }
     }
     
-    return BigNum(digits, false);
+    return BigNum(std::move(limbs), false);
 }
 
-BigNum BigNum::fromHexString(const std::string& hexStr) {
-    if (hexStr.empty()) return BigNum(0LL);
-    
-    std::string str = hexStr;
+BigNum BigNum::fromHexString(std::string_view hexStr) {
     bool neg = false;
-    
-    if (str[0] == '-') {
+    if (!hexStr.empty() && hexStr[0] == '-') {
         neg = true;
-        str = str.substr(1);
+        hexStr.remove_prefix(1);
     }
     
     // Remove 0x prefix if present
-    if (str.length() >= 2 && str.substr(0, 2) == "0x") {
-        str = str.substr(2);
+    if (hexStr.size() >= 2 && hexStr[0] == '0' && hexStr[1] == 'x') {
+        hexStr.remove_prefix(2);
     }
     
-    if (str.empty()) return BigNum(0LL);
-    
-    std::vector<uint64_t> result;
+    if (hexStr.empty()) return BigNum(0LL);
     
-    // Process hex string in chunks of 16 characters (64 bits)
-    for (int i = str.length(); i > 0; i -= 16) {
-        int start = std::max(0, i - 16);
-        std::string chunk = str.substr(start, i - start);
-        
+    // Decode 16 characters (64 bits) per limb from the least significant
+    // end; invalid characters decode to 0xff and are caught once per limb
+    const unsigned char* str = reinterpret_cast<const unsigned char*>(hexStr.data());
+    size_t end = hexStr.size();
+    LimbVector result((end + 15) / 16);
+    for (size_t limb = 0; end > 0; ++limb) {
+        const size_t start = end >= 16 ? end - 16 : 0;
         uint64_t value = 0;
-        for (char c : chunk) {
-            value <<= 4;
-            if (c >= '0' && c <= '9') {
-                value |= c - '0';
-            } else if (c >= 'a' && c <= 'f') {
-                value |= c - 'a' + 10;
-            } else if (c >= 'A' && c <= 'F') {
-                value |= c - 'A' + 10;
-            } else {
-                throw std::invalid_argument("Invalid hex character");
-            }
+        uint8_t invalid = 0;
+        for (size_t i = start; i < end; ++i) {
+            const uint8_t nibble = HEX_DECODE.value[str[i]];
+            invalid |= nibble;
+            value = (value << 4) | (nibble & 15);
         }
-        
-        result.push_back(value);
+        if (invalid & 0xf0) {
+            throw std::invalid_argument("Invalid hex character");
+        }
+        result[limb] = value;
+        end = start;
     }
     
-    return BigNum(result, neg);
+    return BigNum(std::move(result), neg);
+}
+
+BigNum BigNum::fromDecimalString(std::string_view decStr) {
+    BIGNUM_STAT_SCOPE(FromDecimal, decStr.size() / 19 + 1);
+    size_t start = 0;
+    bool neg = false;
+    if (!decStr.empty() && decStr[0] == '-') {
+        neg = true;
+        start = 1;
+    }
+    if (start == decStr.size()) return BigNum(0LL);
+    
+    const char* str = decStr.data() + start;
+    const size_t len = decStr.size() - start;
+    for (size_t i = 0; i < len; ++i) {
+        if (str[i] < '0' || str[i] > '9') {
+            throw std::invalid_argument("Invalid decimal character");
+        }
+    }
+    
+    BigNum result = fromDecimalRecursive(str, len);
+    result.negative = neg && !result.isZero();
+    return result;
+}
+
+BigNum BigNum::fromDecimalBasecase(const char* str, size_t len) {
+    LimbVector limbs(len / DECIMAL_CHUNK_DIGITS + 1, 0);
+    size_t n = 0;
+    
+    // The leading chunk takes the odd digits so the rest are whole
+    size_t chunkLen = len % DECIMAL_CHUNK_DIGITS;
+    if (chunkLen == 0) chunkLen = DECIMAL_CHUNK_DIGITS;
+    for (size_t i = 0; i < len; i += chunkLen, chunkLen = DECIMAL_CHUNK_DIGITS) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < chunkLen; ++j) {
+            carry = carry * 10 + static_cast<uint64_t>(str[i + j] - '0');
+        }
+        // limbs = limbs * 10^19 + chunk
+        for (size_t j = 0; j < n; ++j) {
+            mpn::dlimb_t p = static_cast<mpn::dlimb_t>(limbs[j]) * DECIMAL_CHUNK + carry;
+            limbs[j] = static_cast<uint64_t>(p);
+            carry = static_cast<uint64_t>(p >> 64);
+        }
+        if (carry) limbs[n++] = carry;
+    }
+    
+    return BigNum(std::move(limbs), false);
+}
+
+BigNum BigNum::fromDecimalRecursive(const char* str, size_t len) {
+    // Compared in chunks: threshold * DECIMAL_CHUNK_DIGITS could overflow
+    if (len / DECIMAL_CHUNK_DIGITS < tuning().decimal_threshold) {
+        return fromDecimalBasecase(str, len);
+    }
+    
+    // Split off the largest power of ten shorter than the input as the low
+    // part: value = high * 10^digits + low
+    size_t level = 0;
+    while (decimalPower(level + 1).digits < len) ++level;
+    const DecimalPower& p = decimalPower(level);
+    BigNum high = fromDecimalRecursive(str, len - p.digits);
+    BigNum low = fromDecimalRecursive(str + len - p.digits, p.digits);
+    return high * p.power + low;
 }
 
 BigNum BigNum::zero() {
@@ -826,49 +2516,277 @@ BigNum BigNum::two() {
 }
 
 // Prime testing (Miller-Rabin)
-bool BigNum::isProbablePrime(int rounds) const {
-    if (*this <= BigNum(1LL)) return false;
-    if (*this == BigNum(2LL)) return true;
-    if (isEven()) return false;
+namespace {
+
+// Odd primes below 2^16, grouped so each group's product fits in a limb;
+// one mod_1 pass per group then yields the residues of all its primes
+struct SmallPrimes {
+    std::vector<uint32_t> primes;
+    struct Group { uint64_t product; size_t first, count; };
+    std::vector<Group> groups;
+    
+    SmallPrimes() {
+        const uint32_t limit = 1 << 16;
+        std::vector<bool> composite(limit, false);
+        for (uint32_t p = 3; p < limit; p += 2) {
+            if (composite[p]) continue;
+            primes.push_back(p);
+            for (uint64_t q = uint64_t(p) * p; q < limit; q += 2 * p) composite[q] = true;
+        }
+        for (size_t i = 0; i < primes.size();) {
+            Group g{1, i, 0};
+            while (i < primes.size() && g.product <= UINT64_MAX / primes[i]) {
+                g.product *= primes[i++];
+                ++g.count;
+            }
+            groups.push_back(g);
+        }
+    }
     
-    // Write n-1 as d * 2^r
-    BigNum n_minus_1 = *this - BigNum(1LL);
-    BigNum d = n_minus_1;
-    int r = 0;
+    // residues[i] = x mod primes[i] for the first `count` primes
+    void residues(const BigNum& x, size_t count, std::vector<uint32_t>& out) const {
+        const auto& d = x.getDigits();
+        out.resize(count);
+        for (const Group& g : groups) {
+            if (g.first >= count) break;
+            const uint64_t r = mpn::mod_1(d.data(), d.size(), g.product);
+            for (size_t i = g.first; i < g.first + g.count && i < count; ++i) {
+                out[i] = static_cast<uint32_t>(r % primes[i]);
+            }
+        }
+    }
+};
+
+const SmallPrimes& smallPrimes() {
+    static const SmallPrimes table;
+    return table;
+}
+
+// Primes used to trial-divide an arbitrary input before Miller-Rabin
+constexpr size_t TRIAL_PRIMES = 256;
+
+// 1 if n (odd, > 2) is prime, 0 if a small prime divides it, -1 if trial
+// division cannot decide
+int trialDivision(const BigNum& n) {
+    const SmallPrimes& sp = smallPrimes();
+    thread_local std::vector<uint32_t> res;
+    sp.residues(n, TRIAL_PRIMES, res);
+    const auto& d = n.getDigits();
+    const bool small = d.size() == 1;
+    for (size_t i = 0; i < TRIAL_PRIMES; ++i) {
+        if (res[i] == 0) return small && d[0] == sp.primes[i] ? 1 : 0;
+    }
+    // No factor up to the last trial prime decides anything below its square
+    const uint64_t bound = sp.primes[TRIAL_PRIMES - 1];
+    return small && d[0] < bound * bound ? 1 : -1;
+}
+
+// Strong probable-prime test to random or fixed bases for one odd n > 3,
+// sharing the n - 1 = d * 2^r split and a Montgomery context across bases
+class MillerRabin {
+public:
+    explicit MillerRabin(const BigNum& n) : n(n), n_minus_1(n - BigNum(1)), d(n_minus_1) {
+        while (d.isEven()) {
+            d >>= 1;
+            r++;
+        }
+        if (n.getDigits().size() >= BigNum::tuning().montgomery_threshold) {
+            ctx = std::make_unique<MontgomeryContext>(n);
+        }
+    }
     
-    while (d.isEven()) {
-        d >>= 1;
-        r++;
+    // Returns false early, with no meaning, once *cancel becomes true
+    bool passes(const BigNum& a, const std::atomic<bool>* cancel) const {
+        BigNum x = ctx ? a.modPow(d, *ctx) : a.modPow(d, n);
+        if (x.isOne() || x == n_minus_1) return true;
+        for (int j = 0; j < r - 1; ++j) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) return false;
+            BigNum::CancelScope::checkpoint();
+            x = x.square() % n;
+            if (x == n_minus_1) return true;
+        }
+        return false;
+    }
+    
+    // `rounds` witnesses drawn uniformly from [2, 2^(bits - 1)), which lies
+    // inside [2, n - 2], from one generator seeded once per call
+    bool passesRandom(int rounds, const std::atomic<bool>* cancel) const {
+        std::random_device rd;
+        std::mt19937_64 gen((static_cast<uint64_t>(rd()) << 32) ^ rd());
+        const size_t bits = n.bitLength() - 1;
+        std::vector<uint64_t> limbs((bits + 63) / 64);
+        for (int i = 0; i < rounds; ++i) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) return false;
+            for (uint64_t& limb : limbs) limb = gen();
+            if (bits % 64) limbs.back() &= (uint64_t(1) << (bits % 64)) - 1;
+            BigNum a(limbs, false);
+            if (a <= BigNum(1)) a = BigNum(2);
+            if (!passes(a, cancel)) return false;
+        }
+        return true;
     }
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    const MontgomeryContext* context() const { return ctx.get(); }
     
-    for (int i = 0; i < rounds; ++i) {
-        BigNum a = BigNum::random(bitLength() - 1);
-        if (a <= BigNum(1LL) || a >= *this - BigNum(1LL)) {
-            continue;
-        }
-        
-        BigNum x = a.modPow(d, *this);
-        
-        if (x == BigNum(1LL) || x == n_minus_1) {
-            continue;
+private:
+    const BigNum& n;
+    BigNum n_minus_1;
+    BigNum d;
+    int r = 0;
+    std::unique_ptr<MontgomeryContext> ctx;
+};
+
+// Jacobi symbol (a / m) for odd m > 0, on single words
+int jacobi(uint64_t a, uint64_t m) {
+    int j = 1;
+    a %= m;
+    while (a) {
+        while (!(a & 1)) {
+            a >>= 1;
+            if ((m & 7) == 3 || (m & 7) == 5) j = -j;
         }
-        
-        bool composite = true;
-        for (int j = 0; j < r - 1; ++j) {
-            x = x.modPow(BigNum(2LL), *this);
-            if (x == n_minus_1) {
-                composite = false;
-                break;
-            }
+        std::swap(a, m);
+        if ((a & 3) == 3 && (m & 3) == 3) j = -j;
+        a %= m;
+    }
+    return m == 1 ? j : 0;
+}
+
+// Jacobi symbol (D / n) for a small D and odd n > 0
+int jacobi(int64_t D, const BigNum& n) {
+    const auto& nd = n.getDigits();
+    const uint64_t n0 = nd[0];
+    uint64_t a = D < 0 ? -static_cast<uint64_t>(D) : static_cast<uint64_t>(D);
+    int j = 1;
+    if (D < 0 && (n0 & 3) == 3) j = -j;  // (-1 / n)
+    while (a && !(a & 1)) {
+        a >>= 1;
+        if ((n0 & 7) == 3 || (n0 & 7) == 5) j = -j;
+    }
+    if (a == 1) return j;
+    // Quadratic reciprocity flips (a / n) into (n mod a / a)
+    if ((a & 3) == 3 && (n0 & 3) == 3) j = -j;
+    return j * jacobi(mpn::mod_1(nd.data(), nd.size(), a), a);
+}
+
+bool isPerfectSquare(const BigNum& n) {
+    // Newton's iteration from above converges on floor(sqrt(n))
+    BigNum x = BigNum(1) << static_cast<int>((n.bitLength() + 1) / 2);
+    for (;;) {
+        BigNum y = (x + n / x) >> 1;
+        if (y >= x) break;
+        x = std::move(y);
+    }
+    return x * x == n;
+}
+
+// Strong Lucas probable-prime test with Selfridge's method A parameters
+// (P = 1, Q = (1 - D) / 4), for odd n > 3 that passed trial division. The
+// sequences are kept in Montgomery form; halving mod n commutes with it.
+bool strongLucas(const BigNum& n, const MontgomeryContext& mont, const std::atomic<bool>* cancel) {
+    int64_t D = 5;
+    for (int tries = 0;; ++tries) {
+        const int j = jacobi(D, n);
+        if (j == -1) break;
+        if (j == 0) return false;  // |D| < n is a proper factor after trial division
+        if (tries == 8 && isPerfectSquare(n)) return false;
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+    
+    auto modN = [&n](int64_t v) {
+        BigNum x = BigNum(v) % n;
+        return x.isNegative() ? x + n : x;
+    };
+    auto add = [&n](const BigNum& a, const BigNum& b) {
+        BigNum s = a + b;
+        return s >= n ? s - n : s;
+    };
+    auto sub = [&n](const BigNum& a, const BigNum& b) {
+        BigNum s = a - b;
+        return s.isNegative() ? s + n : s;
+    };
+    auto half = [&n](const BigNum& a) { return (a.isOdd() ? a + n : a) >> 1; };
+    
+    const BigNum q = mont.toMontgomery(modN((1 - D) / 4));
+    const BigNum dm = mont.toMontgomery(modN(D));
+    const BigNum one = mont.toMontgomery(BigNum(1));  // P = 1
+    
+    // n + 1 = d * 2^s
+    BigNum d = n + BigNum(1);
+    int s = 0;
+    while (d.isEven()) {
+        d >>= 1;
+        s++;
+    }
+    
+    // Left-to-right over d: (U_k, V_k, Q^k) -> (U_2k, V_2k, Q^2k), then
+    // -> (U_2k+1, V_2k+1, Q^2k+1) on a set bit
+    BigNum u = one, v = one, qk = q;
+    for (size_t i = d.bitLength() - 1; i-- > 0;) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) return false;
+        BigNum::CancelScope::checkpoint();
+        u = mont.multiply(u, v);
+        v = sub(mont.square(v), add(qk, qk));
+        qk = mont.square(qk);
+        if ((d.getDigits()[i / 64] >> (i % 64)) & 1) {
+            BigNum nu = half(add(u, v));
+            v = half(add(mont.multiply(dm, u), v));
+            u = std::move(nu);
+            qk = mont.multiply(qk, q);
         }
-        
-        if (composite) return false;
     }
+    if (u.isZero() || v.isZero()) return true;
+    for (int r = 1; r < s; ++r) {
+        v = sub(mont.square(v), add(qk, qk));
+        if (v.isZero()) return true;
+        qk = mont.square(qk);
+    }
+    return false;
+}
+
+// Everything after trial division for an odd n that it could not decide
+bool bailliePSW(const BigNum& n, const std::atomic<bool>* cancel) {
+    MillerRabin mr(n);
+    if (!mr.passes(BigNum(2), cancel)) return false;
+    if (mr.context()) return strongLucas(n, *mr.context(), cancel);
+    MontgomeryContext mont(n);
+    return strongLucas(n, mont, cancel);
+}
+
+}  // namespace
+
+bool BigNum::isProbablePrime(int rounds, Execution mode) const {
+    BIGNUM_STAT_SCOPE(PrimalityTest, digits.size());
+    if (*this <= BigNum(1LL)) return false;
+    if (*this == BigNum(2LL)) return true;
+    if (isEven()) return false;
     
-    return true;
+    const int trial = trialDivision(*this);
+    if (trial >= 0) return trial == 1;
+    
+    MillerRabin mr(*this);
+    auto pool = bignum::ThreadPool::shared();
+    if (mode == Execution::Sequential || rounds <= 1 || pool->concurrency() == 1) {
+        return mr.passesRandom(rounds, nullptr);
+    }
+    
+    // One witness per item; the first composite verdict cancels the rest
+    std::atomic<bool> composite{false};
+    pool->parallelFor(static_cast<size_t>(rounds), [&](size_t) {
+        if (!mr.passesRandom(1, &composite)) composite.store(true);
+    }, &composite);
+    return !composite.load();
+}
+
+bool BigNum::isBailliePSWPrime() const {
+    BIGNUM_STAT_SCOPE(PrimalityTest, digits.size());
+    if (*this <= BigNum(1LL)) return false;
+    if (*this == BigNum(2LL)) return true;
+    if (isEven()) return false;
+    
+    const int trial = trialDivision(*this);
+    if (trial >= 0) return trial == 1;
+    return bailliePSW(*this, nullptr);
 }
 
 BigNum BigNum::random(size_t bitLength) {
@@ -879,7 +2797,7 @@ BigNum BigNum::random(size_t bitLength) {
     std::uniform_int_distribution<uint64_t> dis(0, 0xFFFFFFFFFFFFFFFFULL);
     
     size_t numDigits = (bitLength + 63) / 64;
-    std::vector<uint64_t> result(numDigits);
+    LimbVector result(numDigits);
     
     for (size_t i = 0; i < numDigits; ++i) {
         result[i] = dis(gen);
@@ -897,10 +2815,107 @@ BigNum BigNum::random(size_t bitLength) {
         result.back() |= (1ULL << (topBits - 1));  // Set MSB
     }
     
-    return BigNum(result, false);
+    return BigNum(std::move(result), false);
+}
+
+namespace {
+
+// Incremental sieve over start, start + 2, ..., start + 2 * (WINDOW - 1)
+// for a random odd start, or for consecutive windows from a given odd start.
+// The start's residues modulo the sieving primes are computed once per
+// window; each prime then strikes out its multiples with word arithmetic,
+// and only the survivors reach the expensive test.
+class CandidateSieve {
+public:
+    explicit CandidateSieve(size_t bits) : bits(bits), window(std::max<size_t>(64, 4 * bits)) {
+        choosePrimes(bits);
+        composite.resize(window);
+        refill();
+    }
+    
+    // Every odd number from `first` (odd, at least 3) upward, in order
+    static CandidateSieve from(const BigNum& first) {
+        return CandidateSieve(first);
+    }
+    
+    // Next survivor; with a random start, one with exactly `bits` bits,
+    // drawing a fresh start once a window is used up
+    BigNum next() {
+        for (;;) {
+            while (index < window) {
+                const size_t i = index++;
+                if (composite[i]) continue;
+                BigNum candidate = start + BigNum(static_cast<int64_t>(2 * i));
+                if (sequential || candidate.bitLength() == bits) return candidate;
+                index = window;  // every later candidate is longer still
+            }
+            refill();
+        }
+    }
+    
+private:
+    explicit CandidateSieve(const BigNum& first)
+        : bits(0), window(std::max<size_t>(64, 4 * first.bitLength())), sequential(true), start(first) {
+        choosePrimes(first.bitLength());
+        composite.resize(window);
+        strike();
+    }
+    
+    void choosePrimes(size_t startBits) {
+        // More sieving primes pay off as the test gets dearer; none may be
+        // as large as a candidate, so a zero residue always means composite
+        const SmallPrimes& sp = smallPrimes();
+        const uint64_t smallest = uint64_t(1) << std::min<size_t>(startBits - 1, 63);
+        size_t count = std::min(sp.primes.size(), std::max<size_t>(64, 2 * startBits));
+        while (count > 0 && sp.primes[count - 1] >= smallest) --count;
+        primes = count;
+    }
+    
+    void refill() {
+        if (sequential) {
+            start += BigNum(static_cast<int64_t>(2 * window));
+        } else {
+            start = BigNum::random(bits) | BigNum(1);
+        }
+        strike();
+    }
+    
+    void strike() {
+        const SmallPrimes& sp = smallPrimes();
+        sp.residues(start, primes, residues);
+        std::fill(composite.begin(), composite.end(), 0);
+        for (size_t k = 0; k < primes; ++k) {
+            const uint64_t p = sp.primes[k];
+            // start + 2i == 0 (mod p)  <=>  i == -start / 2 (mod p)
+            uint64_t i = (p - residues[k]) % p * ((p + 1) / 2) % p;
+            for (; i < window; i += p) composite[i] = 1;
+        }
+        index = 0;
+    }
+    
+    size_t bits;
+    size_t window;
+    bool sequential = false;
+    size_t primes = 0;
+    BigNum start;
+    std::vector<uint32_t> residues;
+    std::vector<uint8_t> composite;
+    size_t index = 0;
+};
+
+// Sieve survivors (odd, at least 3) still need the full test; a set *cancel
+// abandons it
+bool survivorIsPrime(const BigNum& candidate, BigNum::PrimalityTest test, const std::atomic<bool>* cancel) {
+    const int trial = trialDivision(candidate);
+    if (trial >= 0) return trial == 1;
+    if (test == BigNum::PrimalityTest::BailliePSW) return bailliePSW(candidate, cancel);
+    return MillerRabin(candidate).passesRandom(20, cancel);
 }
 
-BigNum BigNum::randomPrime(size_t bitLength) {
+}  // namespace
+
+BigNum BigNum::randomPrime(size_t bitLength, Execution mode, PrimalityTest test) {
+    BIGNUM_STAT_SCOPE(RandomPrime, (bitLength + 63) / 64);
     if (bitLength < 2) {
         throw std::invalid_argument("Prime bit length must be at least 2");
     }
@@ -913,38 +2928,345 @@ BigNum BigNum::randomPrime(size_t bitLength) {
         return BigNum(5LL); // or 7
     }
     
-    BigNum candidate;
-    int maxAttempts = bitLength * 50; // Reasonable limit
+    auto isPrime = [test](const BigNum& candidate, const std::atomic<bool>* cancel) {
+        return survivorIsPrime(candidate, test, cancel);
+    };
     
-    for (int attempts = 0; attempts < maxAttempts; ++attempts) {
-        // Generate random number of specified bit length
-        candidate = BigNum::random(bitLength);
-        
-        // Ensure it's odd (required for primality)
-        if (candidate.isEven()) {
-            candidate += BigNum(1LL);
+    int maxAttempts = bitLength * 50; // Reasonable limit on tested survivors
+    auto pool = bignum::ThreadPool::shared();
+    
+    if (mode == Execution::Sequential || pool->concurrency() == 1) {
+        CandidateSieve sieve(bitLength);
+        for (int attempts = 0; attempts < maxAttempts; ++attempts) {
+            CancelScope::checkpoint();
+            BigNum candidate = sieve.next();
+            if (isPrime(candidate, nullptr)) {
+                return candidate;
+            }
         }
-        
-        // Ensure it has the exact bit length by setting MSB if needed
-        if (candidate.bitLength() < bitLength) {
-            // Add the high bit to ensure exact bit length
-            BigNum highBit = BigNum(1LL) << (bitLength - 1);
-            candidate = candidate | highBit;
+        throw std::runtime_error("Failed to generate prime after maximum attempts");
+    }
+    
+    // Every thread sieves from its own random starts and draws from a shared
+    // attempt budget; the first prime found cancels the searches still
+    // running
+    std::atomic<bool> found{false};
+    std::atomic<int> attempts{0};
+    std::mutex resultLock;
+    BigNum result;
+    pool->parallelFor(pool->concurrency(), [&](size_t) {
+        CandidateSieve sieve(bitLength);
+        while (!found.load() && attempts.fetch_add(1) < maxAttempts) {
+            CancelScope::checkpoint();
+            BigNum candidate = sieve.next();
+            if (isPrime(candidate, &found)) {
+                std::lock_guard<std::mutex> guard(resultLock);
+                if (!found.load()) {
+                    result = candidate;
+                    found.store(true);
+                }
+            }
         }
+    }, &found);
+    
+    if (!found.load()) {
+        throw std::runtime_error("Failed to generate prime after maximum attempts");
+    }
+    return result;
+}
+
+BigNum BigNum::nextPrime(PrimalityTest test) const {
+    if (*this < BigNum(2LL)) return BigNum(2LL);
+    if (*this == BigNum(2LL)) return BigNum(3LL);
+    CandidateSieve sieve = CandidateSieve::from(*this + BigNum(isEven() ? 1LL : 2LL));
+    for (;;) {
+        CancelScope::checkpoint();
+        BigNum candidate = sieve.next();
+        if (survivorIsPrime(candidate, test, nullptr)) return candidate;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Integer factorization
+//------------------------------------------------------------------------------
+
+namespace {
+
+using Element = ModArith::Element;
+
+// Pollard rho with Brent's cycle detection on an odd composite n, iterating
+// x -> x^2 + c in Montgomery form and taking one gcd per BATCH products of
+// differences. Returns a proper factor, or zero once `budget` iterations
+// have gone by without one.
+BigNum pollardBrent(const BigNum& n, std::mt19937_64& gen, size_t budget) {
+    constexpr size_t BATCH = 128;
+    const ModArith f(n);
+    Element y, x, ys, q, diff;
+    size_t used = 0;
+    while (used < budget) {
+        const Element c = f.element(BigNum(static_cast<int64_t>(gen() >> 2) + 1));
+        auto step = [&](Element& v) {
+            BigNum::CancelScope::checkpoint();
+            f.sqr(v, v);
+            f.add(v, v, c);
+        };
+        y = f.element(BigNum(static_cast<int64_t>(gen() >> 2)));
+        q = f.one();
+        BigNum g(1LL);
+        for (size_t r = 1; g.isOne() && used < budget; r *= 2) {
+            x = y;
+            for (size_t i = 0; i < r; ++i) step(y);
+            for (size_t k = 0; k < r && g.isOne(); k += BATCH) {
+                ys = y;
+                for (size_t i = 0; i < std::min(BATCH, r - k); ++i) {
+                    step(y);
+                    f.sub(diff, x, y);
+                    f.mul(q, q, diff);
+                }
+                g = f.toBigNum(q).gcd(n);
+            }
+            used += r;
+        }
+        if (g == n) {
+            // The batch overshot; replay it one gcd at a time
+            do {
+                step(ys);
+                f.sub(diff, x, ys);
+                g = f.toBigNum(diff).gcd(n);
+            } while (g.isOne());
+        }
+        if (!g.isOne() && g != n) return g;
+    }
+    return BigNum(0LL);
+}
+
+// Odd-only sieve of Eratosthenes: isPrime(k) for odd k <= limit
+class OddPrimes {
+public:
+    explicit OddPrimes(uint64_t limit) : limit(limit), composite(limit / 2 + 1, false) {
+        composite[0] = true;  // 1
+        for (uint64_t p = 3; p * p <= limit; p += 2) {
+            if (composite[p / 2]) continue;
+            for (uint64_t m = p * p; m <= limit; m += 2 * p) composite[m / 2] = true;
+        }
+    }
+    
+    bool isPrime(uint64_t k) const { return k == 2 || (k & 1 && k <= limit && !composite[k / 2]); }
+    uint64_t bound() const { return limit; }
+    
+private:
+    uint64_t limit;
+    std::vector<bool> composite;
+};
+
+// Lenstra's elliptic curve method on Montgomery curves B y^2 = x^3 + A x^2 + x
+// in x-only projective coordinates, with Suyama's parametrisation (so every
+// curve has a group order divisible by 12). Stage 1 multiplies a point by
+// every prime power up to B1; stage 2 is the standard continuation with
+// giant steps of W, covering one prime q in (B1, B2] per multiplication.
+class Ecm {
+public:
+    explicit Ecm(const BigNum& n) : n(n), f(n) {}
+    
+    // Runs one curve; returns a proper factor or zero
+    BigNum curve(uint64_t sigma, uint64_t b1, const OddPrimes& primes) {
+        // u = sigma^2 - 5, v = 4 sigma, x0 = u^3, z0 = v^3,
+        // a24 = (A + 2) / 4 = (v - u)^3 (3u + v) / (16 u^3 v)
+        const BigNum s(static_cast<int64_t>(sigma));
+        const BigNum u = (s * s - BigNum(5LL)) % n, v = (s << 2) % n;
+        const BigNum u3 = u.square() * u % n;
+        BigNum den = (u3 * v << 4) % n;
+        BigNum g = den.gcd(n);
+        if (!g.isOne()) return g == n ? BigNum(0LL) : g;
+        const BigNum vu = (v - u) % n;
+        a24 = f.element(vu.square() * vu % n * (u * BigNum(3LL) + v) % n * den.modInverse(n));
+        Point p{f.element(u3), f.element(v.square() * v)};
         
-        // Test for primality
-        if (candidate.isProbablePrime(20)) {
-            return candidate;
+        // Stage 1; the prime powers are packed into scalars of up to 64 bits
+        uint64_t k = 1;
+        for (uint64_t q = 2; q <= b1; q = q == 2 ? 3 : q + 2) {
+            if (!primes.isPrime(q)) continue;
+            uint64_t power = q;
+            while (power <= b1 / q) power *= q;
+            if (k > UINT64_MAX / power) {
+                multiply(p, p, k);
+                k = 1;
+            }
+            k *= power;
         }
+        multiply(p, p, k);
+        g = f.toBigNum(p.z).gcd(n);
+        if (!g.isOne()) return g == n ? BigNum(0LL) : g;
         
-        // Try the next odd number
-        candidate += BigNum(2LL);
-        if (candidate.isProbablePrime(20)) {
-            return candidate;
+        // Stage 2: for q = m W +- j, [q]P = O (mod p) means x([mW]P)
+        // and x([j]P) agree mod p, so one product of cross differences per
+        // such pair collects them all for a single gcd
+        const uint64_t b2 = primes.bound();
+        std::vector<Point> baby(W / 4);  // [j]P for odd j < W / 2
+        Point twice;
+        twice = p;
+        dbl(twice, p);
+        baby[0] = p;
+        if (baby.size() > 1) add(baby[1], twice, p, p);
+        for (size_t i = 2; i < baby.size(); ++i) add(baby[i], baby[i - 1], twice, baby[i - 2]);
+        
+        const uint64_t first = std::max<uint64_t>(2, b1 / W);
+        Point step, previous, giant;
+        multiply(step, p, W);
+        multiply(previous, p, (first - 1) * W);
+        multiply(giant, p, first * W);
+        Element acc = f.one(), t1, t2;
+        for (uint64_t m = first; (m - 1) * W <= b2; ++m) {
+            BigNum::CancelScope::checkpoint();
+            const uint64_t centre = m * W;
+            for (size_t i = 0; i < baby.size(); ++i) {
+                const uint64_t j = 2 * i + 1;
+                const bool hit = (centre + j > b1 && primes.isPrime(centre + j)) ||
+                                 (centre - j > b1 && primes.isPrime(centre - j));
+                if (!hit) continue;
+                f.mul(t1, giant.x, baby[i].z);
+                f.mul(t2, baby[i].x, giant.z);
+                f.sub(t1, t1, t2);
+                f.mul(acc, acc, t1);
+            }
+            Point next;
+            add(next, giant, step, previous);
+            previous = std::move(giant);
+            giant = std::move(next);
+        }
+        g = f.toBigNum(acc).gcd(n);
+        return g.isOne() || g == n ? BigNum(0LL) : g;
+    }
+    
+private:
+    static constexpr uint64_t W = 210;  // 2 * 3 * 5 * 7
+    
+    struct Point {
+        Element x, z;
+    };
+    
+    // r = [2] p; r may alias p
+    void dbl(Point& r, const Point& p) {
+        f.add(s, p.x, p.z);
+        f.sub(d, p.x, p.z);
+        f.sqr(s, s);
+        f.sqr(d, d);
+        f.sub(t, s, d);  // 4 x z
+        f.mul(r.x, s, d);
+        f.mul(s, a24, t);
+        f.add(s, s, d);
+        f.mul(r.z, t, s);
+    }
+    
+    // r = p + q given diff = p - q; r may alias p or q but not diff
+    void add(Point& r, const Point& p, const Point& q, const Point& diff) {
+        f.sub(s, p.x, p.z);
+        f.add(d, q.x, q.z);
+        f.mul(s, s, d);
+        f.add(t, p.x, p.z);
+        f.sub(d, q.x, q.z);
+        f.mul(t, t, d);
+        f.add(d, s, t);
+        f.sub(s, s, t);
+        f.sqr(d, d);
+        f.sqr(s, s);
+        f.mul(r.x, diff.z, d);
+        f.mul(r.z, diff.x, s);
+    }
+    
+    // r = [k] p for k >= 1 by the Montgomery ladder; r may alias p
+    void multiply(Point& r, const Point& p, uint64_t k) {
+        Point base = p, r0 = p, r1;
+        r1 = p;
+        dbl(r1, p);
+        for (int bit = 62 - mpn::clz(k); bit >= 0; --bit) {
+            BigNum::CancelScope::checkpoint();
+            if ((k >> bit) & 1) {
+                add(r0, r1, r0, base);
+                dbl(r1, r1);
+            } else {
+                add(r1, r1, r0, base);
+                dbl(r0, r0);
+            }
+        }
+        r = std::move(r0);
+    }
+    
+    const BigNum& n;
+    ModArith f;
+    Element a24, s, d, t;
+};
+
+// Proper factor of an odd composite n that is not a prime power of a small
+// prime: Pollard rho first for the small factors it finds cheaply, then ECM
+// with growing bounds (the B1 and curve counts that GMP-ECM recommends for
+// factors of 15 to 45 digits), each level once. Throws std::runtime_error
+// when every curve has run without finding a factor.
+BigNum findFactor(const BigNum& n) {
+    std::mt19937_64 gen(n.getDigits()[0]);
+    BigNum d = pollardBrent(n, gen, size_t(1) << 18);
+    if (!d.isZero()) return d;
+    
+    struct Level { uint64_t b1; unsigned curves; };
+    static constexpr Level levels[] = {
+        {2000, 25}, {11000, 90}, {50000, 300}, {250000, 700}, {1000000, 1800}, {3000000, 5100}};
+    Ecm ecm(n);
+    for (const Level& level : levels) {
+        const OddPrimes primes(50 * level.b1);
+        for (unsigned c = 0; c < level.curves; ++c) {
+            d = ecm.curve(6 + gen() % (uint64_t(1) << 32), level.b1, primes);
+            if (!d.isZero()) return d;
         }
     }
-    
-    throw std::runtime_error("Failed to generate prime after maximum attempts");
+    throw std::runtime_error("factor: no factor found within the ECM curve budget");
+}
+
+}  // namespace
+
+std::vector<BigNum> BigNum::factor() const {
+    BIGNUM_STAT_SCOPE(Factor, digits.size());
+    if (isZero()) {
+        throw std::invalid_argument("Cannot factor zero");
+    }
+    std::vector<BigNum> factors;
+    BigNum n = *this;
+    n.negative = false;
+    
+    while (n.isEven()) {
+        factors.push_back(BigNum(2LL));
+        n >>= 1;
+    }
+    
+    // Trial division by every odd prime below 2^16, one residue pass per
+    // group of primes; whatever is left below 2^32 is then prime
+    const SmallPrimes& sp = smallPrimes();
+    std::vector<uint32_t> residues;
+    sp.residues(n, sp.primes.size(), residues);
+    for (size_t i = 0; i < sp.primes.size() && !n.isOne(); ++i) {
+        if (residues[i] != 0) continue;
+        const BigNum p(static_cast<int64_t>(sp.primes[i]));
+        do {
+            factors.push_back(p);
+            n /= p;
+        } while ((n % p).isZero());
+    }
+    const uint64_t bound = uint64_t(1) << 32;
+    
+    std::vector<BigNum> pending;
+    if (!n.isOne()) pending.push_back(std::move(n));
+    while (!pending.empty()) {
+        BigNum m = std::move(pending.back());
+        pending.pop_back();
+        if ((m.digits.size() == 1 && m.digits[0] < bound) || m.isBailliePSWPrime()) {
+            factors.push_back(std::move(m));
+            continue;
+        }
+        BigNum d = findFactor(m);
+        pending.push_back(m / d);
+        pending.push_back(std::move(d));
+    }
+    std::sort(factors.begin(), factors.end());
+    return factors;
 }
 
 // Stream operations
@@ -964,92 +3286,98 @@ std::istream& operator>>(std::istream& is, BigNum& num) {
 // MontgomeryContext implementation (at global/file scope)
 //------------------------------------------------------------------------------
 
+namespace {
+
+// Per-thread scratch for the MontgomeryContext kernels, grown on demand and
+// then reused, so the const methods stay safe to call concurrently on one
+// shared context. Kept apart from fieldScratch so neither can move the
+// other's buffer.
+mpn::limb_t* contextScratch(size_t n) {
+    thread_local LimbVector scratch;
+    if (scratch.size() < n) scratch.resize(n);
+    return scratch.data();
+}
+
+}  // namespace
+
 MontgomeryContext::MontgomeryContext(const BigNum& mod) : modulus(mod) {
+    BIGNUM_STAT_SCOPE(MontgomeryContext, mod.getDigits().size());
     if (mod.isZero() || mod.isEven()) {
         throw std::invalid_argument("Montgomery form requires odd modulus");
     }
+    if (mod.isNegative()) {
+        modulus = -mod;
+    }
     
-    k = mod.getDigits().size();
+    k = modulus.getDigits().size();
+    const mpn::limb_t* np = modulus.getDigits().data();
     
     // R = 2^(k*64)
     r = BigNum(1LL) << (k * 64);
     
-    // Compute R^(-1) mod modulus using extended GCD
-    auto gcd_result = r.extendedGcd(modulus);
-    if (!gcd_result.first.isOne()) {
-        throw std::invalid_argument("gcd(R, modulus) != 1");
-    }
-    r_inv = gcd_result.second.first;
-    if (r_inv.isNegative()) {
-        r_inv += modulus;
-    }
+    // n0 = -modulus^(-1) mod 2^64, lifted from the low limb alone
+    n0 = 0 - mpn::binvert_limb(np[0]);
     
-    // Compute n' = -modulus^(-1) mod R
-    auto mod_inv_result = modulus.extendedGcd(r);
-    if (!mod_inv_result.first.isOne()) {
-        throw std::invalid_argument("Modulus not invertible mod R");
-    }
-    n_prime = -mod_inv_result.second.first;
-    if (n_prime.isNegative()) {
-        n_prime += r;
-    }
+    // R^2 mod modulus is what carries values into Montgomery form
+    r2 = (BigNum(1LL) << (k * 128)) % modulus;
+    
+    // R^(-1) mod modulus = REDC(1)
+    mpn::limb_t* t = contextScratch(2 * k);
+    mpn::zero(t, 2 * k);
+    t[0] = 1;
+    LimbVector inv(k);
+    mpn::mont_redc(inv.data(), t, np, k, n0);
+    r_inv = BigNum(std::move(inv), false);
 }
 
 BigNum MontgomeryContext::reduce(const BigNum& a) const {
-    // Optimized Montgomery reduction (CIOS method)
-    std::vector<uint64_t> t(2 * k + 1, 0);
-    
-    // Copy input to working array
+    // REDC needs a < modulus * R; anything larger is brought into range first
     const auto& a_digits = a.getDigits();
-    for (size_t i = 0; i < std::min(a_digits.size(), 2 * k); ++i) {
-        t[i] = a_digits[i];
-    }
-    
-    // Montgomery reduction steps
-    for (size_t i = 0; i < k; ++i) {
-        // Calculate m = t[i] * n_prime[0] mod 2^64
-        const auto& n_prime_digits = n_prime.getDigits();
-        uint64_t m = t[i] * (n_prime_digits.empty() ? 0 : n_prime_digits[0]);
-        
-        // Add m * modulus to t, starting at position i
-        __uint128_t carry = 0;
-        const auto& mod_digits = modulus.getDigits();
-        for (size_t j = 0; j < k; ++j) {
-            __uint128_t prod = static_cast<__uint128_t>(t[i + j]) + 
-                              static_cast<__uint128_t>(m) * mod_digits[j] + carry;
-            t[i + j] = static_cast<uint64_t>(prod);
-            carry = prod >> 64;
-        }
-        
-        // Propagate carry
-        for (size_t j = i + k; j < 2 * k + 1 && carry; ++j) {
-            __uint128_t sum = static_cast<__uint128_t>(t[j]) + carry;
-            t[j] = static_cast<uint64_t>(sum);
-            carry = sum >> 64;
+    size_t an = mpn::normalizedSize(a_digits.data(), a_digits.size());
+    if (a.isNegative() || an > 2 * k ||
+        (an == 2 * k && mpn::cmp(a_digits.data() + k, modulus.getDigits().data(), k) >= 0)) {
+        BigNum t = a % modulus;
+        if (t.isNegative()) {
+            t += modulus;
         }
+        return reduce(t);
     }
     
-    // Extract result from positions k to 2k-1
-    std::vector<uint64_t> result_digits(t.begin() + k, t.begin() + 2 * k);
-    BigNum result(result_digits, false);
-    
-    // Final conditional subtraction
-    if (result >= modulus) {
-        result -= modulus;
-    }
+    mpn::limb_t* t = contextScratch(2 * k);
+    mpn::copy(t, a_digits.data(), an);
+    mpn::zero(t + an, 2 * k - an);
     
-    return result;
+    LimbVector result(k);
+    mpn::mont_redc(result.data(), t, modulus.getDigits().data(), k, n0);
+    return BigNum(std::move(result), false);
 }
 
 BigNum MontgomeryContext::multiply(const BigNum& a, const BigNum& b) const {
-    // Montgomery multiplication: (a * b) / R mod modulus
-    BigNum product = a * b;
-    return reduce(product);
+    // Montgomery multiplication: (a * b) / R mod modulus, reduction fused
+    // into the product
+    mpn::limb_t* ap = contextScratch(3 * k + 2);
+    mpn::limb_t* bp = ap + k;
+    loadReduced(ap, a, modulus, k);
+    loadReduced(bp, b, modulus, k);
+    
+    LimbVector result(k);
+    mpn::mont_mul(result.data(), ap, bp, modulus.getDigits().data(), k, n0, bp + k);
+    return BigNum(std::move(result), false);
+}
+
+BigNum MontgomeryContext::square(const BigNum& a) const {
+    // Montgomery squaring: a^2 / R mod modulus
+    mpn::limb_t* ap = contextScratch(3 * k + 2);
+    loadReduced(ap, a, modulus, k);
+    
+    LimbVector result(k);
+    mpn::mont_sqr(result.data(), ap, modulus.getDigits().data(), k, n0, ap + k);
+    return BigNum(std::move(result), false);
 }
 
 BigNum MontgomeryContext::toMontgomery(const BigNum& a) const {
-    // Convert to Montgomery form: a * R mod modulus
-    return (a * r) % modulus;
+    // Convert to Montgomery form: a * R mod modulus = REDC(a * R^2)
+    return multiply(a, r2);
 }
 
 BigNum MontgomeryContext::fromMontgomery(const BigNum& a) const {
@@ -1057,11 +3385,322 @@ BigNum MontgomeryContext::fromMontgomery(const BigNum& a) const {
     return reduce(a);
 }
 
+//------------------------------------------------------------------------------
+// MontgomeryCache implementation
+//------------------------------------------------------------------------------
+
+MontgomeryCache::MontgomeryCache(size_t capacity) : max_entries(capacity ? capacity : 1) {}
+
+std::shared_ptr<const MontgomeryContext> MontgomeryCache::get(const BigNum& mod) {
+    // Key on the raw limb bytes; BigNum keeps its digits normalized
+    const auto& d = mod.getDigits();
+    std::string key(reinterpret_cast<const char*>(d.data()), d.size() * sizeof(uint64_t));
+    
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+    }
+    
+    // Build outside the lock; a racing miss on the same modulus just keeps
+    // whichever context lands first
+    auto ctx = std::make_shared<const MontgomeryContext>(mod);
+    
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+    entries.emplace_front(key, ctx);
+    index[key] = entries.begin();
+    if (entries.size() > max_entries) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    return ctx;
+}
+
+size_t MontgomeryCache::size() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+void MontgomeryCache::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    entries.clear();
+    index.clear();
+}
+
+//------------------------------------------------------------------------------
+// ModArith implementation
+//------------------------------------------------------------------------------
+
+namespace {
+
+// Per-thread kernel scratch for ModArith, grown on demand and then reused,
+// which keeps field operations allocation-free and safe to run concurrently
+mpn::limb_t* fieldScratch(size_t n) {
+    thread_local LimbVector scratch;
+    if (scratch.size() < n) scratch.resize(n);
+    return scratch.data();
+}
+
+}  // namespace
+
+ModArith::ModArith(const BigNum& modulus) : mont(modulus), oneMont(mont.k), r3(mont.k) {
+    const size_t k = mont.k;
+    const mpn::limb_t* np = mont.modulus.getDigits().data();
+    mpn::limb_t* tp = fieldScratch(k + 2);
+    
+    LimbVector r2(k);
+    const auto& r2d = mont.r2.getDigits();
+    mpn::copy(r2.data(), r2d.data(), r2d.size());
+    
+    // R = REDC(R^2 * 1) and R^3 = REDC(R^2 * R^2)
+    LimbVector unit(k);
+    unit[0] = 1;
+    mpn::mont_mul(oneMont.data(), r2.data(), unit.data(), np, k, mont.n0, tp);
+    mpn::mont_mul(r3.data(), r2.data(), r2.data(), np, k, mont.n0, tp);
+}
+
+void ModArith::check(const Element& x) const {
+    if (x.limbs.size() != mont.k) {
+        throw std::invalid_argument("Element does not belong to this field");
+    }
+}
+
+ModArith::Element ModArith::element(const BigNum& value) const {
+    // x * R = REDC(x * R^2)
+    const size_t k = mont.k;
+    Element r;
+    r.limbs.resize(k);
+    loadReduced(r.limbs.data(), value, mont.modulus, k);
+    mpn::limb_t* r2 = fieldScratch(2 * k + 2);
+    const auto& r2d = mont.r2.getDigits();
+    mpn::copy(r2, r2d.data(), r2d.size());
+    mpn::zero(r2 + r2d.size(), k - r2d.size());
+    mpn::mont_mul(r.limbs.data(), r.limbs.data(), r2, mont.modulus.getDigits().data(), k, mont.n0, r2 + k);
+    return r;
+}
+
+BigNum ModArith::toBigNum(const Element& x) const {
+    check(x);
+    const size_t k = mont.k;
+    mpn::limb_t* tp = fieldScratch(2 * k);
+    mpn::copy(tp, x.limbs.data(), k);
+    mpn::zero(tp + k, k);
+    LimbVector result(k);
+    mpn::mont_redc(result.data(), tp, mont.modulus.getDigits().data(), k, mont.n0);
+    return BigNum(std::move(result), false);
+}
+
+ModArith::Element ModArith::zero() const {
+    Element r;
+    r.limbs.resize(mont.k);
+    return r;
+}
+
+ModArith::Element ModArith::one() const {
+    Element r;
+    r.limbs = oneMont;
+    return r;
+}
+
+bool ModArith::isZero(const Element& x) const {
+    check(x);
+    return mpn::normalizedSize(x.limbs.data(), mont.k) == 0;
+}
+
+void ModArith::add(Element& r, const Element& a, const Element& b) const {
+    check(a);
+    check(b);
+    const size_t k = mont.k;
+    const mpn::limb_t* np = mont.modulus.getDigits().data();
+    r.limbs.resize(k);
+    mpn::limb_t* rp = r.limbs.data();
+    const mpn::limb_t carry = mpn::add_n(rp, a.limbs.data(), b.limbs.data(), k);
+    if (carry || mpn::cmp(rp, np, k) >= 0) mpn::sub_n(rp, rp, np, k);
+}
+
+void ModArith::sub(Element& r, const Element& a, const Element& b) const {
+    check(a);
+    check(b);
+    const size_t k = mont.k;
+    r.limbs.resize(k);
+    mpn::limb_t* rp = r.limbs.data();
+    if (mpn::sub_n(rp, a.limbs.data(), b.limbs.data(), k)) {
+        mpn::add_n(rp, rp, mont.modulus.getDigits().data(), k);
+    }
+}
+
+void ModArith::neg(Element& r, const Element& a) const {
+    check(a);
+    const size_t k = mont.k;
+    r.limbs.resize(k);
+    if (mpn::normalizedSize(a.limbs.data(), k) == 0) {
+        mpn::zero(r.limbs.data(), k);
+    } else {
+        mpn::sub_n(r.limbs.data(), mont.modulus.getDigits().data(), a.limbs.data(), k);
+    }
+}
+
+void ModArith::mul(Element& r, const Element& a, const Element& b) const {
+    check(a);
+    check(b);
+    const size_t k = mont.k;
+    r.limbs.resize(k);
+    mpn::mont_mul(r.limbs.data(), a.limbs.data(), b.limbs.data(), mont.modulus.getDigits().data(),
+                  k, mont.n0, fieldScratch(k + 2));
+}
+
+void ModArith::sqr(Element& r, const Element& a) const {
+    check(a);
+    const size_t k = mont.k;
+    r.limbs.resize(k);
+    mpn::mont_sqr(r.limbs.data(), a.limbs.data(), mont.modulus.getDigits().data(),
+                  k, mont.n0, fieldScratch(2 * k));
+}
+
+void ModArith::inv(Element& r, const Element& a) const {
+    // modInverse(x R) = x^-1 R^-1, and one Montgomery multiplication by R^3
+    // turns that into x^-1 R
+    check(a);
+    const size_t k = mont.k;
+    BigNum inverse = BigNum(LimbVector(a.limbs)).modInverse(mont.modulus);
+    r.limbs.resize(k);
+    mpn::limb_t* rp = r.limbs.data();
+    const auto& d = inverse.getDigits();
+    const size_t n = mpn::normalizedSize(d.data(), d.size());
+    mpn::copy(rp, d.data(), n);
+    mpn::zero(rp + n, k - n);
+    mpn::mont_mul(rp, rp, r3.data(), mont.modulus.getDigits().data(), k, mont.n0, fieldScratch(k + 2));
+}
+
+void ModArith::pow(Element& r, const Element& a, const BigNum& exponent) const {
+    check(a);
+    const size_t k = mont.k;
+    if (exponent.isZero()) {
+        r.limbs = oneMont;
+        return;
+    }
+    
+    Element inverted;
+    const Element* base = &a;
+    if (exponent.isNegative()) {
+        inv(inverted, a);
+        base = &inverted;
+    }
+    
+    const mpn::limb_t* np = mont.modulus.getDigits().data();
+    const auto& e = exponent.getDigits();
+    const size_t bits = exponent.bitLength();
+    const size_t w = expWindowBits(bits);
+    const size_t entries = size_t(1) << (w - 1);
+    
+    // Odd powers (entries * k), base^2 (k) and kernel scratch (2k + 2); the
+    // accumulator is r itself, which may alias a, so the table is filled
+    // first
+    mpn::limb_t* table = fieldScratch((entries + 1) * k + 2 * k + 2);
+    mpn::limb_t* b2 = table + entries * k;
+    mpn::limb_t* tp = b2 + k;
+    mpn::copy(table, base->limbs.data(), k);
+    if (entries > 1) {
+        mpn::mont_sqr(b2, table, np, k, mont.n0, tp);
+        for (size_t i = 1; i < entries; ++i) {
+            mpn::mont_mul(table + i * k, table + (i - 1) * k, b2, np, k, mont.n0, tp);
+        }
+    }
+    
+    r.limbs.resize(k);
+    mpn::limb_t* acc = r.limbs.data();
+    slidingWindow(e, bits, w,
+        [&](size_t i) { mpn::copy(acc, table + i * k, k); },
+        [&](size_t i) { mpn::mont_mul(acc, acc, table + i * k, np, k, mont.n0, tp); },
+        [&]() { mpn::mont_sqr(acc, acc, np, k, mont.n0, tp); });
+}
+
+ModArith::Element ModArith::add(const Element& a, const Element& b) const {
+    Element r;
+    add(r, a, b);
+    return r;
+}
+
+ModArith::Element ModArith::sub(const Element& a, const Element& b) const {
+    Element r;
+    sub(r, a, b);
+    return r;
+}
+
+ModArith::Element ModArith::neg(const Element& a) const {
+    Element r;
+    neg(r, a);
+    return r;
+}
+
+ModArith::Element ModArith::mul(const Element& a, const Element& b) const {
+    Element r;
+    mul(r, a, b);
+    return r;
+}
+
+ModArith::Element ModArith::sqr(const Element& a) const {
+    Element r;
+    sqr(r, a);
+    return r;
+}
+
+ModArith::Element ModArith::inv(const Element& a) const {
+    Element r;
+    inv(r, a);
+    return r;
+}
+
+ModArith::Element ModArith::pow(const Element& a, const BigNum& exponent) const {
+    Element r;
+    pow(r, a, exponent);
+    return r;
+}
+
+void ModArith::batchInv(std::vector<Element>& xs) const {
+    const size_t n = xs.size();
+    if (n == 0) return;
+    for (const Element& x : xs) check(x);
+    
+    // prefix[i] = x_0 * ... * x_i
+    const size_t k = mont.k;
+    const mpn::limb_t* np = mont.modulus.getDigits().data();
+    LimbVector prefix(n * k);
+    mpn::copy(prefix.data(), xs[0].limbs.data(), k);
+    for (size_t i = 1; i < n; ++i) {
+        mpn::mont_mul(prefix.data() + i * k, prefix.data() + (i - 1) * k, xs[i].limbs.data(),
+                      np, k, mont.n0, fieldScratch(k + 2));
+    }
+    
+    // One inversion of the full product, then peel one factor per step:
+    // x_i^-1 = (x_0 ... x_i)^-1 * (x_0 ... x_{i-1})
+    Element acc;
+    acc.limbs.assign(prefix.data() + (n - 1) * k, prefix.data() + n * k);
+    inv(acc, acc);
+    Element xi;
+    for (size_t i = n - 1; i > 0; --i) {
+        xi.limbs = xs[i].limbs;
+        mpn::mont_mul(xs[i].limbs.data(), acc.limbs.data(), prefix.data() + (i - 1) * k,
+                      np, k, mont.n0, fieldScratch(k + 2));
+        mul(acc, acc, xi);
+    }
+    xs[0].limbs = acc.limbs;
+}
+
 //------------------------------------------------------------------------------
 // BarrettContext implementation (at global/file scope)
 //------------------------------------------------------------------------------
 
 BarrettContext::BarrettContext(const BigNum& mod) : modulus(mod) {
+    BIGNUM_STAT_SCOPE(BarrettContext, mod.getDigits().size());
     if (mod.isZero()) {
         throw std::invalid_argument("Barrett reduction requires non-zero modulus");
     }
@@ -1093,17 +3732,18 @@ BigNum BarrettContext::reduce(const BigNum& a) const {
     // q3 = floor(q2 / R^(k+1))
     BigNum q3 = q2 >> (k + 1);
     
-    // r1 = a mod R^(k+1)
-    BigNum r_mask = (BigNum(1LL) << (k + 1)) - BigNum(1LL);
+    // r1 = a mod R^(k+2). With a radix of 2 the true remainder estimate can
+    // reach 3 * modulus, which needs one more bit than the textbook R^(k+1).
+    BigNum r_mask = (BigNum(1LL) << (k + 2)) - BigNum(1LL);
     BigNum r1 = a & r_mask;
     
-    // r2 = (q3 * modulus) mod R^(k+1)
+    // r2 = (q3 * modulus) mod R^(k+2)
     BigNum r2 = (q3 * modulus) & r_mask;
     
     // result = r1 - r2
     BigNum result = r1 - r2;
     if (result.isNegative()) {
-        result += (BigNum(1LL) << (k + 1));
+        result += (BigNum(1LL) << (k + 2));
     }
     
     // Final reduction
@@ -1112,4 +3752,52 @@ BigNum BarrettContext::reduce(const BigNum& a) const {
     }
     
     return result;
-}
\ No newline at end of file
+}
+
+RSACRTContext::RSACRTContext(const BigNum& p, const BigNum& q, const BigNum& dP, const BigNum& dQ,
+                             const BigNum& qInv)
+    : dP(dP), dQ(dQ), qInv(qInv), montP(p), montQ(q) {
+    const BigNum& pm = montP.modulus;
+    const BigNum& qm = montQ.modulus;
+    if (pm.isOne() || qm.isOne() || pm == qm) {
+        throw std::invalid_argument("RSA-CRT needs two distinct factors greater than one");
+    }
+    if (dP.isNegative() || dQ.isNegative()) {
+        throw std::invalid_argument("RSA-CRT exponents must be non-negative");
+    }
+    if (!BigNum::mulMod(qInv, qm, pm).isOne()) {
+        throw std::invalid_argument("qInv is not the inverse of q mod p");
+    }
+    n = pm * qm;
+}
+
+BigNum RSACRTContext::modPow(const BigNum& c, BigNum::Execution mode) const {
+    BIGNUM_STAT_SCOPE(ModPowCrt, n.getDigits().size());
+    if (c.isNegative() || c >= n) {
+        throw std::invalid_argument("RSA-CRT input must be in [0, p*q)");
+    }
+    
+    BigNum mp, mq;
+    if (mode == BigNum::Execution::Parallel) {
+        bignum::ThreadPool::shared()->parallelFor(2, [&](size_t i) {
+            if (i == 0) mp = c.modPow(dP, montP);
+            else mq = c.modPow(dQ, montQ);
+        });
+    } else {
+        mp = c.modPow(dP, montP);
+        mq = c.modPow(dQ, montQ);
+    }
+    
+    // Garner: h = qInv * (m_p - m_q) mod p, then m = m_q + h * q < p * q
+    const BigNum& p = montP.modulus;
+    BigNum diff = (mp - mq) % p;
+    if (diff.isNegative()) {
+        diff += p;
+    }
+    BigNum h = BigNum::mulMod(qInv, diff, p);
+    if (h.isNegative()) {
+        h += p;
+    }
+    mq.addMul(h, montQ.modulus);
+    return mq;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file bignum_kernels.cpp
+ * @brief CPU-specific limb kernels and the one-time selection between them.
+ *
+ * The build no longer assumes the machine it runs on (no -march=native), so
+ * instruction-set extensions are detected here instead. At static
+ * initialisation the best kernel set the CPU supports is published through
+ * the atomic mpn::active_kernels pointer; the BIGNUM_KERNELS environment variable can name a
+ * specific set (e.g. "portable") to override that choice.
+ */
+
+#include "bignum_mpn.h"
+#include <cstdlib>
+#include <cstring>
+
+#if BIGNUM_MPN_DISPATCH
+#include <cpuid.h>
+#endif
+
+namespace bignum {
+namespace mpn {
+
+namespace {
+
+#if BIGNUM_MPN_DISPATCH
+
+// MULX leaves the flags alone, and ADCX/ADOX carry through CF and OF
+// respectively, so the carry out of the product's low half and the carry out
+// of the accumulation run as two independent chains. The loop counter lives
+// in rcx and is tested with JRCXZ, which does not touch either flag.
+limb_t addmul_1_mulx_adx(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    if (n == 0) return 0;
+    limb_t high = 0, lo, hi;
+    __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "1:\n\t"
+        "mulx (%[up]), %[lo], %[hi]\n\t"
+        "adcx %[high], %[lo]\n\t"
+        "adox (%[rp]), %[lo]\n\t"
+        "mov %[lo], (%[rp])\n\t"
+        "mov %[hi], %[high]\n\t"
+        "lea 8(%[up]), %[up]\n\t"
+        "lea 8(%[rp]), %[rp]\n\t"
+        "lea -1(%[n]), %[n]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adcx %[lo], %[high]\n\t"
+        "adox %[lo], %[high]\n\t"
+        : [rp] "+&r"(rp), [up] "+&r"(up), [n] "+&c"(n), [high] "+&r"(high),
+          [lo] "=&r"(lo), [hi] "=&r"(hi)
+        : "d"(v)
+        : "cc", "memory");
+    return high;
+}
+
+limb_t mul_1_mulx_adx(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    if (n == 0) return 0;
+    limb_t high = 0, lo, hi;
+    __asm__(
+        "xor %k[lo], %k[lo]\n\t"
+        "1:\n\t"
+        "mulx (%[up]), %[lo], %[hi]\n\t"
+        "adcx %[high], %[lo]\n\t"
+        "mov %[lo], (%[rp])\n\t"
+        "mov %[hi], %[high]\n\t"
+        "lea 8(%[up]), %[up]\n\t"
+        "lea 8(%[rp]), %[rp]\n\t"
+        "lea -1(%[n]), %[n]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adcx %[lo], %[high]\n\t"
+        : [rp] "+&r"(rp), [up] "+&r"(up), [n] "+&c"(n), [high] "+&r"(high),
+          [lo] "=&r"(lo), [hi] "=&r"(hi)
+        : "d"(v)
+        : "cc", "memory");
+    return high;
+}
+
+bool cpuHasMulxAdx() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+    const unsigned bmi2 = 1u << 8, adx = 1u << 19;
+    return (ebx & bmi2) && (ebx & adx);
+}
+
+#endif
+
+const Kernels portableKernels = {"portable", mul_1_portable, addmul_1_portable};
+
+struct KernelList {
+    Kernels sets[2];
+    size_t count = 0;
+
+    KernelList() {
+#if BIGNUM_MPN_DISPATCH
+        if (cpuHasMulxAdx()) {
+            sets[count++] = {"x86-64-mulx-adx", mul_1_mulx_adx, addmul_1_mulx_adx};
+        }
+#endif
+        sets[count++] = portableKernels;
+    }
+};
+
+const KernelList& kernelList() {
+    static const KernelList list;
+    return list;
+}
+
+#if BIGNUM_MPN_DISPATCH
+// Runs once during static initialisation of the library
+[[maybe_unused]] const bool kernelsSelected = [] {
+    const char* requested = std::getenv("BIGNUM_KERNELS");
+    if (!requested || !selectKernels(requested)) {
+        active_kernels.store(&kernelList().sets[0], std::memory_order_release);
+    }
+    return true;
+}();
+#endif
+
+}  // namespace
+
+#if BIGNUM_MPN_DISPATCH
+std::atomic<const Kernels*> active_kernels{&portableKernels};
+#endif
+
+const Kernels* availableKernels(size_t* count) {
+    const KernelList& list = kernelList();
+    *count = list.count;
+    return list.sets;
+}
+
+const Kernels& currentKernels() {
+#if BIGNUM_MPN_DISPATCH
+    return *active_kernels.load(std::memory_order_acquire);
+#else
+    return portableKernels;
+#endif
+}
+
+bool selectKernels(const char* name) {
+    const KernelList& list = kernelList();
+    for (size_t i = 0; i < list.count; ++i) {
+        if (std::strcmp(list.sets[i].name, name) == 0) {
+#if BIGNUM_MPN_DISPATCH
+            active_kernels.store(&list.sets[i], std::memory_order_release);
+#endif
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace mpn
+}  // namespace bignum
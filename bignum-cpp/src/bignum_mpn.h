@@ -0,0 +1,819 @@
+/**
+ * @file bignum_mpn.h
+ * @brief Internal low-level kernels operating on raw little-endian limb spans.
+ *
+ * These routines are the allocation-free layer underneath BigNum. They never
+ * resize anything: every output is written into a caller-provided buffer that
+ * must already be large enough. Unless stated otherwise the output may alias
+ * an input exactly (rp == up), which is what the in-place operators rely on.
+ *
+ * This header is private to the library and is not installed.
+ */
+
+#ifndef BIGNUM_MPN_H
+#define BIGNUM_MPN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bignum {
+namespace mpn {
+
+using limb_t = uint64_t;
+using dlimb_t = __uint128_t;
+
+constexpr unsigned LIMB_BITS = 64;
+
+inline int clz(limb_t x) {
+    return __builtin_clzll(x);
+}
+
+inline int ctz(limb_t x) {
+    return __builtin_ctzll(x);
+}
+
+inline void copy(limb_t* rp, const limb_t* up, size_t n) {
+    if (n) std::memmove(rp, up, n * sizeof(limb_t));
+}
+
+inline void zero(limb_t* rp, size_t n) {
+    if (n) std::memset(rp, 0, n * sizeof(limb_t));
+}
+
+// Number of limbs once high zero limbs are dropped (never below zero)
+inline size_t normalizedSize(const limb_t* up, size_t n) {
+    while (n > 0 && up[n - 1] == 0) --n;
+    return n;
+}
+
+// Compares two n-limb magnitudes: -1, 0 or 1
+inline int cmp(const limb_t* up, const limb_t* vp, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (up[i] != vp[i]) return up[i] < vp[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Compares magnitudes of possibly different (normalized) lengths
+inline int cmp(const limb_t* up, size_t un, const limb_t* vp, size_t vn) {
+    if (un != vn) return un < vn ? -1 : 1;
+    return cmp(up, vp, un);
+}
+
+// rp[0..n) = up[0..n) + vp[0..n), returns the carry out
+inline limb_t add_n(limb_t* rp, const limb_t* up, const limb_t* vp, size_t n) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t sum = static_cast<dlimb_t>(up[i]) + vp[i] + carry;
+        rp[i] = static_cast<limb_t>(sum);
+        carry = static_cast<limb_t>(sum >> 64);
+    }
+    return carry;
+}
+
+// rp[0..n) = up[0..n) + v, returns the carry out
+inline limb_t add_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    size_t i = 0;
+    for (; i < n && v; ++i) {
+        limb_t s = up[i] + v;
+        v = s < v;
+        rp[i] = s;
+    }
+    if (rp != up) copy(rp + i, up + i, n - i);
+    return v;
+}
+
+// rp[0..un) = up[0..un) + vp[0..vn), requires un >= vn; returns the carry out
+inline limb_t add(limb_t* rp, const limb_t* up, size_t un, const limb_t* vp, size_t vn) {
+    limb_t carry = add_n(rp, up, vp, vn);
+    return add_1(rp + vn, up + vn, un - vn, carry);
+}
+
+// rp[0..n) = up[0..n) - vp[0..n), returns the borrow out
+inline limb_t sub_n(limb_t* rp, const limb_t* up, const limb_t* vp, size_t n) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        limb_t a = up[i];
+        limb_t b = vp[i];
+        limb_t d = a - b;
+        limb_t b1 = a < b;
+        rp[i] = d - borrow;
+        borrow = b1 | (d < borrow);
+    }
+    return borrow;
+}
+
+// rp[0..n) = up[0..n) - v, returns the borrow out
+inline limb_t sub_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    size_t i = 0;
+    for (; i < n && v; ++i) {
+        limb_t a = up[i];
+        rp[i] = a - v;
+        v = a < v;
+    }
+    if (rp != up) copy(rp + i, up + i, n - i);
+    return v;
+}
+
+// rp[0..un) = up[0..un) - vp[0..vn), requires un >= vn; returns the borrow out
+inline limb_t sub(limb_t* rp, const limb_t* up, size_t un, const limb_t* vp, size_t vn) {
+    limb_t borrow = sub_n(rp, up, vp, vn);
+    return sub_1(rp + vn, up + vn, un - vn, borrow);
+}
+
+// Portable forms of the two kernels that dominate schoolbook multiplication
+// and Montgomery reduction; mul_1 and addmul_1 below may route them to a
+// CPU-specific implementation instead (see bignum_kernels.cpp).
+
+// rp[0..n) = up[0..n) * v, returns the high limb
+inline limb_t mul_1_portable(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t p = static_cast<dlimb_t>(up[i]) * v + carry;
+        rp[i] = static_cast<limb_t>(p);
+        carry = static_cast<limb_t>(p >> 64);
+    }
+    return carry;
+}
+
+// rp[0..n) += up[0..n) * v, returns the high limb
+inline limb_t addmul_1_portable(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t p = static_cast<dlimb_t>(up[i]) * v + rp[i] + carry;
+        rp[i] = static_cast<limb_t>(p);
+        carry = static_cast<limb_t>(p >> 64);
+    }
+    return carry;
+}
+
+// Kernel table. Only x86-64 has a variant worth an indirect call (MULX with
+// the independent ADCX/ADOX carry chains); on AArch64 the portable loops
+// already compile to MUL/UMULH with ADCS, and NEON has no 64x64->128
+// multiply, so other targets call the portable kernels directly.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIGNUM_MPN_DISPATCH 1
+#else
+#define BIGNUM_MPN_DISPATCH 0
+#endif
+
+using mul_1_fn = limb_t (*)(limb_t*, const limb_t*, size_t, limb_t);
+
+struct Kernels {
+    const char* name;
+    mul_1_fn mul_1;
+    mul_1_fn addmul_1;
+};
+
+#if BIGNUM_MPN_DISPATCH
+// Points at one of the immutable sets of availableKernels(). Starts out
+// portable (constant-initialised, so usable during any static
+// initialisation) and is upgraded once at startup to the best set the CPU
+// supports. A switch is a single pointer store, so threads inside a kernel
+// call during setKernels see either the old set or the new one, never a mix.
+extern std::atomic<const Kernels*> active_kernels;
+
+inline limb_t mul_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    return active_kernels.load(std::memory_order_acquire)->mul_1(rp, up, n, v);
+}
+
+inline limb_t addmul_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    return active_kernels.load(std::memory_order_acquire)->addmul_1(rp, up, n, v);
+}
+#else
+inline limb_t mul_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    return mul_1_portable(rp, up, n, v);
+}
+
+inline limb_t addmul_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    return addmul_1_portable(rp, up, n, v);
+}
+#endif
+
+// Every kernel set this CPU can run, best first; selectKernels installs one
+// by name and returns false if it is not in that list.
+const Kernels* availableKernels(size_t* count);
+const Kernels& currentKernels();
+bool selectKernels(const char* name);
+
+// rp[0..n) -= up[0..n) * v, returns the limb to borrow from rp[n]
+inline limb_t submul_1(limb_t* rp, const limb_t* up, size_t n, limb_t v) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t p = static_cast<dlimb_t>(up[i]) * v + carry;
+        limb_t lo = static_cast<limb_t>(p);
+        carry = static_cast<limb_t>(p >> 64);
+        limb_t r = rp[i];
+        rp[i] = r - lo;
+        carry += r < lo;
+    }
+    return carry;
+}
+
+// rp[0..n) = up[0..n) << cnt for 0 < cnt < 64, returns the bits shifted out.
+// Walks from the top, so rp may overlap up as long as rp >= up.
+inline limb_t lshift(limb_t* rp, const limb_t* up, size_t n, unsigned cnt) {
+    const unsigned tnc = LIMB_BITS - cnt;
+    limb_t high = up[n - 1];
+    limb_t out = high >> tnc;
+    for (size_t i = n - 1; i > 0; --i) {
+        limb_t low = up[i - 1];
+        rp[i] = (high << cnt) | (low >> tnc);
+        high = low;
+    }
+    rp[0] = high << cnt;
+    return out;
+}
+
+// rp[0..n) = up[0..n) >> cnt for 0 < cnt < 64, returns the bits shifted out
+// (in the high end of the returned limb). Walks from the bottom, so rp may
+// overlap up as long as rp <= up.
+inline limb_t rshift(limb_t* rp, const limb_t* up, size_t n, unsigned cnt) {
+    const unsigned tnc = LIMB_BITS - cnt;
+    limb_t low = up[0];
+    limb_t out = low << tnc;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        limb_t high = up[i + 1];
+        rp[i] = (low >> cnt) | (high << tnc);
+        low = high;
+    }
+    rp[n - 1] = low >> cnt;
+    return out;
+}
+
+// rp[0..un+vn) = up[0..un) * vp[0..vn). rp must not overlap either input.
+inline void mul_basecase(limb_t* rp, const limb_t* up, size_t un, const limb_t* vp, size_t vn) {
+    rp[un] = mul_1(rp, up, un, vp[0]);
+    for (size_t j = 1; j < vn; ++j) {
+        rp[un + j] = addmul_1(rp + j, up, un, vp[j]);
+    }
+}
+
+// rp[0..2n) = up[0..n)^2. Each off-diagonal product up[i] * up[j] is formed
+// once and the sum doubled with a shift, so this costs about half of
+// mul_basecase. rp must not overlap up.
+inline void sqr_basecase(limb_t* rp, const limb_t* up, size_t n) {
+    // Cross products up[i] * up[j] for i < j
+    rp[0] = 0;
+    rp[n] = mul_1(rp + 1, up + 1, n - 1, up[0]);
+    for (size_t i = 1; i < n; ++i) {
+        rp[i + n] = addmul_1(rp + 2 * i + 1, up + i + 1, n - i - 1, up[i]);
+    }
+    
+    // Double them (the sum is below 2^(128n - 1), so nothing shifts out)
+    // and add the squares up[i]^2 on the diagonal
+    lshift(rp, rp, 2 * n, 1);
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb_t sq = static_cast<dlimb_t>(up[i]) * up[i];
+        dlimb_t lo = static_cast<dlimb_t>(rp[2 * i]) + static_cast<limb_t>(sq) + carry;
+        rp[2 * i] = static_cast<limb_t>(lo);
+        dlimb_t hi = static_cast<dlimb_t>(rp[2 * i + 1]) + static_cast<limb_t>(sq >> 64) +
+                     static_cast<limb_t>(lo >> 64);
+        rp[2 * i + 1] = static_cast<limb_t>(hi);
+        carry = static_cast<limb_t>(hi >> 64);
+    }
+}
+
+// Scratch limbs needed by sqr_karatsuba for an n-limb operand
+inline size_t sqr_karatsuba_scratch(size_t n, size_t threshold) {
+    size_t total = 0;
+    while (n >= threshold) {
+        size_t l = (n + 1) / 2;
+        total += 5 * l + 1;
+        n = l;
+    }
+    return total;
+}
+
+// rp[0..2n) = up[0..n)^2 by Karatsuba, falling back to sqr_basecase below
+// threshold limbs (threshold must be at least 2). With up = a1 * B^l + a0:
+//   up^2 = a1^2 * B^2l + (a0^2 + a1^2 - (a0 - a1)^2) * B^l + a0^2
+// which needs three half-size squarings and no multiplications. tp needs
+// sqr_karatsuba_scratch(n, threshold) limbs; rp must not overlap up or tp.
+inline void sqr_karatsuba(limb_t* rp, const limb_t* up, size_t n, limb_t* tp, size_t threshold) {
+    if (n < threshold) {
+        sqr_basecase(rp, up, n);
+        return;
+    }
+    
+    const size_t l = (n + 1) / 2;  // low half, never shorter than the high half
+    const size_t h = n - l;
+    const limb_t* a0 = up;
+    const limb_t* a1 = up + l;
+    
+    limb_t* d = tp;           // |a0 - a1|, l limbs
+    limb_t* d2 = d + l;       // d^2, 2l limbs
+    limb_t* t = d2 + 2 * l;   // a0^2 + a1^2, 2l + 1 limbs
+    limb_t* next = t + 2 * l + 1;
+    
+    // |a0 - a1| with a1 zero-extended to l limbs
+    size_t an = normalizedSize(a1, h);
+    if (cmp(a0, normalizedSize(a0, l), a1, an) >= 0) {
+        sub(d, a0, l, a1, h);
+    } else {
+        sub_n(d, a1, a0, h);
+        if (l > h) d[h] = 0;  // a0 < a1 < B^h, so a0[h] is zero too
+    }
+    
+    sqr_karatsuba(rp, a0, l, next, threshold);
+    sqr_karatsuba(rp + 2 * l, a1, h, next, threshold);
+    sqr_karatsuba(d2, d, l, next, threshold);
+    
+    // Middle term 2 * a0 * a1, which fits in l + h + 1 limbs
+    t[2 * l] = add(t, rp, 2 * l, rp + 2 * l, 2 * h);
+    sub(t, t, 2 * l + 1, d2, 2 * l);
+    add(rp + l, rp + l, 2 * n - l, t, normalizedSize(t, 2 * l + 1));
+}
+
+// Inverse of an odd limb modulo 2^64 by Newton/Hensel lifting: each step
+// x = x * (2 - n * x) doubles the number of correct low bits.
+inline limb_t binvert_limb(limb_t n) {
+    limb_t x = (3 * n) ^ 2;  // correct to 5 bits
+    for (int i = 0; i < 4; ++i) {
+        x *= 2 - n * x;
+    }
+    return x;
+}
+
+// Returns an all-ones mask when x is non-zero and zero otherwise, without
+// branching on x
+inline limb_t mask_nonzero(limb_t x) {
+    return 0 - ((x | (0 - x)) >> 63);
+}
+
+// rp[i] = mask ? up[i] : vp[i] for an all-ones or all-zeros mask, without a
+// data-dependent branch. rp may alias either input.
+inline void cnd_select(limb_t* rp, const limb_t* up, const limb_t* vp, size_t n, limb_t mask) {
+    for (size_t i = 0; i < n; ++i) {
+        rp[i] = (up[i] & mask) | (vp[i] & ~mask);
+    }
+}
+
+// Swaps up and vp when mask is all ones, without a data-dependent branch
+inline void cnd_swap(limb_t* up, limb_t* vp, size_t n, limb_t mask) {
+    for (size_t i = 0; i < n; ++i) {
+        limb_t d = (up[i] ^ vp[i]) & mask;
+        up[i] ^= d;
+        vp[i] ^= d;
+    }
+}
+
+// Branch-free final Montgomery subtraction: rp = (hi:tp) - np when that is
+// non-negative, tp otherwise. hi is the extra top limb (0 or 1) and tp must
+// be below 2 * np. rp must not overlap tp.
+inline void sub_mod_ct(limb_t* rp, const limb_t* tp, limb_t hi, const limb_t* np, size_t n) {
+    limb_t borrow = sub_n(rp, tp, np, n);
+    cnd_select(rp, rp, tp, n, mask_nonzero(hi | (borrow ^ 1)));
+}
+
+// CIOS rows shared by mont_mul and mont_mul_ct: leaves ap * bp * 2^(-64n)
+// in tp[0..n], which is below 2 * np. tp needs n + 2 limbs.
+inline void mont_mul_rows(const limb_t* ap, const limb_t* bp, const limb_t* np, size_t n,
+                          limb_t n0, limb_t* tp) {
+    zero(tp, n + 2);
+    for (size_t i = 0; i < n; ++i) {
+        // t += a * b[i]
+        limb_t c = addmul_1(tp, ap, n, bp[i]);
+        dlimb_t s = static_cast<dlimb_t>(tp[n]) + c;
+        tp[n] = static_cast<limb_t>(s);
+        tp[n + 1] = static_cast<limb_t>(s >> 64);
+        
+        // t = (t + m * N) / 2^64, with m chosen so the low limb cancels
+        limb_t m = tp[0] * n0;
+        dlimb_t p = static_cast<dlimb_t>(m) * np[0] + tp[0];
+        limb_t carry = static_cast<limb_t>(p >> 64);
+        for (size_t j = 1; j < n; ++j) {
+            p = static_cast<dlimb_t>(m) * np[j] + tp[j] + carry;
+            tp[j - 1] = static_cast<limb_t>(p);
+            carry = static_cast<limb_t>(p >> 64);
+        }
+        s = static_cast<dlimb_t>(tp[n]) + carry;
+        tp[n - 1] = static_cast<limb_t>(s);
+        tp[n] = tp[n + 1] + static_cast<limb_t>(s >> 64);
+    }
+}
+
+// REDC rows shared by mont_redc and mont_redc_ct: folds tp[0..2n) down to
+// tp[n..2n) plus the returned carry limb.
+inline limb_t mont_redc_rows(limb_t* tp, const limb_t* np, size_t n, limb_t n0) {
+    for (size_t i = 0; i < n; ++i) {
+        limb_t m = tp[i] * n0;
+        // The addmul clears tp[i]; park the row carry there and fold all of
+        // them in with one add at the end (they belong at offset i + n)
+        tp[i] = addmul_1(tp + i, np, n, m);
+    }
+    return add_n(tp + n, tp + n, tp, n);
+}
+
+// Montgomery multiplication, CIOS variant (Koc, Acar, Kaliski 1996):
+// rp[0..n) = ap * bp * 2^(-64n) mod np, with the reduction interleaved into
+// the product so the 2n-limb intermediate is never formed. n0 is
+// -np^(-1) mod 2^64. Inputs must be below np; tp needs n + 2 limbs and must
+// not overlap anything else. rp may alias ap or bp.
+inline void mont_mul(limb_t* rp, const limb_t* ap, const limb_t* bp, const limb_t* np,
+                     size_t n, limb_t n0, limb_t* tp) {
+    mont_mul_rows(ap, bp, np, n, n0, tp);
+    
+    // t < 2N here, so one conditional subtraction finishes the reduction
+    if (tp[n] || cmp(tp, np, n) >= 0) {
+        sub_n(rp, tp, np, n);
+    } else {
+        copy(rp, tp, n);
+    }
+}
+
+// Montgomery reduction (REDC) of a 2n-limb value:
+// rp[0..n) = tp[0..2n) * 2^(-64n) mod np. tp is destroyed; rp may alias
+// tp + n. Requires tp < np * 2^(64n), which holds for any product of two
+// reduced values.
+inline void mont_redc(limb_t* rp, limb_t* tp, const limb_t* np, size_t n, limb_t n0) {
+    limb_t carry = mont_redc_rows(tp, np, n, n0);
+    if (carry || cmp(tp + n, np, n) >= 0) {
+        sub_n(rp, tp + n, np, n);
+    } else {
+        copy(rp, tp + n, n);
+    }
+}
+
+// Montgomery squaring: rp[0..n) = ap^2 * 2^(-64n) mod np. tp needs 2n limbs
+// and must not overlap ap; rp may alias ap.
+inline void mont_sqr(limb_t* rp, const limb_t* ap, const limb_t* np, size_t n, limb_t n0,
+                     limb_t* tp) {
+    sqr_basecase(tp, ap, n);
+    mont_redc(rp, tp, np, n, n0);
+}
+
+// Constant-time counterparts of the three kernels above: same contracts,
+// except that rp must not overlap tp, and the final subtraction is a masked
+// select, so timing depends only on n.
+inline void mont_mul_ct(limb_t* rp, const limb_t* ap, const limb_t* bp, const limb_t* np,
+                        size_t n, limb_t n0, limb_t* tp) {
+    mont_mul_rows(ap, bp, np, n, n0, tp);
+    sub_mod_ct(rp, tp, tp[n], np, n);
+}
+
+inline void mont_redc_ct(limb_t* rp, limb_t* tp, const limb_t* np, size_t n, limb_t n0) {
+    limb_t carry = mont_redc_rows(tp, np, n, n0);
+    sub_mod_ct(rp, tp + n, carry, np, n);
+}
+
+inline void mont_sqr_ct(limb_t* rp, const limb_t* ap, const limb_t* np, size_t n, limb_t n0,
+                        limb_t* tp) {
+    sqr_basecase(tp, ap, n);
+    mont_redc_ct(rp, tp, np, n, n0);
+}
+
+// Constant-time table access. scatter stores entry idx of a table of
+// `entries` n-limb values interleaved (limb i of every entry is adjacent),
+// and gather reads entry idx back by touching every entry under a mask, so
+// the memory access pattern does not depend on idx.
+inline void scatter(limb_t* table, size_t entries, const limb_t* up, size_t n, size_t idx) {
+    for (size_t i = 0; i < n; ++i) {
+        table[i * entries + idx] = up[i];
+    }
+}
+
+inline void gather(limb_t* rp, const limb_t* table, size_t entries, size_t n, size_t idx) {
+    for (size_t i = 0; i < n; ++i) {
+        const limb_t* row = table + i * entries;
+        limb_t v = 0;
+        for (size_t j = 0; j < entries; ++j) {
+            v |= row[j] & ~mask_nonzero(static_cast<limb_t>(j ^ idx));
+        }
+        rp[i] = v;
+    }
+}
+
+// Divides the 128-bit value (hi:lo) by d. Requires hi < d so the quotient
+// fits in a single limb.
+inline limb_t udiv128(limb_t hi, limb_t lo, limb_t d, limb_t& rem) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    limb_t q;
+    __asm__("divq %4" : "=a"(q), "=d"(rem) : "a"(lo), "d"(hi), "rm"(d));
+    return q;
+#else
+    dlimb_t num = (static_cast<dlimb_t>(hi) << 64) | lo;
+    rem = static_cast<limb_t>(num % d);
+    return static_cast<limb_t>(num / d);
+#endif
+}
+
+// qp[0..n) = up[0..n) / d, returns up mod d. d must be non-zero; qp may
+// alias up.
+inline limb_t divrem_1(limb_t* qp, const limb_t* up, size_t n, limb_t d) {
+    // Normalize so the estimate in udiv128 never overflows
+    const int s = clz(d);
+    const limb_t dn = d << s;
+    if (s == 0) {
+        limb_t rem = 0;
+        for (size_t i = n; i-- > 0;) {
+            qp[i] = udiv128(rem, up[i], dn, rem);
+        }
+        return rem;
+    }
+    // Walk the dividend as if it were shifted left by s; the spilled top
+    // bits seed the remainder and are always below dn.
+    limb_t rem = up[n - 1] >> (LIMB_BITS - s);
+    for (size_t i = n; i-- > 0;) {
+        limb_t limb = (up[i] << s) | (i > 0 ? up[i - 1] >> (LIMB_BITS - s) : 0);
+        qp[i] = udiv128(rem, limb, dn, rem);
+    }
+    return rem >> s;
+}
+
+// up[0..n) mod d without storing the quotient; d must be non-zero
+inline limb_t mod_1(const limb_t* up, size_t n, limb_t d) {
+    if (n == 0) return 0;
+    const int s = clz(d);
+    const limb_t dn = d << s;
+    limb_t rem = s ? up[n - 1] >> (LIMB_BITS - s) : 0;
+    for (size_t i = n; i-- > 0;) {
+        limb_t limb = s ? (up[i] << s) | (i > 0 ? up[i - 1] >> (LIMB_BITS - s) : 0) : up[i];
+        udiv128(rem, limb, dn, rem);
+    }
+    return rem >> s;
+}
+
+// Knuth, TAOCP vol. 2, 4.3.1 Algorithm D.
+// un[0..m+n] holds the dividend shifted left so that vn[n-1] has its top bit
+// set (un[m+n] receives the spilled bits). On return qp[0..m] holds the
+// quotient and un[0..n) holds the normalized remainder. Requires n >= 2.
+inline void divrem_knuth(limb_t* qp, limb_t* un, const limb_t* vn, size_t m, size_t n) {
+    const limb_t v1 = vn[n - 1];
+    const limb_t v2 = vn[n - 2];
+
+    for (size_t j = m + 1; j-- > 0;) {
+        limb_t* uj = un + j;
+
+        // Estimate qhat from the top two limbs of the current window
+        limb_t qhat, rhat;
+        bool rhatOverflow = false;
+        if (uj[n] >= v1) {
+            qhat = ~static_cast<limb_t>(0);
+            dlimb_t r = static_cast<dlimb_t>(uj[n - 1]) + v1;
+            rhat = static_cast<limb_t>(r);
+            rhatOverflow = (r >> 64) != 0;
+        } else {
+            qhat = udiv128(uj[n], uj[n - 1], v1, rhat);
+        }
+
+        // Refine with the third limb; at most two corrections are needed
+        while (!rhatOverflow &&
+               static_cast<dlimb_t>(qhat) * v2 >
+                   ((static_cast<dlimb_t>(rhat) << 64) | uj[n - 2])) {
+            --qhat;
+            dlimb_t r = static_cast<dlimb_t>(rhat) + v1;
+            rhat = static_cast<limb_t>(r);
+            rhatOverflow = (r >> 64) != 0;
+        }
+
+        // Multiply and subtract; qhat is still one too large in rare cases
+        limb_t borrow = submul_1(uj, vn, n, qhat);
+        limb_t top = uj[n];
+        uj[n] = top - borrow;
+        if (top < borrow) {
+            --qhat;
+            uj[n] += add_n(uj, uj, vn, n);
+        }
+
+        qp[j] = qhat;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Multiplication dispatcher: basecase, Karatsuba, Toom-3 and NTT tiers
+// ---------------------------------------------------------------------------
+
+// Crossover points in limbs of the smaller operand
+struct MulThresholds {
+    size_t karatsuba;  // at least 2
+    size_t toom3;      // at least 3
+    size_t ntt;
+};
+
+inline size_t mul_scratch(size_t an, size_t bn, const MulThresholds& t);
+inline void mul(limb_t* rp, const limb_t* up, size_t an, const limb_t* vp, size_t bn, limb_t* tp,
+                const MulThresholds& t);
+
+// rp[0..an+bn) = up * vp with a three-prime number-theoretic transform and
+// CRT recombination. Allocates its own buffers. rp must not overlap either
+// input; up == vp with an == bn is detected and transformed once.
+// Defined in bignum_ntt.cpp.
+void mul_ntt(limb_t* rp, const limb_t* up, size_t an, const limb_t* vp, size_t bn);
+
+// Scratch limbs needed by mul_karatsuba (an >= bn, bn >= t.karatsuba);
+// mirrors the recursion below exactly
+inline size_t mul_karatsuba_scratch(size_t an, size_t bn, const MulThresholds& t) {
+    const size_t l = (an + 1) / 2;
+    if (bn <= l) {
+        // Sliced: one bn x bn chunk product at a time
+        size_t chunk = 2 * bn + mul_scratch(bn, bn, t);
+        size_t tail = an % bn;
+        if (tail) {
+            chunk = std::max(chunk, 2 * bn + mul_scratch(bn, tail, t));
+        }
+        return chunk;
+    }
+    size_t children = std::max(mul_scratch(l, l, t), mul_scratch(an - l, bn - l, t));
+    return 6 * l + 1 + children;
+}
+
+// rp[0..an+bn) = up[0..an) * vp[0..bn) by Karatsuba, requires an >= bn >= 2.
+// With a = a1 * B^l + a0 and b = b1 * B^l + b0, the middle term comes from
+//   a0*b1 + a1*b0 = a0*b0 + a1*b1 - (a0 - a1)(b0 - b1)
+// Operands with bn at most half of an are sliced into bn-limb pieces of up
+// instead, each multiplied as a balanced product. Sub-products go back
+// through mul(). tp needs mul_karatsuba_scratch(an, bn, t) limbs; rp must
+// not overlap anything else.
+inline void mul_karatsuba(limb_t* rp, const limb_t* up, size_t an, const limb_t* vp, size_t bn,
+                          limb_t* tp, const MulThresholds& t) {
+    const size_t l = (an + 1) / 2;
+    if (bn <= l) {
+        limb_t* pp = tp;
+        limb_t* next = pp + 2 * bn;
+        mul(rp, up, bn, vp, bn, next, t);
+        zero(rp + 2 * bn, an - bn);
+        for (size_t i = bn; i < an; i += bn) {
+            size_t cn = std::min(bn, an - i);
+            mul(pp, vp, bn, up + i, cn, next, t);
+            add(rp + i, rp + i, an + bn - i, pp, bn + cn);
+        }
+        return;
+    }
+    
+    const size_t ah = an - l;
+    const size_t bh = bn - l;
+    const limb_t* a0 = up;
+    const limb_t* a1 = up + l;
+    const limb_t* b0 = vp;
+    const limb_t* b1 = vp + l;
+    
+    limb_t* da = tp;           // |a0 - a1|, l limbs
+    limb_t* db = da + l;       // |b0 - b1|, l limbs
+    limb_t* dd = db + l;       // da * db, 2l limbs
+    limb_t* sum = dd + 2 * l;  // a0*b0 + a1*b1, 2l + 1 limbs
+    limb_t* next = sum + 2 * l + 1;
+    
+    // |x0 - x1| over l limbs with x1 zero-extended; returns true when
+    // x0 < x1, in which case the limbs of x0 at and above xh are zero
+    auto absdiff = [l](limb_t* d, const limb_t* x0, const limb_t* x1, size_t xh) {
+        if (cmp(x0, normalizedSize(x0, l), x1, normalizedSize(x1, xh)) >= 0) {
+            sub(d, x0, l, x1, xh);
+            return false;
+        }
+        sub_n(d, x1, x0, xh);
+        zero(d + xh, l - xh);
+        return true;
+    };
+    bool negative = absdiff(da, a0, a1, ah) != absdiff(db, b0, b1, bh);
+    
+    mul(rp, a0, l, b0, l, next, t);
+    mul(rp + 2 * l, a1, ah, b1, bh, next, t);
+    mul(dd, da, l, db, l, next, t);
+    
+    // Middle term, which fits in an + 1 limbs
+    sum[2 * l] = add(sum, rp, 2 * l, rp + 2 * l, ah + bh);
+    if (negative) {
+        add(sum, sum, 2 * l + 1, dd, 2 * l);
+    } else {
+        sub(sum, sum, 2 * l + 1, dd, 2 * l);
+    }
+    add(rp + l, rp + l, an + bn - l, sum, normalizedSize(sum, 2 * l + 1));
+}
+
+// Toom-3 applies when the high third of the shorter operand is non-empty
+inline bool toom3_fits(size_t an, size_t bn) {
+    return bn > 2 * ((an + 2) / 3);
+}
+
+inline size_t mul_toom3_scratch(size_t an, size_t bn, const MulThresholds& t) {
+    const size_t k = (an + 2) / 3;
+    const size_t e = k + 1;
+    size_t children = std::max(mul_scratch(e, e, t),
+                               std::max(mul_scratch(k, k, t), mul_scratch(an - 2 * k, bn - 2 * k, t)));
+    return 6 * e + 6 * e + children;
+}
+
+// Evaluates x0 + x1*X + x2*X^2 at X = 1, -1 and 2 into e = k + 1 limb
+// buffers. sm1 gets |x(-1)|; returns true when x(-1) is negative.
+inline bool toom3_eval(limb_t* s1, limb_t* sm1, limb_t* s2, const limb_t* x0, const limb_t* x1,
+                       const limb_t* x2, size_t k, size_t xh) {
+    const size_t e = k + 1;
+    
+    // s1 = x0 + x2, then sm1 = |s1 - x1| and s1 += x1
+    s1[k] = add(s1, x0, k, x2, xh);
+    bool negative = cmp(s1, normalizedSize(s1, e), x1, normalizedSize(x1, k)) < 0;
+    if (negative) {
+        sub_n(sm1, x1, s1, k);  // s1 < x1 < B^k, so s1[k] is zero
+        sm1[k] = 0;
+    } else {
+        sub(sm1, s1, e, x1, k);
+    }
+    add(s1, s1, e, x1, k);
+    
+    // s2 = x0 + 2 * (x1 + 2 * x2)
+    zero(s2, e);
+    copy(s2, x2, xh);
+    lshift(s2, s2, e, 1);
+    add(s2, s2, e, x1, k);
+    lshift(s2, s2, e, 1);
+    add(s2, s2, e, x0, k);
+    return negative;
+}
+
+// rp[0..an+bn) = up * vp by Toom-Cook 3-way, requires an >= bn and
+// toom3_fits(an, bn). Both operands are split into thirds of k limbs and
+// the five-point product is evaluated at 0, 1, -1, 2 and infinity, then
+// interpolated with Bodrato's sequence, in which every intermediate is
+// non-negative. tp needs mul_toom3_scratch(an, bn, t) limbs.
+inline void mul_toom3(limb_t* rp, const limb_t* up, size_t an, const limb_t* vp, size_t bn,
+                      limb_t* tp, const MulThresholds& t) {
+    const size_t k = (an + 2) / 3;
+    const size_t e = k + 1;
+    const size_t ah = an - 2 * k;
+    const size_t bh = bn - 2 * k;
+    const size_t total = an + bn;
+    
+    limb_t* as1 = tp;
+    limb_t* asm1 = as1 + e;
+    limb_t* as2 = asm1 + e;
+    limb_t* bs1 = as2 + e;
+    limb_t* bsm1 = bs1 + e;
+    limb_t* bs2 = bsm1 + e;
+    limb_t* v1 = bs2 + e;      // 2e limbs each
+    limb_t* vm1 = v1 + 2 * e;
+    limb_t* v2 = vm1 + 2 * e;
+    limb_t* next = v2 + 2 * e;
+    const size_t L = 2 * e;
+    
+    bool vm1_negative = toom3_eval(as1, asm1, as2, up, up + k, up + 2 * k, k, ah) !=
+                        toom3_eval(bs1, bsm1, bs2, vp, vp + k, vp + 2 * k, k, bh);
+    
+    // v0 and vinf go straight to their final places in rp
+    limb_t* v0 = rp;
+    limb_t* vinf = rp + 4 * k;
+    const size_t vinf_n = ah + bh;
+    mul(v0, up, k, vp, k, next, t);
+    mul(vinf, up + 2 * k, ah, vp + 2 * k, bh, next, t);
+    mul(v1, as1, e, bs1, e, next, t);
+    mul(vm1, asm1, e, bsm1, e, next, t);
+    mul(v2, as2, e, bs2, e, next, t);
+    
+    // v2 <- c3' = (v2 - vm1) / 3
+    if (vm1_negative) add_n(v2, v2, vm1, L); else sub_n(v2, v2, vm1, L);
+    divrem_1(v2, v2, L, 3);
+    // vm1 <- c1 + c3 = (v1 - vm1) / 2
+    if (vm1_negative) add_n(vm1, v1, vm1, L); else sub_n(vm1, v1, vm1, L);
+    rshift(vm1, vm1, L, 1);
+    // v1 <- v1 - v0
+    sub(v1, v1, L, v0, 2 * k);
+    // v2 <- c3 = (v2 - v1) / 2 - 2 * vinf
+    sub_n(v2, v2, v1, L);
+    rshift(v2, v2, L, 1);
+    sub(v2, v2, L, vinf, vinf_n);
+    sub(v2, v2, L, vinf, vinf_n);
+    // v1 <- c2 = v1 - (c1 + c3) - vinf
+    sub_n(v1, v1, vm1, L);
+    sub(v1, v1, L, vinf, vinf_n);
+    // vm1 <- c1 = (c1 + c3) - c3
+    sub_n(vm1, vm1, v2, L);
+    
+    // rp = v0 + c1 X + c2 X^2 + c3 X^3 + vinf X^4
+    zero(rp + 2 * k, 2 * k);
+    add(rp + k, rp + k, total - k, vm1, normalizedSize(vm1, L));
+    add(rp + 2 * k, rp + 2 * k, total - 2 * k, v1, normalizedSize(v1, L));
+    add(rp + 3 * k, rp + 3 * k, total - 3 * k, v2, normalizedSize(v2, L));
+}
+
+// Scratch limbs mul() needs for an an x bn product (an >= bn)
+inline size_t mul_scratch(size_t an, size_t bn, const MulThresholds& t) {
+    if (bn >= t.ntt) return 0;
+    if (bn >= t.toom3 && toom3_fits(an, bn)) return mul_toom3_scratch(an, bn, t);
+    if (bn >= t.karatsuba) return mul_karatsuba_scratch(an, bn, t);
+    return 0;
+}
+
+// rp[0..an+bn) = up[0..an) * vp[0..bn), requires an >= bn >= 1, picking the
+// algorithm tier from the size of the shorter operand. tp needs
+// mul_scratch(an, bn, t) limbs; rp must not overlap anything else.
+inline void mul(limb_t* rp, const limb_t* up, size_t an, const limb_t* vp, size_t bn, limb_t* tp,
+                const MulThresholds& t) {
+    if (bn >= t.ntt) {
+        mul_ntt(rp, up, an, vp, bn);
+    } else if (bn >= t.toom3 && toom3_fits(an, bn)) {
+        mul_toom3(rp, up, an, vp, bn, tp, t);
+    } else if (bn >= t.karatsuba) {
+        mul_karatsuba(rp, up, an, vp, bn, tp, t);
+    } else {
+        mul_basecase(rp, up, an, vp, bn);
+    }
+}
+
+} // namespace mpn
+} // namespace bignum
+
+#endif // BIGNUM_MPN_H
@@ -0,0 +1,235 @@
+/**
+ * @file bignum_ntt.cpp
+ * @brief Number-theoretic-transform multiplication for very large operands.
+ *
+ * Each 64-bit limb is one coefficient. The cyclic convolution of the two
+ * limb sequences is computed modulo three NTT-friendly primes just below
+ * 2^62, whose product (about 2^184) exceeds the largest possible
+ * convolution coefficient n * 2^128 for any n below 2^55. The exact
+ * coefficients are rebuilt with Garner's CRT and carried into the result.
+ *
+ * Arithmetic modulo each prime uses 64-bit Montgomery multiplication, so
+ * the butterflies need no hardware division.
+ */
+
+#include "bignum_mpn.h"
+#include <stdexcept>
+#include <vector>
+
+namespace bignum {
+namespace mpn {
+
+namespace {
+
+struct NttPrime {
+    limb_t p;
+    limb_t g;     // primitive root
+    limb_t pinv;  // -p^(-1) mod 2^64
+    limb_t r2;    // 2^128 mod p
+    
+    NttPrime(limb_t prime, limb_t root) : p(prime), g(root) {
+        pinv = 0 - binvert_limb(p);
+        limb_t r = static_cast<limb_t>((static_cast<dlimb_t>(1) << 64) % p);
+        r2 = static_cast<limb_t>(static_cast<dlimb_t>(r) * r % p);
+    }
+    
+    // a * b * 2^(-64) mod p, for any a and b whose product is below p * 2^64
+    limb_t mul(limb_t a, limb_t b) const {
+        dlimb_t t = static_cast<dlimb_t>(a) * b;
+        limb_t m = static_cast<limb_t>(t) * pinv;
+        limb_t u = static_cast<limb_t>((t + static_cast<dlimb_t>(m) * p) >> 64);
+        return reduce(u - p);
+    }
+    
+    // Corrections are branch-free: butterfly operands are random, so a
+    // conditional subtraction would mispredict half the time. Everything
+    // stays below 2^63, so the sign bit flags a value that went negative.
+    limb_t reduce(limb_t x) const { return x + (p & (0 - (x >> 63))); }
+    limb_t add(limb_t a, limb_t b) const { return reduce(a + b - p); }
+    limb_t sub(limb_t a, limb_t b) const { return reduce(a - b); }
+    
+    limb_t toMont(limb_t a) const { return mul(a, r2); }  // any 64-bit a
+    limb_t fromMont(limb_t a) const { return mul(a, 1); }
+    
+    // base^e for base in Montgomery form, result in Montgomery form
+    limb_t pow(limb_t base, limb_t e) const {
+        limb_t result = toMont(1);
+        while (e) {
+            if (e & 1) result = mul(result, base);
+            base = mul(base, base);
+            e >>= 1;
+        }
+        return result;
+    }
+};
+
+// 29 * 2^57 + 1, 69 * 2^55 + 1 and 27 * 2^56 + 1
+const NttPrime& prime(int i) {
+    static const NttPrime primes[3] = {
+        NttPrime(4179340454199820289ULL, 3),
+        NttPrime(2485986994308513793ULL, 5),
+        NttPrime(1945555039024054273ULL, 5),
+    };
+    return primes[i];
+}
+
+const size_t NTT_MAX_LOG2 = 55;  // limited by the smallest two-adic order
+
+// Twiddle factors for every butterfly stage, laid out so each stage reads
+// them contiguously: roots[len + j] = w_2len^j for j < len, where w_2len is
+// a primitive 2len-th root of unity (or its inverse). Montgomery form.
+std::vector<limb_t> rootTable(const NttPrime& P, size_t n, bool inverse) {
+    std::vector<limb_t> roots(n);
+    limb_t w = P.pow(P.toMont(P.g), (P.p - 1) / n);
+    if (inverse) w = P.pow(w, n - 1);
+    
+    // Top stage directly, then each lower stage takes every other entry
+    const size_t half = n / 2;
+    limb_t x = P.toMont(1);
+    for (size_t j = 0; j < half; ++j) {
+        roots[half + j] = x;
+        x = P.mul(x, w);
+    }
+    for (size_t len = half / 2; len >= 1; len /= 2) {
+        for (size_t j = 0; j < len; ++j) {
+            roots[len + j] = roots[2 * len + 2 * j];
+        }
+    }
+    return roots;
+}
+
+// Decimation in frequency: natural order in, bit-reversed order out
+void forward(std::vector<limb_t>& a, const NttPrime& P, const std::vector<limb_t>& roots) {
+    const size_t n = a.size();
+    for (size_t len = n / 2; len >= 1; len /= 2) {
+        const limb_t* w = roots.data() + len;
+        for (size_t i = 0; i < n; i += 2 * len) {
+            limb_t* x = a.data() + i;
+            limb_t* y = x + len;
+            for (size_t j = 0; j < len; ++j) {
+                limb_t u = x[j];
+                limb_t v = y[j];
+                x[j] = P.add(u, v);
+                y[j] = P.mul(P.sub(u, v), w[j]);
+            }
+        }
+    }
+}
+
+// Decimation in time with inverse roots: bit-reversed order in, natural
+// order out, still scaled by n
+void inverse(std::vector<limb_t>& a, const NttPrime& P, const std::vector<limb_t>& roots) {
+    const size_t n = a.size();
+    for (size_t len = 1; len < n; len *= 2) {
+        const limb_t* w = roots.data() + len;
+        for (size_t i = 0; i < n; i += 2 * len) {
+            limb_t* x = a.data() + i;
+            limb_t* y = x + len;
+            for (size_t j = 0; j < len; ++j) {
+                limb_t u = x[j];
+                limb_t v = P.mul(y[j], w[j]);
+                x[j] = P.add(u, v);
+                y[j] = P.sub(u, v);
+            }
+        }
+    }
+}
+
+// Cyclic convolution of up and vp modulo one prime, length n, result out
+// of Montgomery form
+std::vector<limb_t> convolve(const NttPrime& P, const limb_t* up, size_t an, const limb_t* vp,
+                             size_t bn, size_t n, bool square) {
+    std::vector<limb_t> fa(n, 0);
+    for (size_t i = 0; i < an; ++i) fa[i] = P.toMont(up[i]);
+    
+    auto fwd = rootTable(P, n, false);
+    forward(fa, P, fwd);
+    if (square) {
+        for (size_t i = 0; i < n; ++i) fa[i] = P.mul(fa[i], fa[i]);
+    } else {
+        std::vector<limb_t> fb(n, 0);
+        for (size_t i = 0; i < bn; ++i) fb[i] = P.toMont(vp[i]);
+        forward(fb, P, fwd);
+        for (size_t i = 0; i < n; ++i) fa[i] = P.mul(fa[i], fb[i]);
+    }
+    fwd.clear();
+    fwd.shrink_to_fit();
+    inverse(fa, P, rootTable(P, n, true));
+    
+    // Undo the Montgomery factor and the 1/n scaling in one multiplication:
+    // fromMont(x * n^-1) with n^-1 in Montgomery form
+    limb_t ninv = P.pow(P.toMont(n % P.p), P.p - 2);
+    for (size_t i = 0; i < n; ++i) fa[i] = P.fromMont(P.mul(fa[i], ninv));
+    return fa;
+}
+
+}  // namespace
+
+void mul_ntt(limb_t* rp, const limb_t* up, size_t an, const limb_t* vp, size_t bn) {
+    const size_t total = an + bn;
+    size_t log2n = 0;
+    while ((size_t(1) << log2n) < total) ++log2n;
+    if (log2n > NTT_MAX_LOG2) {
+        throw std::length_error("Operands too large for NTT multiplication");
+    }
+    const size_t n = size_t(1) << log2n;
+    const bool square = up == vp && an == bn;
+    
+    const NttPrime& P1 = prime(0);
+    const NttPrime& P2 = prime(1);
+    const NttPrime& P3 = prime(2);
+    std::vector<limb_t> r1 = convolve(P1, up, an, vp, bn, n, square);
+    std::vector<limb_t> r2 = convolve(P2, up, an, vp, bn, n, square);
+    std::vector<limb_t> r3 = convolve(P3, up, an, vp, bn, n, square);
+    
+    // Garner constants in Montgomery form: p1^-1 mod p2, p1 mod p3 and
+    // (p1 * p2)^-1 mod p3. A Montgomery product with a constant c * R
+    // yields the plain product, so no conversions are needed per limb.
+    const limb_t p1 = P1.p, p2 = P2.p, p3 = P3.p;
+    const limb_t inv_p1 = P2.pow(P2.toMont(p1), p2 - 2);
+    const limb_t p1_mod_p3 = P3.toMont(p1);
+    const limb_t inv_p12 = P3.pow(P3.mul(P3.toMont(p1), P3.toMont(p2)), p3 - 2);
+    const dlimb_t p12 = static_cast<dlimb_t>(p1) * p2;
+    const limb_t p12_lo = static_cast<limb_t>(p12);
+    const limb_t p12_hi = static_cast<limb_t>(p12 >> 64);
+    
+    // x = r1 + p1 * t2 + p1 * p2 * t3, carried into rp as it is produced
+    limb_t c0 = 0, c1 = 0, c2 = 0;
+    for (size_t i = 0; i < total; ++i) {
+        limb_t x0 = 0, x1 = 0, x2 = 0;
+        if (i + 1 < total) {
+            // r1 < p1, which is below 2 * p2 and 3 * p3
+            limb_t a = r1[i];
+            limb_t a2 = a >= p2 ? a - p2 : a;
+            limb_t t2 = P2.mul(P2.sub(r2[i], a2), inv_p1);
+            dlimb_t x = a + static_cast<dlimb_t>(p1) * t2;  // below p1 * p2
+            
+            // x mod p3 = a + p1 * t2 mod p3
+            limb_t a3 = a;
+            while (a3 >= p3) a3 -= p3;
+            limb_t xm = P3.add(a3, P3.mul(t2, p1_mod_p3));
+            limb_t t3 = P3.mul(P3.sub(r3[i], xm), inv_p12);
+            
+            // (x2:x1:x0) = x + (p12_hi:p12_lo) * t3
+            dlimb_t lo = static_cast<dlimb_t>(p12_lo) * t3;
+            dlimb_t hi = static_cast<dlimb_t>(p12_hi) * t3;
+            dlimb_t s = static_cast<dlimb_t>(static_cast<limb_t>(lo)) + static_cast<limb_t>(x);
+            x0 = static_cast<limb_t>(s);
+            s = (s >> 64) + static_cast<limb_t>(lo >> 64) + static_cast<limb_t>(hi) +
+                static_cast<limb_t>(x >> 64);
+            x1 = static_cast<limb_t>(s);
+            x2 = static_cast<limb_t>(s >> 64) + static_cast<limb_t>(hi >> 64);
+        }
+        
+        dlimb_t s = static_cast<dlimb_t>(c0) + x0;
+        rp[i] = static_cast<limb_t>(s);
+        s = (s >> 64) + c1 + x1;
+        c0 = static_cast<limb_t>(s);
+        s = (s >> 64) + c2 + x2;
+        c1 = static_cast<limb_t>(s);
+        c2 = static_cast<limb_t>(s >> 64);
+    }
+}
+
+} // namespace mpn
+} // namespace bignum
@@ -0,0 +1,177 @@
+/**
+ * @file bignum_thread_pool.cpp
+ * @brief Work-stealing thread pool used by the BigNum batch APIs.
+ */
+
+#include "bignum_thread_pool.h"
+#include "bignum.h"
+#include <algorithm>
+#include <exception>
+#include <system_error>
+
+namespace bignum {
+
+ThreadPool::ThreadPool(size_t workers) {
+    for (size_t i = 0; i < workers; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workers; ++i) {
+        try {
+            threads.emplace_back(&ThreadPool::workerLoop, this, i);
+        } catch (const std::system_error&) {
+            // No (more) threads on this platform; queues without a worker
+            // never receive tasks
+            break;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void ThreadPool::push(size_t queue, Task task) {
+    {
+        std::lock_guard<std::mutex> guard(queues[queue]->lock);
+        queues[queue]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    // Taking the sleep lock orders the increment against a worker that is
+    // about to wait, so the wakeup cannot be lost
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wake.notify_one();
+}
+
+bool ThreadPool::pop(size_t self, Task& task) {
+    const size_t n = queues.size();
+    if (self < n) {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    // Steal the oldest task of another queue; the caller of parallelFor
+    // (self == n) scans all of them
+    for (size_t k = 1; k <= n; ++k) {
+        Queue& victim = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    for (;;) {
+        Task task;
+        if (pop(self, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t)>& body,
+                             const std::atomic<bool>* cancel) {
+    if (n == 0) return;
+    auto cancelled = [cancel]() { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    const size_t workers = threads.size();
+    if (workers == 0 || n == 1) {
+        std::exception_ptr error;
+        for (size_t i = 0; i < n && !cancelled(); ++i) {
+            try {
+                body(i);
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+        return;
+    }
+
+    // A few chunks per thread so stealing can even out uneven items
+    struct Batch {
+        std::mutex lock;
+        std::condition_variable done;
+        size_t remaining;
+        std::exception_ptr error;
+    } batch;
+    const size_t chunks = std::min(n, concurrency() * 4);
+    batch.remaining = chunks;
+
+    // Chunks run under the caller's cancellation guards, whichever thread
+    // picks them up; a caller helping out with another batch's chunk runs
+    // it under that batch's guards instead of its own
+    BigNum::CancelScope* scope = BigNum::CancelScope::active();
+    const size_t first = nextQueue.fetch_add(1);
+    for (size_t c = 0; c < chunks; ++c) {
+        const size_t begin = c * n / chunks;
+        const size_t end = (c + 1) * n / chunks;
+        push((first + c) % workers, [&batch, &body, &cancelled, scope, begin, end]() {
+            BigNum::CancelScope*& active = BigNum::CancelScope::active();
+            BigNum::CancelScope* own = active;
+            active = scope;
+            std::exception_ptr error;
+            for (size_t i = begin; i < end && !cancelled(); ++i) {
+                try {
+                    body(i);
+                } catch (...) {
+                    if (!error) error = std::current_exception();
+                }
+            }
+            active = own;
+            std::lock_guard<std::mutex> guard(batch.lock);
+            if (error && !batch.error) batch.error = error;
+            if (--batch.remaining == 0) batch.done.notify_all();
+        });
+    }
+
+    // Help out until every chunk has run; tasks are only ever taken by the
+    // thread that runs them, so once none are left to steal the remaining
+    // ones are already in progress elsewhere
+    for (;;) {
+        Task task;
+        if (pop(queues.size(), task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(batch.lock);
+        batch.done.wait(guard, [&batch]() { return batch.remaining == 0; });
+        break;
+    }
+
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::shared() {
+    static std::mutex lock;
+    static std::shared_ptr<ThreadPool> pool;
+    static size_t poolThreads = 0;
+
+    const size_t wanted = BigNum::threadCount();
+    std::lock_guard<std::mutex> guard(lock);
+    if (!pool || poolThreads != wanted) {
+        pool = std::make_shared<ThreadPool>(wanted - 1);
+        poolThreads = wanted;
+    }
+    return pool;
+}
+
+}  // namespace bignum
@@ -0,0 +1,78 @@
+/**
+ * @file bignum_thread_pool.h
+ * @brief Internal work-stealing thread pool behind the batch APIs.
+ *
+ * Every worker owns a deque of tasks. It pops its own work from the back
+ * and, once that runs dry, steals from the front of the other workers'
+ * deques, so uneven items (a 4096-bit modPow next to a 1024-bit one) do not
+ * leave cores idle. The thread that calls parallelFor works through the
+ * same queues while it waits, which keeps nested parallelFor calls from
+ * deadlocking.
+ *
+ * This header is private to the library and is not installed.
+ */
+
+#ifndef BIGNUM_THREAD_POOL_H
+#define BIGNUM_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bignum {
+
+class ThreadPool {
+public:
+    // Starts `workers` background threads. Platforms without thread support
+    // (wasm builds without pthreads) end up with fewer, possibly none, and
+    // parallelFor then runs on the calling thread alone.
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that execute a parallelFor, the caller included
+    size_t concurrency() const { return threads.size() + 1; }
+
+    // Runs body(i) for every i in [0, n) and returns once all have finished.
+    // The first exception thrown by body is rethrown here after the other
+    // items have completed. Once *cancel becomes true, items that have not
+    // started yet are skipped; running ones finish (or poll the flag).
+    void parallelFor(size_t n, const std::function<void(size_t)>& body,
+                     const std::atomic<bool>* cancel = nullptr);
+
+    // Process-wide pool sized by BigNum::threadCount(). A pool replaced by a
+    // later setThreadCount stays alive until its last user lets go.
+    static std::shared_ptr<ThreadPool> shared();
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    void push(size_t queue, Task task);
+    bool pop(size_t self, Task& task);
+    void workerLoop(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues;  // one per worker
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextQueue{0};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+}  // namespace bignum
+
+#endif  // BIGNUM_THREAD_POOL_H
@@ -1,9 +1,15 @@
 #include "bignum.h"
+#include "bignum_expr.h"
+#include "bignum_fixed.h"
+#include <atomic>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <stdexcept>
 #include <iomanip>
 #include <chrono>
+#include <thread>
+#include <functional>
 #include <map>
 #include <string>
 #include <cassert>
@@ -199,6 +205,69 @@ void test_basic_constructors() {
         BigNum copy(original);
         test_suite.assert_equals(original.toHexString(), copy.toHexString(), "Copy should equal original");
     });
+    
+    test_suite.test("Small values use inline storage", []() {
+        test_suite.assert_true(BigNum::one().getDigits().isInline(), "one() should not allocate");
+        BigNum small = BigNum::random(64 * LimbVector::INLINE_CAPACITY);
+        test_suite.assert_true(small.getDigits().isInline(), "Values up to the inline capacity stay inline");
+        BigNum large = small << 64;
+        test_suite.assert_true(!large.getDigits().isInline(), "Larger values spill to the heap");
+        test_suite.assert_equals(small.toHexString(), (large >> 64).toHexString(), "Spilled value round-trips");
+    });
+    
+    test_suite.test("Move leaves source as zero", []() {
+        BigNum large = BigNum::random(1024);
+        std::string hex = large.toHexString();
+        BigNum moved(std::move(large));
+        test_suite.assert_equals(hex, moved.toHexString(), "Moved-to value");
+        test_suite.assert_true(large.isZero(), "Moved-from value should be zero");
+        
+        BigNum small(77);
+        BigNum target;
+        target = std::move(small);
+        test_suite.assert_equals("4d", target.toHexString(), "Move-assigned inline value");
+        test_suite.assert_true(small.isZero(), "Moved-from inline value should be zero");
+    });
+    
+    test_suite.test("ScopedArena serves and outlives temporaries", []() {
+        BigNum a = BigNum::random(2048), b = BigNum::random(1500) | BigNum(1);
+        BigNum m = BigNum::random(1024) | BigNum(1);
+        BigNum product = a * b, quotient = a / b, power = a.modPow(b, m);
+        auto xgcd = a.extendedGcd(b);
+        
+        BigNum escaped, fromThread;
+        std::thread worker;
+        {
+            BigNum::ScopedArena arena;
+            test_suite.assert_true(arena.reservedBytes() == 0 || arena.reservedBytes() >= BigNum::ScopedArena::DEFAULT_CHUNK_BYTES,
+                                   "Chunks are whole");
+            test_suite.assert_true(a * b == product && a / b == quotient, "Arithmetic inside the arena");
+            test_suite.assert_true(a.modPow(b, m) == power && a.extendedGcd(b) == xgcd, "modPow and extendedGcd inside the arena");
+            {
+                BigNum::ScopedArena inner(4096);
+                BigNum big = BigNum::random(100000);  // larger than a chunk
+                test_suite.assert_true(inner.reservedBytes() >= big.getDigits().size() * sizeof(uint64_t), "Oversized buffer gets a chunk");
+                test_suite.assert_true((big * b) / b == big, "Nested arena");
+            }
+            escaped = a * b;
+            // Freed on another thread after the arena has gone
+            BigNum handOff = a * a;
+            worker = std::thread([v = std::move(handOff), &fromThread]() mutable {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                fromThread = v + BigNum(1);
+            });
+        }
+        worker.join();
+        test_suite.assert_true(escaped == product, "A value leaving the scope stays valid");
+        test_suite.assert_true(fromThread == a * a + BigNum(1), "Released from another thread");
+        
+        // A fresh guard reuses the cached chunk for the same workload
+        for (int i = 0; i < 3; ++i) {
+            BigNum::ScopedArena arena;
+            test_suite.assert_true(a.modPow(b, m) == power, "Repeated scopes");
+            test_suite.assert_true(arena.reservedBytes() <= 2 * BigNum::ScopedArena::DEFAULT_CHUNK_BYTES, "Temporaries recycle chunk space");
+        }
+    });
 }
 
 void test_hex_conversions() {
@@ -235,6 +304,52 @@ void test_hex_conversions() {
         BigNum h = BigNum::fromHexString("a");
         test_suite.assert_equals("a", h.toHexString(), "Single digit");
     });
+    
+    test_suite.test("Decimal parsing and printing", []() {
+        BigNum d = BigNum::fromDecimalString("18446744073709551616");  // 2^64
+        test_suite.assert_equals("10000000000000000", d.toHexString(), "2^64 from decimal");
+        test_suite.assert_equals("18446744073709551616", d.toDecimalString(), "2^64 to decimal");
+        test_suite.assert_equals("10000000000000000000", BigNum::fromDecimalString("10000000000000000000").toDecimalString(),
+                                 "10^19 roundtrip");
+        test_suite.assert_equals("42", BigNum::fromDecimalString("00042").toDecimalString(), "Leading zeros");
+    });
+    
+    test_suite.test("Negative and zero decimal", []() {
+        test_suite.assert_equals("0", BigNum().toDecimalString(), "Zero");
+        test_suite.assert_equals("-17", BigNum(-17).toDecimalString(), "Negative");
+        BigNum z = BigNum::fromDecimalString("-0");
+        test_suite.assert_true(!z.isNegative(), "Negative zero normalizes");
+        
+        bool threw = false;
+        try {
+            BigNum::fromDecimalString("12a4");
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Non-digit characters should be rejected");
+    });
+    
+    test_suite.test("Divide-and-conquer decimal matches basecase", []() {
+        const BigNumTuning saved = BigNum::tuning();
+        BigNumTuning basecase = saved, recursive = saved;
+        basecase.decimal_threshold = static_cast<size_t>(-1);
+        recursive.decimal_threshold = 2;
+        
+        std::vector<BigNum> values = {BigNum::random(5000), -BigNum::random(12345)};
+        // A power of ten and its predecessor stress the zero padding between chunks
+        values.push_back(BigNum::fromDecimalString("1" + std::string(1000, '0')));
+        values.push_back(values.back() - BigNum(1));
+        for (const BigNum& v : values) {
+            BigNum::setTuning(basecase);
+            std::string expected = v.toDecimalString();
+            BigNum::setTuning(recursive);
+            std::string got = v.toDecimalString();
+            BigNum parsed = BigNum::fromDecimalString(expected);
+            BigNum::setTuning(saved);
+            test_suite.assert_equals(expected, got, "Decimal string");
+            test_suite.assert_true(parsed == v, "Decimal parse roundtrip");
+        }
+    });
 }
 
 void test_basic_arithmetic() {
@@ -312,6 +427,272 @@ void test_basic_arithmetic() {
         BigNum c = a * b;
         test_suite.assert_equals("c379aaaa375de7", c.toHexString(), "Large multiplication");
     });
+    
+    test_suite.test("Borrow across all-ones limbs", []() {
+        BigNum a = BigNum::fromHexString("3ffffffffffffffffffffffffffffffffff");
+        BigNum b = BigNum::fromHexString("3a0315be13941da44f23096ea8aee5b3b76e1dc2e220eb0b");
+        test_suite.assert_equals("-3a0315be139419a44f23096ea8aee5b3b76e1dc2e220eb0c", (a - b).toHexString(), "a - b");
+        test_suite.assert_equals(a.toHexString(), ((a - b) + b).toHexString(), "(a - b) + b");
+    });
+    
+    test_suite.test("Compound assignment with aliasing", []() {
+        BigNum a = BigNum::fromHexString("ffffffffffffffffffffffffffffffff");
+        a += a;
+        test_suite.assert_equals("1fffffffffffffffffffffffffffffffe", a.toHexString(), "a += a");
+        a -= a;
+        test_suite.assert_true(a.isZero() && !a.isNegative(), "a -= a should be zero");
+        
+        BigNum b(-5);
+        b += BigNum(12);
+        test_suite.assert_equals("7", b.toHexString(), "-5 += 12");
+        b -= BigNum(20);
+        test_suite.assert_equals("-d", b.toHexString(), "7 -= 20");
+    });
+    
+    test_suite.test("In-place shifts", []() {
+        BigNum a = BigNum::fromHexString("123456789abcdef0123456789abcdef");
+        a <<= 68;
+        test_suite.assert_equals("123456789abcdef0123456789abcdef00000000000000000", a.toHexString(), "<<= 68");
+        a >>= 72;
+        test_suite.assert_equals("123456789abcdef0123456789abcde", a.toHexString(), ">>= 72");
+        a >>= 1000;
+        test_suite.assert_true(a.isZero(), "Shifting out every bit gives zero");
+    });
+    
+    test_suite.test("Karatsuba-sized multiplication", []() {
+        for (int i = 0; i < 10; ++i) {
+            BigNum a = BigNum::random(1024 + i * 97);
+            BigNum b = BigNum::random(900 + i * 131);
+            BigNum c = a * b;
+            test_suite.assert_true((c % b).isZero(), "Product should be divisible by b");
+            test_suite.assert_equals(a.toHexString(), (c / b).toHexString(), "(a * b) / b");
+        }
+    });
+    
+    test_suite.test("Squaring matches multiplication", []() {
+        // Covers the basecase, odd and even Karatsuba splits, and all-ones
+        // limbs that push every carry chain to its limit
+        for (size_t limbs = 1; limbs <= 70; limbs += 3) {
+            BigNum a = BigNum::random(limbs * 64);
+            BigNum ones = (BigNum(1) << static_cast<int>(limbs * 64)) - BigNum(1);
+            for (const BigNum& x : {a, ones, -a}) {
+                BigNum copy = x;
+                test_suite.assert_equals((x * copy).toHexString(), x.square().toHexString(), "x.square() == x * x");
+            }
+        }
+    });
+    
+    test_suite.test("Integer power", []() {
+        for (const BigNum& base : {BigNum(3), BigNum(-7), BigNum(12), BigNum::random(200), -(BigNum::random(90) << 70)}) {
+            BigNum expected(1);
+            for (uint64_t e = 0; e <= 21; ++e) {
+                test_suite.assert_equals(expected.toHexString(), base.pow(e).toHexString(), "pow matches repeated multiplication");
+                expected *= base;
+            }
+        }
+        test_suite.assert_true(BigNum(0).pow(0).isOne() && BigNum(0).pow(5).isZero(), "Zero base");
+        test_suite.assert_true(BigNum(-1).pow(UINT64_MAX) == BigNum(-1) && BigNum(1).pow(UINT64_MAX).isOne(), "Unit bases take any exponent");
+        test_suite.assert_true(BigNum(2).pow(1000) == BigNum(1) << 1000, "Power of two is a shift");
+        test_suite.assert_equals("515377520732011331036461129765621272702107522001", BigNum(3).pow(100).toDecimalString(), "3^100");
+        
+        bool threw = false;
+        try {
+            BigNum(3).pow(uint64_t(1) << 40);
+        } catch (const std::overflow_error&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Unrepresentable power throws");
+    });
+    
+    test_suite.test("Karatsuba matches schoolbook for unbalanced sizes", []() {
+        const BigNumTuning saved = BigNum::tuning();
+        BigNumTuning basecase = saved, karatsuba = saved;
+        basecase.karatsuba_threshold = basecase.karatsuba_sqr_threshold = static_cast<size_t>(-1);
+        karatsuba.karatsuba_threshold = karatsuba.karatsuba_sqr_threshold = 2;
+        
+        for (size_t an : {2, 3, 7, 16, 33, 64}) {
+            for (size_t bn : {1, 2, 5, 17, 40, 100}) {
+                BigNum a = BigNum::random(an * 64);
+                BigNum b = BigNum::random(bn * 64);
+                BigNum::setTuning(basecase);
+                std::string expected = (a * b).toHexString();
+                std::string expected_sqr = a.square().toHexString();
+                BigNum::setTuning(karatsuba);
+                std::string got = (a * b).toHexString();
+                std::string got_sqr = a.square().toHexString();
+                BigNum::setTuning(saved);
+                test_suite.assert_equals(expected, got, "Karatsuba product");
+                test_suite.assert_equals(expected_sqr, got_sqr, "Karatsuba square");
+            }
+        }
+        
+        bool threw = false;
+        try {
+            BigNumTuning bad;
+            bad.karatsuba_threshold = 1;
+            BigNum::setTuning(bad);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "A Karatsuba threshold below 2 should be rejected");
+    });
+    
+    test_suite.test("Tuning profiles", []() {
+        const BigNumTuning saved = BigNum::tuning();
+        BigNumTuning t;
+        t.karatsuba_threshold = 31;
+        t.ntt_threshold = 12345;
+        BigNumTuning parsed = BigNum::parseTuning(BigNum::formatTuning(t));
+        test_suite.assert_equals(BigNum::formatTuning(t), BigNum::formatTuning(parsed), "Round trip");
+        
+        parsed = BigNum::parseTuning("# generated\n  toom3_threshold = 200  # comment\n\n");
+        test_suite.assert_true(parsed.toom3_threshold == 200, "Field with comments and spacing");
+        test_suite.assert_true(parsed.karatsuba_threshold == BigNumTuning().karatsuba_threshold,
+                               "Missing fields keep their defaults");
+        
+        for (const char* bad : {"fast_threshold = 3", "karatsuba_threshold = -1", "karatsuba_threshold", "ntt_threshold = 1e3"}) {
+            bool threw = false;
+            try {
+                BigNum::parseTuning(bad);
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            test_suite.assert_true(threw, std::string("Rejected: ") + bad);
+        }
+        
+        bool threw = false;
+        try {
+            BigNum::loadTuning("/nonexistent/bignum.tuning");
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Unreadable profile should throw");
+        test_suite.assert_equals(BigNum::formatTuning(saved), BigNum::formatTuning(BigNum::tuning()),
+                                 "Failed loads leave the tuning alone");
+    });
+    
+    test_suite.test("Operation counters", []() {
+        BigNum::resetStats();
+        BigNum odd = BigNum::random(512) | BigNum(1), even = BigNum::random(1024) << 1;
+        BigNum big = BigNum::random(64 * 400);
+        BigNum a = BigNum::random(200);
+        a.modPow(BigNum(65537), odd);
+        a.modPow(BigNum(65537), even);
+        BigNum product = big * BigNum::random(64 * 400) + big.square();
+        std::string dec = big.toDecimalString();
+        
+        BigNumStats s = BigNum::stats();
+        auto calls = [&s](BigNumStats::Op op) { return s.ops[op].calls; };
+        if (!s.enabled) {
+            test_suite.assert_true(calls(BigNumStats::ModPowMontgomery) == 0 && s.heap_bytes == 0,
+                                   "Disabled counters stay zero");
+            test_suite.assert_equals(std::string("{\"enabled\": false, \"ops\": {}"), s.toJson().substr(0, 28), "JSON");
+            return;
+        }
+        test_suite.assert_true(calls(BigNumStats::ModPowMontgomery) == 1 && calls(BigNumStats::MontgomeryContext) == 1,
+                               "Odd modulus takes the Montgomery path");
+        test_suite.assert_true(calls(BigNumStats::ModPowBarrett) == 1 && calls(BigNumStats::BarrettContext) == 1,
+                               "Even modulus takes the Barrett path");
+        test_suite.assert_true(s.ops[BigNumStats::ModPowMontgomery].limbs[3] == 1, "512-bit modulus in the 8-15 limb bucket");
+        test_suite.assert_true(calls(BigNumStats::MulToom3) >= 1 && calls(BigNumStats::SqrLarge) >= 1, "Tiers by size");
+        test_suite.assert_true(calls(BigNumStats::ToDecimal) == 1 && s.ops[BigNumStats::ToDecimal].nanoseconds > 0, "Timed");
+        test_suite.assert_true(s.heap_allocations > 0 && s.heap_bytes >= 400 * 8 && s.peak_live_bytes >= s.live_bytes,
+                               "Allocations");
+        {
+            BigNum::ScopedArena arena;
+            BigNum t = big + big;
+        }
+        test_suite.assert_true(BigNum::stats().arena_allocations > s.arena_allocations, "Arena allocations");
+        test_suite.assert_true(s.toJson().find("\"modpow_barrett\": {\"calls\": 1") != std::string::npos, "JSON");
+        BigNum::resetStats();
+        test_suite.assert_true(BigNum::stats().ops[BigNumStats::ModPowMontgomery].calls == 0, "Reset");
+    });
+    
+    test_suite.test("Fused multiply-accumulate and mulmod", []() {
+        auto signedRandom = [](size_t bits, int i) {
+            BigNum x = BigNum::random(bits);
+            return i % 2 ? -x : x;
+        };
+        // Row accumulation, the Karatsuba scratch path and mixed signs; a
+        // small accumulator against a large product exercises the borrow
+        for (size_t zbits : {0, 64, 300, 5000}) {
+            for (size_t abits : {64, 200, 3000}) {
+                for (int i = 0; i < 8; ++i) {
+                    BigNum z = signedRandom(zbits, i), a = signedRandom(abits, i >> 1), b = signedRandom(abits / 2 + 7, i >> 2);
+                    BigNum m = signedRandom(abits / 3 + 70, i) + BigNum(1);
+                    BigNum r = z;
+                    test_suite.assert_true(r.addMul(a, b) == z + a * b, "addMul");
+                    r = z;
+                    test_suite.assert_true(r.subMul(a, b) == z - a * b, "subMul");
+                    test_suite.assert_true(BigNum::mulMod(a, b, m) == (a * b) % m, "mulMod");
+                    test_suite.assert_true(BigNum::mulMod(a, a, m) == (a * a) % m, "mulMod square");
+                    
+                    BigNum fused = lazy(z) + lazy(a) * b;
+                    test_suite.assert_true(fused == z + a * b, "lazy Z + X*Y");
+                    fused = lazy(a) * b - z;
+                    test_suite.assert_true(fused == a * b - z, "lazy X*Y - Z");
+                    fused = (lazy(a) * b + z) % m;
+                    test_suite.assert_true(fused == (a * b + z) % m, "lazy (X*Y + Z) % M");
+                    r = z;
+                    r -= lazy(a) * b;
+                    test_suite.assert_true(r == z - a * b, "lazy -=");
+                }
+            }
+        }
+        
+        // Aliasing the accumulator, and Horner's rule as a chain of fused steps
+        BigNum x = BigNum::random(500);
+        BigNum r = x;
+        r.addMul(r, r);
+        test_suite.assert_true(r == x + x * x, "addMul aliasing *this");
+        std::vector<BigNum> coeffs;
+        for (int i = 0; i < 12; ++i) coeffs.push_back(signedRandom(256, i));
+        BigNum horner, plain;
+        for (const BigNum& c : coeffs) {
+            horner = lazy(c) + lazy(horner) * x;
+            plain = plain * x + c;
+        }
+        test_suite.assert_true(horner == plain, "Horner evaluation");
+        
+        bool threw = false;
+        try {
+            BigNum::mulMod(x, x, BigNum(0));
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "mulMod by zero should throw");
+    });
+    
+    test_suite.test("Toom-3 and NTT match schoolbook", []() {
+        const BigNumTuning saved = BigNum::tuning();
+        const size_t never = static_cast<size_t>(-1);
+        BigNumTuning basecase = saved, toom3 = saved, ntt = saved;
+        basecase.karatsuba_threshold = basecase.karatsuba_sqr_threshold = never;
+        basecase.toom3_threshold = basecase.ntt_threshold = never;
+        toom3.karatsuba_threshold = toom3.karatsuba_sqr_threshold = 2;
+        toom3.toom3_threshold = 3;
+        toom3.ntt_threshold = never;
+        ntt.ntt_threshold = 1;
+        
+        for (size_t an : {3, 10, 31, 100, 257}) {
+            for (size_t bn : {1, 3, 8, 30, 99, 200}) {
+                BigNum a = BigNum::random(an * 64);
+                BigNum b = (BigNum(1) << static_cast<int>(bn * 64)) - BigNum(1);  // all-ones limbs
+                BigNum::setTuning(basecase);
+                std::string expected = (a * b).toHexString();
+                std::string expected_sqr = a.square().toHexString();
+                for (const BigNumTuning& t : {toom3, ntt}) {
+                    BigNum::setTuning(t);
+                    std::string got = (a * b).toHexString();
+                    std::string got_sqr = a.square().toHexString();
+                    BigNum::setTuning(saved);
+                    test_suite.assert_equals(expected, got, "Product");
+                    test_suite.assert_equals(expected_sqr, got_sqr, "Square");
+                }
+            }
+        }
+        BigNum::setTuning(saved);
+    });
 }
 
 void test_division_modulo() {
@@ -362,6 +743,53 @@ void test_division_modulo() {
         BigNum q = a / b;
         test_suite.assert_equals("123456", q.toHexString(), "Division by 256");
     });
+    
+    test_suite.test("Single-limb divisor above INT64_MAX", []() {
+        BigNum a = BigNum::fromHexString("123456789abcdef0fedcba9876543210aaaaaaaaaaaaaaaa");
+        BigNum b = BigNum::fromHexString("fffffffffffffffb");
+        BigNum q = a / b;
+        BigNum r = a % b;
+        test_suite.assert_true(r < b, "Remainder should be below the divisor");
+        test_suite.assert_equals(a.toHexString(), (q * b + r).toHexString(), "a = q*b + r");
+    });
+    
+    test_suite.test("Multi-limb division with qhat correction", []() {
+        // Operands with all-ones and top-bit-only limbs exercise the qhat
+        // refinement and the add-back step of Algorithm D
+        std::vector<std::pair<std::string, std::string>> cases = {
+            {"7fffffffffffffff800000000000000000000000000000000000000000000000", "800000000000000000000000000000000000000000000001"},
+            {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", "ffffffffffffffffffffffffffffffff"},
+            {"8000000000000000fffffffffffffffe0000000000000000", "8000000000000000ffffffffffffffff"},
+            {"1000000000000000000000000000000000000000000000000", "10000000000000001"},
+        };
+        for (const auto& [x, y] : cases) {
+            BigNum a = BigNum::fromHexString(x);
+            BigNum b = BigNum::fromHexString(y);
+            BigNum q = a / b;
+            BigNum r = a % b;
+            test_suite.assert_true(r < b, "Remainder should be below the divisor");
+            test_suite.assert_equals(a.toHexString(), (q * b + r).toHexString(), x + " / " + y);
+        }
+    });
+    
+    test_suite.test("Random multi-limb division", []() {
+        for (int i = 0; i < 50; ++i) {
+            BigNum a = BigNum::random(2048 + i * 7);
+            BigNum b = BigNum::random(64 + i * 37);
+            BigNum q = a / b;
+            BigNum r = a % b;
+            test_suite.assert_true(r < b, "Remainder should be below the divisor");
+            test_suite.assert_equals(a.toHexString(), (q * b + r).toHexString(), "a = q*b + r");
+        }
+    });
+    
+    test_suite.test("Signed division truncates toward zero", []() {
+        BigNum a(-100), b(30);
+        test_suite.assert_equals("-3", (a / b).toHexString(), "-100 / 30");
+        test_suite.assert_equals("-a", (a % b).toHexString(), "-100 % 30");
+        test_suite.assert_equals("-3", (BigNum(100) / BigNum(-30)).toHexString(), "100 / -30");
+        test_suite.assert_equals("a", (BigNum(100) % BigNum(-30)).toHexString(), "100 % -30");
+    });
 }
 
 void test_bit_operations() {
@@ -451,7 +879,60 @@ void test_cryptographic_operations() {
         BigNum check = (BigNum(7) * inv) % BigNum(26);
         test_suite.assert_equals("1", check.toHexString(), "Larger inverse verification");
     });
-    
+
+    test_suite.test("Extended GCD of multi-limb values", []() {
+        // Lehmer steps on the leading words, with a shared factor and a
+        // much shorter second operand
+        BigNum common = BigNum::random(300);
+        BigNum a = BigNum::random(2000) * common;
+        for (const BigNum& b : {BigNum::random(1900) * common, -BigNum::random(120), BigNum(1)}) {
+            auto r = a.extendedGcd(b);
+            test_suite.assert_true(a * r.second.first + b * r.second.second == r.first, "Bezout identity");
+            test_suite.assert_true(r.first == a.gcd(b), "extendedGcd agrees with gcd");
+            test_suite.assert_true((a % r.first).isZero() && (b % r.first).isZero(), "gcd divides both");
+        }
+    });
+
+    test_suite.test("Modular inverse odd moduli", []() {
+        // Binary algorithm below three limbs, Lehmer above
+        for (size_t bits : {64, 128, 192, 256, 2048}) {
+            BigNum m = BigNum::random(bits) | BigNum(1);
+            BigNum a = BigNum::random(bits + 10);
+            while (!a.gcd(m).isOne()) a += BigNum(1);
+            BigNum inv = a.modInverse(m);
+            test_suite.assert_true(inv < m && !inv.isNegative(), "Inverse is reduced");
+            test_suite.assert_true(((a * inv) % m).isOne(), "a * a^(-1) = 1 mod m");
+            BigNum negInv = (-a).modInverse(m);
+            test_suite.assert_true(((negInv + inv) % m).isZero(), "(-a)^(-1) = -(a^(-1))");
+        }
+        bool threw = false;
+        try {
+            BigNum(15).modInverse(BigNum(25));
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "gcd(15, 25) = 5 has no inverse");
+    });
+
+    test_suite.test("Modular inverse modulo 2^k", []() {
+        for (int k : {1, 63, 64, 65, 1000}) {
+            BigNum m = BigNum(1) << k;
+            BigNum a = BigNum::random(1200) | BigNum(1);
+            BigNum inv = a.modInverse(m);
+            test_suite.assert_true(inv < m, "Inverse is reduced");
+            test_suite.assert_true(((a * inv) % m).isOne(), "Hensel-lifted inverse");
+            BigNum negInv = (-a).modInverse(m);
+            test_suite.assert_true(((negInv + inv) % m).isZero(), "Negative input");
+        }
+        bool threw = false;
+        try {
+            BigNum(6).modInverse(BigNum(1) << 100);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Even values have no inverse mod 2^k");
+    });
+
     test_suite.test("ModPow small", []() {
         BigNum result = BigNum(3).modPow(BigNum(4), BigNum(5));
         // 3^4 = 81, 81 % 5 = 1
@@ -481,6 +962,398 @@ void test_cryptographic_operations() {
         BigNum result = base.modPow(exp, mod);
         test_suite.assert_true(result < mod, "Montgomery ModPow result should be < modulus");
     });
+    
+    test_suite.test("ModPow matches repeated multiplication", []() {
+        // High top bits exercise the final corrections in both reduction
+        // paths: an even modulus goes through Barrett, an odd one through Montgomery
+        BigNum even_mod = BigNum::fromHexString("fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210"
+                                                "fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210fe");
+        BigNum odd_mod = even_mod + BigNum(1);
+        for (const BigNum& mod : {even_mod, odd_mod}) {
+            BigNum base = BigNum::random(500);
+            BigNum expected(1);
+            for (int e = 1; e <= 60; ++e) {
+                expected = (expected * base) % mod;
+                test_suite.assert_equals(expected.toHexString(), base.modPow(BigNum(e), mod).toHexString(), "base^e mod m");
+            }
+        }
+    });
+    
+    test_suite.test("MontgomeryContext multiply, square and reduce", []() {
+        BigNum mod = BigNum::fromHexString("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+                                           "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff1");
+        MontgomeryContext mont(mod);
+        test_suite.assert_true(mod.getDigits()[0] * mont.n0 == UINT64_MAX, "n0 should be -N^-1 mod 2^64");
+        for (int i = 0; i < 20; ++i) {
+            BigNum a = BigNum::random(510) % mod;
+            BigNum b = BigNum::random(510) % mod;
+            BigNum am = mont.toMontgomery(a);
+            BigNum bm = mont.toMontgomery(b);
+            test_suite.assert_equals(((a * b) % mod).toHexString(),
+                                     mont.fromMontgomery(mont.multiply(am, bm)).toHexString(), "Montgomery product");
+            test_suite.assert_equals(((a * a) % mod).toHexString(),
+                                     mont.fromMontgomery(mont.square(am)).toHexString(), "Montgomery square");
+            test_suite.assert_equals(((a * b * mont.r_inv) % mod).toHexString(),
+                                     mont.reduce(a * b).toHexString(), "REDC of a product");
+        }
+    });
+    
+    test_suite.test("ModPow with a reusable context and cache", []() {
+        BigNum mod = BigNum::fromHexString("c3a5c85c97cb3127b0d2e4c0b6ef4e2e5bd1f2c0e4f6a9e2c9c1b0f35a7d2e61");
+        MontgomeryContext mont(mod);
+        test_suite.assert_true(((mont.r * mont.r_inv) % mod).isOne(), "R * R^-1 should be 1 mod N");
+        test_suite.assert_equals(((mont.r * mont.r) % mod).toHexString(), mont.r2.toHexString(), "R^2 mod N");
+        
+        MontgomeryCache cache(2);
+        for (int i = 0; i < 5; ++i) {
+            BigNum base = BigNum::random(300);
+            BigNum exp = BigNum::random(256);
+            BigNum acc(1), sq = base % mod;
+            for (size_t bit = 0; bit < exp.bitLength(); ++bit) {
+                if (!((exp >> static_cast<int>(bit)) & BigNum(1)).isZero()) acc = (acc * sq) % mod;
+                sq = (sq * sq) % mod;
+            }
+            std::string expected = acc.toHexString();
+            test_suite.assert_equals(expected, base.modPow(exp, mont).toHexString(), "modPow with context");
+            test_suite.assert_equals(expected, base.modPow(exp, *cache.get(mod)).toHexString(), "modPow with cached context");
+        }
+        test_suite.assert_true(cache.get(mod) == cache.get(mod), "Repeated lookups should share one context");
+        cache.get(mod + BigNum(2));
+        cache.get(mod + BigNum(4));
+        test_suite.assert_true(cache.size() == 2, "Cache should stay within its capacity");
+    });
+    
+    test_suite.test("ModPow with long exponents", []() {
+        // 2048-bit exponents use the widest sliding window on both paths
+        BigNum even_mod = BigNum::random(1024) << 1;
+        BigNum odd_mod = even_mod + BigNum(1);
+        for (const BigNum& mod : {even_mod, odd_mod}) {
+            BigNum base = BigNum::random(1000);
+            BigNum e1 = BigNum::random(2048);
+            BigNum e2 = BigNum::random(2048) << 7;  // trailing zero bits
+            BigNum lhs = base.modPow(e1 + e2, mod);
+            BigNum rhs = (base.modPow(e1, mod) * base.modPow(e2, mod)) % mod;
+            test_suite.assert_equals(rhs.toHexString(), lhs.toHexString(), "b^(e1+e2) = b^e1 * b^e2");
+        }
+    });
+    
+    test_suite.test("Constant-time ModPow matches ModPow", []() {
+        using Method = BigNum::ConstantTimeMethod;
+        for (size_t bits : {64, 200, 1024}) {
+            BigNum mod = BigNum::random(bits) | BigNum(1);
+            MontgomeryContext mont(mod);
+            for (int i = 0; i < 3; ++i) {
+                BigNum base = BigNum::random(bits + 10);
+                BigNum exp = BigNum::random(bits);
+                std::string expected = base.modPow(exp, mod).toHexString();
+                test_suite.assert_equals(expected, base.modPowConstantTime(exp, mont).toHexString(), "Fixed window");
+                test_suite.assert_equals(expected, base.modPowConstantTime(exp, mont, Method::Ladder).toHexString(), "Ladder");
+            }
+            test_suite.assert_true(BigNum(5).modPowConstantTime(BigNum(0), mont).isOne(), "x^0 = 1");
+            test_suite.assert_true(BigNum(5).modPowConstantTime(BigNum(0), mont, Method::Ladder).isOne(), "x^0 = 1 (ladder)");
+        }
+        
+        bool threw = false;
+        try {
+            BigNum(3).modPowConstantTime(BigNum(5), BigNum(100));
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Even modulus should throw");
+    });
+    
+    test_suite.test("Batch ModPow matches ModPow", []() {
+        // Two shared odd moduli, an even one, a single-limb one and modulus 1
+        std::vector<BigNum> pool = {BigNum::random(1024) | BigNum(1), BigNum::random(512) | BigNum(1),
+                                    BigNum::random(600) << 1, BigNum(97), BigNum(1)};
+        std::vector<BigNum> bases, exps, mods;
+        for (size_t i = 0; i < 40; ++i) {
+            bases.push_back(BigNum::random(700));
+            exps.push_back(i % 7 == 0 ? BigNum(0) : BigNum::random(300));
+            mods.push_back(pool[i % pool.size()]);
+        }
+        
+        const size_t saved = BigNum::threadCount();
+        for (size_t threads : {1, 4}) {
+            BigNum::setThreadCount(threads);
+            std::vector<BigNum> results = BigNum::modPowBatch(bases, exps, mods);
+            bool all = results.size() == bases.size();
+            for (size_t i = 0; all && i < bases.size(); ++i) {
+                all = results[i] == bases[i].modPow(exps[i], mods[i]);
+            }
+            test_suite.assert_true(all, "Per-item moduli with " + std::to_string(threads) + " threads");
+            
+            std::vector<BigNum> shared = BigNum::modPowBatch(bases, {BigNum(65537)}, {pool[0]});
+            all = shared.size() == bases.size();
+            for (size_t i = 0; all && i < bases.size(); ++i) {
+                all = shared[i] == bases[i].modPow(BigNum(65537), pool[0]);
+            }
+            test_suite.assert_true(all, "Broadcast exponent and modulus");
+            
+            bool threw = false;
+            try {
+                BigNum::modPowBatch(bases, exps, {BigNum(0)});
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            test_suite.assert_true(threw, "A zero modulus should surface from the batch");
+        }
+        BigNum::setThreadCount(saved);
+        
+        bool threw = false;
+        try {
+            BigNum::modPowBatch(bases, exps, {pool[0], pool[1]});
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Mismatched moduli count should throw");
+    });
+    
+    test_suite.test("Shared Montgomery context across threads", []() {
+        // One cached context used by several threads at once, as a service
+        // working against a handful of moduli would
+        MontgomeryCache cache(4);
+        BigNum mod = BigNum::random(1024) | BigNum(1);
+        std::vector<BigNum> as, bs, expected;
+        for (int i = 0; i < 64; ++i) {
+            as.push_back(BigNum::random(1100));
+            bs.push_back(BigNum::random(900));
+            // multiply(x, y) = x * y * R^-1 mod N
+            expected.push_back((as[i] % mod) * (bs[i] % mod) * cache.get(mod)->r_inv % mod);
+        }
+        
+        std::atomic<int> mismatches{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int round = 0; round < 20; ++round) {
+                    for (size_t i = t; i < as.size(); i += 2) {
+                        auto ctx = cache.get(mod);
+                        if (ctx->multiply(as[i], bs[i]) != expected[i]) ++mismatches;
+                        BigNum am = ctx->toMontgomery(as[i]);
+                        if (ctx->fromMontgomery(ctx->square(am)) != as[i] * as[i] % mod) ++mismatches;
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        test_suite.assert_true(mismatches == 0, "Concurrent multiply/square/reduce on one context");
+    });
+    
+    test_suite.test("ModPow product matches separate ModPows", []() {
+        // Odd multi-limb, even and single-limb moduli
+        for (const BigNum& mod : {BigNum::random(1024) | BigNum(1), BigNum::random(300) << 1, BigNum(1000003)}) {
+            for (size_t count : {1, 2, 3, 5}) {
+                std::vector<BigNum> bases, exps;
+                BigNum expected = BigNum(1) % mod;
+                for (size_t i = 0; i < count; ++i) {
+                    bases.push_back(i == 1 ? -BigNum::random(900) : BigNum::random(1100));
+                    // Unequal lengths, and a zero exponent among several
+                    exps.push_back(i == 2 ? BigNum(0) : BigNum::random(40 + 230 * i));
+                    expected = BigNum::mulMod(expected, bases[i].modPow(exps[i], mod), mod);
+                }
+                test_suite.assert_equals(expected.toHexString(), BigNum::modPowProduct(bases, exps, mod).toHexString(),
+                                         std::to_string(count) + " bases");
+            }
+        }
+        
+        BigNum mod = BigNum::random(512) | BigNum(1);
+        MontgomeryContext mont(mod);
+        test_suite.assert_true(BigNum::modPowProduct({}, {}, mont).isOne(), "Empty product is one");
+        test_suite.assert_true(BigNum::modPowProduct({BigNum(7)}, {BigNum(0)}, mont).isOne(), "x^0 = 1");
+        test_suite.assert_true(BigNum::modPowProduct({BigNum(7)}, {BigNum(3)}, BigNum(1)).isZero(), "Modulus one");
+        
+        int threw = 0;
+        try { BigNum::modPowProduct({BigNum(2), BigNum(3)}, {BigNum(1)}, mod); } catch (const std::invalid_argument&) { ++threw; }
+        try { BigNum::modPowProduct({BigNum(2)}, {BigNum(-1)}, mod); } catch (const std::invalid_argument&) { ++threw; }
+        try { BigNum::modPowProduct({BigNum(2)}, {BigNum(1)}, BigNum(0)); } catch (const std::invalid_argument&) { ++threw; }
+        test_suite.assert_true(threw == 3, "Mismatched sizes, negative exponents and zero moduli throw");
+    });
+    
+    test_suite.test("RSA-CRT matches the full private exponent", []() {
+        const BigNum e(65537);
+        BigNum p, q, phi;
+        do {
+            p = BigNum::randomPrime(256);
+            q = BigNum::randomPrime(300);  // q > p, so m_p - m_q often wraps
+            phi = (p - BigNum(1)) * (q - BigNum(1));
+        } while (!e.gcd(phi).isOne());
+        BigNum n = p * q;
+        BigNum d = e.modInverse(phi);
+        
+        const size_t saved = BigNum::threadCount();
+        BigNum::setThreadCount(2);
+        // Both orders of the factors
+        for (bool swap : {false, true}) {
+            const BigNum& a = swap ? q : p;
+            const BigNum& b = swap ? p : q;
+            RSACRTContext rsa(a, b, d % (a - BigNum(1)), d % (b - BigNum(1)), b.modInverse(a));
+            test_suite.assert_true(rsa.modulus() == n, "Modulus is p * q");
+            for (int i = 0; i < 4; ++i) {
+                BigNum m = i == 0 ? BigNum(0) : BigNum::random(550) % n;
+                BigNum c = m.modPow(e, n);
+                test_suite.assert_true(rsa.modPow(c) == m, "Decrypts what e encrypted");
+                test_suite.assert_true(rsa.modPow(c, BigNum::Execution::Parallel) == c.modPow(d, n),
+                                       "Parallel halves match c^d mod n");
+            }
+        }
+        BigNum::setThreadCount(saved);
+        
+        int threw = 0;
+        try { RSACRTContext{p, q, d, d, q}; } catch (const std::invalid_argument&) { ++threw; }
+        try { RSACRTContext{p, p, d, d, BigNum(1)}; } catch (const std::invalid_argument&) { ++threw; }
+        try { RSACRTContext{p, q << 1, d, d, BigNum(1)}; } catch (const std::invalid_argument&) { ++threw; }
+        RSACRTContext rsa(p, q, d % (p - BigNum(1)), d % (q - BigNum(1)), q.modInverse(p));
+        try { rsa.modPow(n); } catch (const std::invalid_argument&) { ++threw; }
+        test_suite.assert_true(threw == 4, "Bad qInv, repeated or even factors and out-of-range input throw");
+    });
+
+    test_suite.test("ModArith field operations", []() {
+        // One-limb, inline (4-limb) and heap-backed (9-limb) moduli
+        for (size_t bits : {61, 256, 521}) {
+            BigNum p = BigNum::random(bits) | BigNum(1) | (BigNum(1) << static_cast<int>(bits - 1));
+            ModArith f(p);
+            BigNum a = BigNum::random(bits + 30), b = -BigNum::random(bits);
+            auto mod = [&p](const BigNum& x) { BigNum r = x % p; return r.isNegative() ? r + p : r; };
+            ModArith::Element x = f.element(a), y = f.element(b);
+
+            test_suite.assert_true(f.toBigNum(x) == mod(a), "Round trip through Montgomery form");
+            test_suite.assert_true(f.toBigNum(f.add(x, y)) == mod(a + b), "add");
+            test_suite.assert_true(f.toBigNum(f.sub(x, y)) == mod(a - b), "sub");
+            test_suite.assert_true(f.toBigNum(f.neg(x)) == mod(-a), "neg");
+            test_suite.assert_true(f.toBigNum(f.mul(x, y)) == mod(a * b), "mul");
+            test_suite.assert_true(f.toBigNum(f.sqr(y)) == mod(b * b), "sqr");
+            BigNum e = BigNum::random(200);
+            test_suite.assert_true(f.toBigNum(f.pow(x, e)) == mod(a).modPow(e, p), "pow");
+            test_suite.assert_true(f.pow(x, BigNum(0)) == f.one(), "x^0 = 1");
+            test_suite.assert_true(f.isZero(f.add(x, f.neg(x))), "x + (-x) = 0");
+
+            if (a.gcd(p).isOne()) {
+                test_suite.assert_true(f.mul(x, f.inv(x)) == f.one(), "x * x^-1 = 1");
+                test_suite.assert_true(f.pow(x, -e) == f.inv(f.pow(x, e)), "Negative exponent");
+            }
+
+            // In place, with the result aliasing both operands
+            ModArith::Element z = x;
+            f.mul(z, z, z);
+            test_suite.assert_true(z == f.sqr(x), "Aliased mul");
+            f.sub(z, z, z);
+            test_suite.assert_true(z == f.zero(), "Aliased sub");
+        }
+
+        bool threw = false;
+        try {
+            ModArith f(BigNum(1) << 64);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Even modulus should throw");
+
+        threw = false;
+        try {
+            ModArith f(BigNum(101));
+            f.inv(f.zero());
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Zero has no inverse");
+    });
+
+    test_suite.test("ModArith batch inversion", []() {
+        BigNum p = BigNum::fromHexString("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff");  // P-256
+        ModArith f(p);
+        std::vector<ModArith::Element> xs;
+        for (int i = 0; i < 20; ++i) xs.push_back(f.element(BigNum::random(256)));
+        std::vector<ModArith::Element> inverses = xs;
+        f.batchInv(inverses);
+        bool all = true;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            all = all && inverses[i] == f.inv(xs[i]);
+        }
+        test_suite.assert_true(all, "Batch inverses match single inversions");
+
+        std::vector<ModArith::Element> single = {xs[3]};
+        f.batchInv(single);
+        test_suite.assert_true(single[0] == inverses[3], "Single-element batch");
+
+        std::vector<ModArith::Element> withZero = xs;
+        withZero[7] = f.zero();
+        bool threw = false;
+        try {
+            f.batchInv(withZero);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw && withZero[0] == xs[0], "A zero element throws and leaves the input alone");
+
+        ModArith other(BigNum(101));
+        threw = false;
+        try {
+            f.mul(xs[0], other.one());
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Elements of another field are rejected");
+    });
+
+    test_suite.test("Runtime kernel sets agree", []() {
+        std::vector<std::string> sets = BigNum::availableKernels();
+        const std::string saved = BigNum::kernels();
+        test_suite.assert_true(!sets.empty() && sets.back() == "portable", "Portable kernels are always available");
+        test_suite.assert_true(std::find(sets.begin(), sets.end(), saved) != sets.end(), "Active set is an available one");
+
+        // Schoolbook, Karatsuba and Toom-3 sized products, a division and a
+        // Montgomery exponentiation; all-ones operands stress the carry chains
+        std::vector<BigNum> xs = {BigNum::random(64), BigNum::random(300), BigNum::random(3000),
+                                  (BigNum(1) << 4096) - BigNum(1), BigNum::random(20000)};
+        BigNum m = BigNum::random(1024) | BigNum(1);
+        BigNum e = BigNum::random(256);
+        BigNum::setKernels("portable");
+        std::vector<BigNum> expected;
+        for (const BigNum& x : xs) {
+            expected.push_back(x * xs[3]);
+            expected.push_back(x * x);
+            expected.push_back(xs[4] / (x + BigNum(1)));
+            expected.push_back(x.modPow(e, m));
+        }
+        for (const std::string& name : sets) {
+            BigNum::setKernels(name);
+            bool all = true;
+            size_t k = 0;
+            for (const BigNum& x : xs) {
+                all = all && x * xs[3] == expected[k++];
+                all = all && x * x == expected[k++];
+                all = all && xs[4] / (x + BigNum(1)) == expected[k++];
+                all = all && x.modPow(e, m) == expected[k++];
+            }
+            test_suite.assert_true(all, name + " matches the portable kernels");
+        }
+        
+        // Switching sets while other threads multiply never mixes two sets
+        std::atomic<bool> stop{false};
+        std::atomic<int> mismatches{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 2; ++t) {
+            workers.emplace_back([&]() {
+                while (!stop) {
+                    if (xs[2] * xs[3] != expected[8] || xs[1].modPow(e, m) != expected[7]) ++mismatches;
+                }
+            });
+        }
+        for (int i = 0; i < 200; ++i) BigNum::setKernels(sets[i % sets.size()]);
+        stop = true;
+        for (auto& w : workers) w.join();
+        test_suite.assert_true(mismatches == 0, "setKernels is safe while other threads compute");
+        BigNum::setKernels(saved);
+
+        bool threw = false;
+        try {
+            BigNum::setKernels("no-such-kernels");
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw && BigNum::kernels() == saved, "Unknown set throws and keeps the current one");
+    });
 }
 
 void test_edge_cases() {
@@ -587,6 +1460,165 @@ void test_random_and_primes() {
         BigNum medium_prime = (BigNum(1) << 31) - BigNum(1);
         test_suite.assert_true(medium_prime.isProbablePrime(5), "2^31 - 1 should be prime");
     });
+    
+    test_suite.test("Sieved prime generation across bit lengths", []() {
+        bool ok = true;
+        for (size_t bits = 4; bits <= 70; ++bits) {
+            BigNum p = BigNum::randomPrime(bits);
+            ok = ok && p.bitLength() == bits && p.isProbablePrime(20);
+        }
+        test_suite.assert_true(ok, "Every prime should have the requested bit length");
+    });
+    
+    test_suite.test("Baillie-PSW", []() {
+        // Strong pseudoprime to every prime base up to 23, with no small factor
+        BigNum spsp = BigNum::fromDecimalString("3825123056546413051");
+        test_suite.assert_true(!spsp.isBailliePSWPrime(), "Strong base-2 pseudoprime is rejected by the Lucas test");
+        test_suite.assert_true(((BigNum(1) << 127) - BigNum(1)).isBailliePSWPrime(), "2^127 - 1 should be prime");
+        test_suite.assert_true(BigNum(2).isBailliePSWPrime() && BigNum(1619).isBailliePSWPrime(), "Small primes");
+        test_suite.assert_true(!BigNum(1).isBailliePSWPrime() && !BigNum(561).isBailliePSWPrime(), "1 and 561");
+        
+        BigNum p = BigNum::randomPrime(384, BigNum::Execution::Sequential, BigNum::PrimalityTest::BailliePSW);
+        test_suite.assert_true(p.bitLength() == 384 && p.isProbablePrime(20), "Baillie-PSW prime generation");
+        test_suite.assert_true(!(p * p).isBailliePSWPrime(), "A prime square is composite");
+    });
+    
+    test_suite.test("Parallel primality and prime search", []() {
+        using Execution = BigNum::Execution;
+        const size_t saved = BigNum::threadCount();
+        BigNum::setThreadCount(4);
+        
+        BigNum m127 = (BigNum(1) << 127) - BigNum(1);
+        BigNum m521 = (BigNum(1) << 521) - BigNum(1);
+        test_suite.assert_true(m127.isProbablePrime(20, Execution::Parallel), "2^127 - 1 should be prime");
+        test_suite.assert_true(m521.isProbablePrime(20, Execution::Parallel), "2^521 - 1 should be prime");
+        test_suite.assert_true(!BigNum(561).isProbablePrime(20, Execution::Parallel), "Carmichael 561 is composite");
+        test_suite.assert_true(!(m127 * m521).isProbablePrime(20, Execution::Parallel),
+                               "Product of two primes is composite");
+        
+        BigNum p = BigNum::randomPrime(256, Execution::Parallel);
+        test_suite.assert_true(p.bitLength() == 256, "Prime should have exact bit length");
+        test_suite.assert_true(p.isProbablePrime(20), "Parallel search should return a prime");
+        BigNum::setThreadCount(saved);
+    });
+    
+    test_suite.test("Next prime", []() {
+        const int expected[] = {2, 2, 2, 3, 5, 5, 7, 7, 11, 11, 11, 11, 13, 13, 17};
+        for (int i = -1; i < 14; ++i) {
+            test_suite.assert_equals(std::to_string(expected[i + 1]), BigNum(i).nextPrime().toDecimalString(),
+                                     "nextPrime(" + std::to_string(i) + ")");
+        }
+        // Across several sieve windows, against plain primality tests
+        BigNum x = BigNum::random(200);
+        for (int i = 0; i < 5; ++i) {
+            BigNum next = x.nextPrime(i % 2 ? BigNum::PrimalityTest::BailliePSW : BigNum::PrimalityTest::MillerRabin);
+            bool gap = next > x && next.isBailliePSWPrime();
+            for (BigNum c = x + BigNum(1); gap && c < next; c += BigNum(1)) gap = !c.isBailliePSWPrime();
+            test_suite.assert_true(gap, "No prime is skipped");
+            x = next;
+        }
+        test_suite.assert_true(((BigNum(1) << 127) - BigNum(2)).nextPrime() == (BigNum(1) << 127) - BigNum(1), "nextPrime reaches 2^127 - 1");
+    });
+    
+    test_suite.test("Factorization", []() {
+        auto joined = [](const std::vector<BigNum>& fs) {
+            std::string out;
+            for (const BigNum& f : fs) out += (out.empty() ? "" : " ") + f.toDecimalString();
+            return out;
+        };
+        test_suite.assert_true(BigNum(1).factor().empty(), "1 has no prime factors");
+        test_suite.assert_equals("2 2 3", joined(BigNum(-12).factor()), "Sign is dropped");
+        test_suite.assert_equals("71 839 1471 6857", joined(BigNum::fromDecimalString("600851475143").factor()), "Trial division");
+        test_suite.assert_equals("3 3 3 7 11 13 31 37 41 211 241 271 2161 9091 2906161",
+                                 joined(BigNum::fromDecimalString("999999999999999999999999999999").factor()), "Repeated small factors");
+        test_suite.assert_equals("274177 67280421310721", joined(((BigNum(1) << 64) + BigNum(1)).factor()), "F6 by Pollard rho");
+        BigNum p = (BigNum(1) << 127) - BigNum(1);
+        test_suite.assert_equals(p.toDecimalString(), joined(p.factor()), "A prime is its own factorization");
+        
+        // A 43-bit factor is past the rho budget and found by ECM
+        BigNum q = (BigNum(1) << 42).nextPrime(), r = (BigNum(1) << 80).nextPrime();
+        std::vector<BigNum> fs = (q * r * BigNum(65521) * BigNum(65521)).factor();
+        test_suite.assert_true(fs.size() == 4 && fs[1] == BigNum(65521) && fs[2] == q && fs[3] == r, "ECM after trial division");
+        
+        bool threw = false;
+        try {
+            BigNum(0).factor();
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Zero cannot be factored");
+    });
+    
+    test_suite.test("Cooperative cancellation", []() {
+        auto cancels = [](const std::function<void()>& work) {
+            try {
+                work();
+            } catch (const BigNum::Cancelled&) {
+                return true;
+            }
+            return false;
+        };
+        BigNum m = BigNum::random(2048) | BigNum(1);
+        BigNum e = BigNum::random(2048);
+        BigNum x = BigNum::random(2000);
+        BigNum expected = x.modPow(e, m);
+        BigNum prime = BigNum::randomPrime(1024);
+        {
+            BigNum::CancelScope never([]() { return false; });
+            test_suite.assert_true(x.modPow(e, m) == expected, "A scope that never fires changes nothing");
+        }
+        {
+            int polls = 0;
+            BigNum::CancelScope scope([&polls]() { return ++polls > 2; });
+            test_suite.assert_true(cancels([&]() { x.modPow(e, m); }), "modPow stops inside its window loop");
+            test_suite.assert_true(polls == 3, "Predicate consulted once per poll interval");
+            test_suite.assert_true(cancels([&]() { x.modPowConstantTime(e, m); }), "Constant-time modPow stops");
+            test_suite.assert_true(cancels([&]() { prime.isProbablePrime(); }), "Miller-Rabin stops");
+            test_suite.assert_true(cancels([]() { BigNum(3).pow(1000000); }), "pow stops");
+        }
+        test_suite.assert_true(x.modPow(e, m) == expected, "The guard is gone after its scope");
+        {
+            BigNum::CancelScope outer([]() { return true; });
+            BigNum::CancelScope inner([]() { return false; });
+            test_suite.assert_true(cancels([]() { BigNum::randomPrime(1024); }), "An enclosing scope cancels too");
+        }
+        
+        // A flag raised from another thread stops a parallel search, and a
+        // deadline stops a factorization that would run for hours
+        std::atomic<bool> stop{false};
+        std::thread raiser([&stop]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            stop.store(true);
+        });
+        bool stopped = cancels([&stop]() {
+            BigNum::CancelScope byFlag([&stop]() { return stop.load(); });
+            for (;;) BigNum::randomPrime(4096, BigNum::Execution::Parallel);
+        });
+        raiser.join();
+        test_suite.assert_true(stopped, "Parallel randomPrime stops");
+        
+        // The web worker's path: one long modPow polling a shared flag that
+        // another thread raises, after which the same thread carries on
+        BigNum bigM = BigNum::random(16384) | BigNum(1);
+        BigNum bigE = BigNum::random(16384);
+        std::atomic<int> flag{0};
+        std::thread page([&flag]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            flag.store(1);
+        });
+        bool interrupted = cancels([&]() {
+            BigNum::CancelScope byFlag([&flag]() { return flag.load() != 0; });
+            x.modPow(bigE, bigM);
+        });
+        page.join();
+        test_suite.assert_true(interrupted, "A long modPow stops through a shared flag");
+        test_suite.assert_true(x.modPow(e, m) == expected, "The thread keeps working after a cancel");
+        
+        BigNum semiprime = BigNum::randomPrime(256) * BigNum::randomPrime(256);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        BigNum::CancelScope byTime([deadline]() { return std::chrono::steady_clock::now() > deadline; });
+        test_suite.assert_true(cancels([&]() { semiprime.factor(); }), "factor stops at a deadline");
+    });
 }
 
 void test_byte_arrays() {
@@ -619,6 +1651,110 @@ void test_byte_arrays() {
         std::string expected(64, 'f'); // 64 'f' characters
         test_suite.assert_equals(expected, num.toHexString(), "Large byte array");
     });
+    
+    test_suite.test("Fixed-width byte export in both orders", []() {
+        BigNum num = BigNum::fromHexString("0102030405060708090a");
+        uint8_t be[12], le[12];
+        num.toBytes(be, sizeof(be), BigNum::ByteOrder::BigEndian);
+        num.toBytes(le, sizeof(le), BigNum::ByteOrder::LittleEndian);
+        const uint8_t expected_be[12] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        bool be_ok = std::memcmp(be, expected_be, sizeof(be)) == 0;
+        bool le_ok = true;
+        for (size_t i = 0; i < sizeof(le); ++i) le_ok = le_ok && le[i] == expected_be[sizeof(be) - 1 - i];
+        test_suite.assert_true(be_ok, "Big-endian bytes are zero-padded at the front");
+        test_suite.assert_true(le_ok, "Little-endian bytes are the reverse");
+        
+        test_suite.assert_true(BigNum::fromBytes(be, sizeof(be)) == num, "Big-endian roundtrip");
+        test_suite.assert_true(BigNum::fromBytes(le, sizeof(le), BigNum::ByteOrder::LittleEndian) == num,
+                               "Little-endian roundtrip");
+        
+        bool threw = false;
+        try {
+            num.toBytes(be, 9);
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "A buffer shorter than the value should be rejected");
+    });
+    
+    test_suite.test("Hex into a caller buffer", []() {
+        BigNum num = -BigNum::fromHexString("1abcdef0123456789");
+        char buf[32];
+        size_t len = num.toHexString(buf, sizeof(buf));
+        test_suite.assert_equals("-1abcdef0123456789", std::string(buf, len), "Buffer contents");
+        test_suite.assert_true(len == num.hexLength(), "hexLength matches the written size");
+        
+        std::string_view view("xx0x1abcdef0123456789yy");
+        BigNum parsed = BigNum::fromHexString(view.substr(2, view.size() - 4));
+        test_suite.assert_equals("1abcdef0123456789", parsed.toHexString(), "string_view input");
+        
+        bool threw = false;
+        try {
+            BigNum::fromHexString("12g4");
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Invalid hex characters should be rejected");
+    });
+}
+
+// Compile-time evaluation of the fixed-width kernels
+constexpr FixedBigNum<128> FIXED_WRAP = FixedBigNum<128>::fromLimbs({~0ULL, 1}) + FixedBigNum<128>(1);
+static_assert(FIXED_WRAP[0] == 0 && FIXED_WRAP[1] == 2, "constexpr carry propagation");
+constexpr FixedMontgomery<64> FIXED_FIELD(FixedBigNum<64>(1000003));
+static_assert(FIXED_FIELD.fromMontgomery(FIXED_FIELD.mul(FIXED_FIELD.toMontgomery(2000),
+                                                         FIXED_FIELD.toMontgomery(3000))) == FixedBigNum<64>(6000000 % 1000003),
+              "constexpr Montgomery product");
+
+void test_fixed_width() {
+    test_suite.start_category("Fixed-Width Integers");
+    
+    test_suite.test("FixedBigNum arithmetic wraps like BigNum mod 2^Bits", []() {
+        const BigNum wrap = BigNum(1) << 256;
+        auto mod = [&wrap](const BigNum& x) { BigNum r = x % wrap; return r.isNegative() ? r + wrap : r; };
+        for (int i = 0; i < 20; ++i) {
+            BigNum a = BigNum::random(256), b = BigNum::random(i % 2 ? 256 : 100);
+            FixedBigNum<256> fa(a), fb(b);
+            test_suite.assert_true(fa.toBigNum() == a, "Round trip");
+            test_suite.assert_true((fa + fb).toBigNum() == mod(a + b), "add");
+            test_suite.assert_true((fa - fb).toBigNum() == mod(a - b), "sub");
+            test_suite.assert_true((fa * fb).toBigNum() == mod(a * b), "mul");
+            auto wide = FixedBigNum<256>::mulWide(fa, fb);
+            test_suite.assert_true(BigNum(std::vector<uint64_t>(wide.begin(), wide.end())) == a * b, "mulWide");
+            test_suite.assert_true((fa << 77).toBigNum() == mod(a << 77) && (fa >> 130).toBigNum() == (a >> 130), "shifts");
+            test_suite.assert_true((fa < fb) == (a < b) && fa.bitLength() == a.bitLength(), "compare");
+        }
+        
+        bool threw = false;
+        try {
+            FixedBigNum<128> f(BigNum(1) << 128);
+        } catch (const std::overflow_error&) {
+            threw = true;
+        }
+        test_suite.assert_true(threw, "Values wider than Bits should throw");
+    });
+    
+    test_suite.test("FixedMontgomery matches ModArith", []() {
+        BigNum p256 = BigNum::fromHexString("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff");
+        FixedMontgomery<256> fixed{FixedBigNum<256>(p256)};
+        ModArith field(p256);
+        for (int i = 0; i < 10; ++i) {
+            BigNum a = BigNum::random(256), b = BigNum::random(200);
+            auto fa = fixed.toMontgomery(FixedBigNum<256>(a)), fb = fixed.toMontgomery(FixedBigNum<256>(b));
+            auto xa = field.element(a), xb = field.element(b);
+            test_suite.assert_true(fixed.fromMontgomery(fixed.mul(fa, fb)).toBigNum() == field.toBigNum(field.mul(xa, xb)), "mul");
+            test_suite.assert_true(fixed.fromMontgomery(fixed.add(fa, fb)).toBigNum() == field.toBigNum(field.add(xa, xb)), "add");
+            test_suite.assert_true(fixed.fromMontgomery(fixed.sub(fb, fa)).toBigNum() == field.toBigNum(field.sub(xb, xa)), "sub");
+            test_suite.assert_true(fixed.fromMontgomery(fixed.neg(fa)).toBigNum() == field.toBigNum(field.neg(xa)), "neg");
+        }
+        
+        // RSA-sized pow against BigNum::modPow
+        BigNum n = BigNum::random(2048) | BigNum(1) | (BigNum(1) << 2047);
+        FixedMontgomery<2048> rsa{FixedBigNum<2048>(n)};
+        BigNum base = BigNum::random(2040), e = BigNum::random(300);
+        auto r = rsa.fromMontgomery(rsa.pow(rsa.toMontgomery(FixedBigNum<2048>(base)), FixedBigNum<320>(e)));
+        test_suite.assert_true(r.toBigNum() == base.modPow(e, n), "2048-bit pow");
+    });
 }
 
 int main() {
@@ -636,6 +1772,7 @@ int main() {
     test_edge_cases();
     test_random_and_primes();
     test_byte_arrays();
+    test_fixed_width();
     
     test_suite.print_summary();
     return 0;
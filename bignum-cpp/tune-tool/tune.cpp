@@ -0,0 +1,267 @@
+/**
+ * @file tune.cpp
+ * @brief Measures the algorithm crossover points of the BigNum library on
+ * the current host.
+ *
+ * For every threshold in BigNumTuning the tool times both algorithms around
+ * the crossover, one operand size at a time, and reports the first size from
+ * which the faster algorithm stays ahead. The result is printed as a table
+ * and as the compiler flags that bake it into a build, and can be written
+ * as a tuning header for -DBIGNUM_TUNING_HEADER or as a profile for
+ * BigNum::loadTuning and the BIGNUM_TUNING environment variable.
+ *
+ * Division has one algorithm; the crossovers on its paths are Barrett
+ * reduction (modular reduction by a fixed modulus) and the
+ * divide-and-conquer decimal conversion.
+ *
+ * Usage: bignum-tune [--quick] [--header FILE] [--profile FILE]
+ */
+
+#include "bignum.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+double g_budget_ms = 40.0;  // Time spent per measurement
+
+// Best-of-three time per call in microseconds
+double timeOp(const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    double best = 1e300;
+    for (int rep = 0; rep < 3; ++rep) {
+        size_t calls = 0;
+        auto start = clock::now();
+        auto deadline = start + std::chrono::duration<double, std::milli>(g_budget_ms / 3);
+        do {
+            op();
+            ++calls;
+        } while (clock::now() < deadline);
+        double us = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+        best = std::min(best, us / calls);
+    }
+    return best;
+}
+
+// Walks sizes upwards and returns the first size from which the candidate
+// algorithm (enabled at that size) beats the baseline for `confirm`
+// consecutive sizes, or 0 when it never does within the range. `configure(size, enabled)` installs the tuning for one
+// run; `measure(size)` times one operation.
+size_t findCrossover(const std::string& name, size_t from, size_t to, size_t step,
+                     const std::function<void(size_t, bool)>& configure,
+                     const std::function<std::function<void()>(size_t)>& measure) {
+    const int confirm = 2;
+    int wins = 0;
+    size_t first = 0;
+    std::cout << "  " << name << "\n";
+    for (size_t n = from; n <= to; n += step) {
+        auto op = measure(n);
+        configure(n, false);
+        double base = timeOp(op);
+        configure(n, true);
+        double cand = timeOp(op);
+        std::cout << "    " << std::setw(5) << n << " limbs  " << std::fixed << std::setprecision(3)
+                  << std::setw(10) << base << " us  " << std::setw(10) << cand << " us  "
+                  << (cand < base ? "<" : "") << "\n";
+        if (cand < base) {
+            if (wins++ == 0) first = n;
+            if (wins >= confirm) break;
+        } else {
+            wins = 0;
+            first = 0;
+        }
+    }
+    BigNum::setTuning(BigNumTuning());
+    return wins >= confirm ? first : 0;
+}
+
+// BigNumTuning fields and the macros in bignum.h that default them
+const std::pair<const char*, size_t BigNumTuning::*> MACROS[] = {
+    {"BIGNUM_KARATSUBA_THRESHOLD", &BigNumTuning::karatsuba_threshold},
+    {"BIGNUM_KARATSUBA_SQR_THRESHOLD", &BigNumTuning::karatsuba_sqr_threshold},
+    {"BIGNUM_TOOM3_THRESHOLD", &BigNumTuning::toom3_threshold},
+    {"BIGNUM_NTT_THRESHOLD", &BigNumTuning::ntt_threshold},
+    {"BIGNUM_MONTGOMERY_THRESHOLD", &BigNumTuning::montgomery_threshold},
+    {"BIGNUM_BARRETT_THRESHOLD", &BigNumTuning::barrett_threshold},
+    {"BIGNUM_DECIMAL_THRESHOLD", &BigNumTuning::decimal_threshold},
+};
+
+std::string provenance() {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S UTC", std::gmtime(&now));
+    return std::string("Generated by bignum-tune on ") + date + ", kernels " + BigNum::kernels();
+}
+
+// Macros that bignum.h picks up before its built-in defaults; a -D on the
+// command line still wins
+bool writeHeader(const std::string& path, const BigNumTuning& t) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "// " << provenance() << "\n"
+        << "// Build with -DBIGNUM_TUNING_HEADER=\"" << path << "\"\n\n"
+        << "#ifndef BIGNUM_TUNING_GENERATED_H\n#define BIGNUM_TUNING_GENERATED_H\n\n";
+    for (const auto& m : MACROS) {
+        out << "#ifndef " << m.first << "\n#define " << m.first << " " << t.*(m.second) << "\n#endif\n";
+    }
+    out << "\n#endif // BIGNUM_TUNING_GENERATED_H\n";
+    return static_cast<bool>(out);
+}
+
+bool writeProfile(const std::string& path, const BigNumTuning& t) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "# " << provenance() << "\n" << BigNum::formatTuning(t);
+    return static_cast<bool>(out);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string header, profile;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            g_budget_ms = 10.0;
+        } else if (std::strcmp(argv[i], "--header") == 0 && i + 1 < argc) {
+            header = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--header FILE] [--profile FILE]\n";
+            return 1;
+        }
+    }
+    
+    const size_t never = static_cast<size_t>(-1);
+    BigNumTuning result;
+    
+    // A crossover that was never reached keeps the built-in default
+    auto pick = [](size_t measured, size_t fallback) { return measured ? measured : fallback; };
+    std::cout << "bignum-tune: measuring crossovers (baseline vs candidate, per call)\n";
+    
+    result.karatsuba_threshold = pick(findCrossover("Karatsuba multiplication", 4, 128, 2,
+        [&](size_t n, bool on) {
+            BigNumTuning t;
+            t.karatsuba_threshold = on ? n : never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto a = std::make_shared<BigNum>(BigNum::random(n * 64));
+            auto b = std::make_shared<BigNum>(BigNum::random(n * 64));
+            return std::function<void()>([a, b]() { BigNum c = *a * *b; (void)c; });
+        }), result.karatsuba_threshold);
+    
+    result.karatsuba_sqr_threshold = pick(findCrossover("Karatsuba squaring", 4, 160, 2,
+        [&](size_t n, bool on) {
+            BigNumTuning t;
+            t.karatsuba_sqr_threshold = on ? n : never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto a = std::make_shared<BigNum>(BigNum::random(n * 64));
+            return std::function<void()>([a]() { BigNum c = a->square(); (void)c; });
+        }), result.karatsuba_sqr_threshold);
+    
+    result.toom3_threshold = pick(findCrossover("Toom-3 multiplication", 40, 400, 20,
+        [&](size_t n, bool on) {
+            BigNumTuning t = result;
+            t.toom3_threshold = on ? n : never;
+            t.ntt_threshold = never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto a = std::make_shared<BigNum>(BigNum::random(n * 64));
+            auto b = std::make_shared<BigNum>(BigNum::random(n * 64));
+            return std::function<void()>([a, b]() { BigNum c = *a * *b; (void)c; });
+        }), result.toom3_threshold);
+    
+    result.ntt_threshold = pick(findCrossover("NTT multiplication", 1000, 16000, 1000,
+        [&](size_t n, bool on) {
+            BigNumTuning t = result;
+            t.ntt_threshold = on ? n : never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto a = std::make_shared<BigNum>(BigNum::random(n * 64));
+            auto b = std::make_shared<BigNum>(BigNum::random(n * 64));
+            return std::function<void()>([a, b]() { BigNum c = *a * *b; (void)c; });
+        }), result.ntt_threshold);
+    
+    result.montgomery_threshold = pick(findCrossover("Montgomery modPow (odd modulus)", 1, 32, 1,
+        [&](size_t n, bool on) {
+            BigNumTuning t = result;
+            t.montgomery_threshold = on ? n : never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto m = std::make_shared<BigNum>(BigNum::random(n * 64) | BigNum(1));
+            auto b = std::make_shared<BigNum>(BigNum::random(n * 64 - 1));
+            auto e = std::make_shared<BigNum>(BigNum::random(256));
+            return std::function<void()>([m, b, e]() { BigNum r = b->modPow(*e, *m); (void)r; });
+        }), result.montgomery_threshold);
+    
+    result.barrett_threshold = pick(findCrossover("Barrett reduction (even modulus)", 1, 48, 1,
+        [&](size_t n, bool on) {
+            BigNumTuning t = result;
+            t.barrett_threshold = on ? n : never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto m = std::make_shared<BigNum>(BigNum::random(n * 64) << 1);
+            auto b = std::make_shared<BigNum>(BigNum::random(n * 64 - 1));
+            auto e = std::make_shared<BigNum>(BigNum::random(256));
+            return std::function<void()>([m, b, e]() { BigNum r = b->modPow(*e, *m); (void)r; });
+        }), result.barrett_threshold);
+    
+    result.decimal_threshold = pick(findCrossover("Decimal printing", 8, 200, 8,
+        [&](size_t n, bool on) {
+            BigNumTuning t = result;
+            t.decimal_threshold = on ? n : never;
+            BigNum::setTuning(t);
+        },
+        [](size_t n) {
+            auto a = std::make_shared<BigNum>(BigNum::random(n * 64));
+            return std::function<void()>([a]() { std::string s = a->toDecimalString(); (void)s; });
+        }), result.decimal_threshold);
+    
+    std::cout << "\nRecommended thresholds (limbs):\n"
+              << "  karatsuba_threshold      " << result.karatsuba_threshold << "\n"
+              << "  karatsuba_sqr_threshold  " << result.karatsuba_sqr_threshold << "\n"
+              << "  toom3_threshold          " << result.toom3_threshold << "\n"
+              << "  ntt_threshold            " << result.ntt_threshold << "\n"
+              << "  montgomery_threshold     " << result.montgomery_threshold << "\n"
+              << "  barrett_threshold        " << result.barrett_threshold << "\n"
+              << "  decimal_threshold        " << result.decimal_threshold << "\n"
+              << "\nCompiler flags:\n"
+              << "  -DBIGNUM_KARATSUBA_THRESHOLD=" << result.karatsuba_threshold
+              << " -DBIGNUM_KARATSUBA_SQR_THRESHOLD=" << result.karatsuba_sqr_threshold
+              << " -DBIGNUM_TOOM3_THRESHOLD=" << result.toom3_threshold
+              << " -DBIGNUM_NTT_THRESHOLD=" << result.ntt_threshold
+              << " -DBIGNUM_MONTGOMERY_THRESHOLD=" << result.montgomery_threshold
+              << " -DBIGNUM_BARRETT_THRESHOLD=" << result.barrett_threshold
+              << " -DBIGNUM_DECIMAL_THRESHOLD=" << result.decimal_threshold << "\n";
+    
+    if (!header.empty()) {
+        if (!writeHeader(header, result)) {
+            std::cerr << "bignum-tune: cannot write " << header << "\n";
+            return 1;
+        }
+        std::cout << "\nTuning header: " << header << "\n";
+    }
+    if (!profile.empty()) {
+        if (!writeProfile(profile, result)) {
+            std::cerr << "bignum-tune: cannot write " << profile << "\n";
+            return 1;
+        }
+        std::cout << "Tuning profile: " << profile << "\n";
+    }
+    return 0;
+}
@@ -1,11 +1,109 @@
 #include "../bignum-cpp/include/bignum.h"
+#include <algorithm>
+#include <cstdint>
 #include <emscripten/bind.h>
+#include <emscripten/em_js.h>
 #include <emscripten/val.h>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 using namespace emscripten;
 
+// A worker hosting the module points Module.cancelFlag at an Int32Array,
+// normally over a SharedArrayBuffer the page can write while the worker is
+// busy; a non-zero first element asks the running call to stop.
+EM_JS(bool, cancelRequested, (), {
+    const flag = Module.cancelFlag;
+    return flag !== undefined && Atomics.load(flag, 0) !== 0;
+});
+
+// Everything a long-running call runs under: a limb arena so temporaries
+// are recycled in its chunks instead of fragmenting the growable wasm heap,
+// and a cancellation guard polling the flag above. A cancelled call throws
+// BigNum::Cancelled back to JavaScript.
+struct CallGuard {
+    BigNum::ScopedArena arena;
+    BigNum::CancelScope cancel{[] { return cancelRequested(); }};
+};
+
+// The result is copied out after the guard, which leaves the chunk free for
+// the next call
+template <typename F>
+static BigNum guarded(F compute) {
+    BigNum result;
+    {
+        CallGuard guard;
+        result = compute();
+    }
+    return BigNum(result);
+}
+
+// Values cross to JavaScript without hex strings: limbs are read and written
+// in place on the wasm heap (little-endian, like the heap itself), and
+// BigInts are taken apart and rebuilt 64 bits at a time.
+EM_JS(bool, bigIntIsNegative, (EM_VAL handle), {
+    return Emval.toValue(handle) < 0n;
+});
+
+EM_JS(size_t, bigIntLimbCount, (EM_VAL handle), {
+    let x = Emval.toValue(handle);
+    if (x < 0n) x = -x;
+    let n = 0;
+    for (; x > 0n; x >>= 64n) ++n;
+    return n;
+});
+
+EM_JS(void, bigIntToLimbs, (EM_VAL handle, uint64_t* out, size_t n), {
+    let x = Emval.toValue(handle);
+    if (x < 0n) x = -x;
+    const limbs = new BigUint64Array(HEAP8.buffer, out, n);
+    for (let i = 0; i < n; ++i, x >>= 64n) limbs[i] = BigInt.asUintN(64, x);
+});
+
+EM_JS(EM_VAL, limbsToBigInt, (const uint64_t* limbs, size_t n, bool negative), {
+    const view = new BigUint64Array(HEAP8.buffer, limbs, n);
+    let x = 0n;
+    for (let i = n; i-- > 0;) x = (x << 64n) | view[i];
+    return Emval.toHandle(negative ? -x : x);
+});
+
+EM_JS(EM_VAL, limbsView, (const uint64_t* limbs, size_t n), {
+    return Emval.toHandle(new BigUint64Array(HEAP8.buffer, limbs, n));
+});
+
+static BigNum fromBigInt(const val& value) {
+    if (value.typeOf().as<std::string>() != "bigint") {
+        throw std::invalid_argument("Expected a BigInt");
+    }
+    const size_t n = bigIntLimbCount(value.as_handle());
+    LimbVector limbs(n);
+    bigIntToLimbs(value.as_handle(), limbs.data(), n);
+    return BigNum(std::move(limbs), bigIntIsNegative(value.as_handle()));
+}
+
+static val toBigInt(const BigNum& x) {
+    const LimbVector& limbs = x.getDigits();
+    return val::take_ownership(limbsToBigInt(limbs.data(), limbs.size(), x.isNeg()));
+}
+
+// One copy in: the array is set() straight into the buffer the value is
+// parsed from
+static BigNum fromByteView(const val& bytes, bool bigEndian) {
+    const size_t n = bytes["length"].as<size_t>();
+    std::vector<uint8_t> buffer(n);
+    val(typed_memory_view(n, buffer.data())).call<void>("set", bytes);
+    return BigNum::fromBytes(buffer.data(), n, bigEndian ? BigNum::ByteOrder::BigEndian : BigNum::ByteOrder::LittleEndian);
+}
+
+// A fresh Uint8Array of exactly `length` bytes (0 means byteLength())
+static val toByteArray(const BigNum& x, size_t length, bool bigEndian) {
+    if (length == 0) length = std::max<size_t>(1, x.byteLength());
+    std::vector<uint8_t> buffer(length);
+    x.toBytes(buffer.data(), length, bigEndian ? BigNum::ByteOrder::BigEndian : BigNum::ByteOrder::LittleEndian);
+    return val::global("Uint8Array").new_(typed_memory_view(length, buffer.data()));
+}
+
 // Wrapper class for easier JavaScript integration
 class BigNumJS {
 private:
@@ -16,6 +114,10 @@ public:
     BigNumJS(const std::string& hexStr) : num(BigNum::fromHexString(hexStr)) {}
     BigNumJS(const BigNum& bn) : num(bn) {}
 
+    const BigNum& value() const {
+        return num;
+    }
+
     // Basic arithmetic operations
     BigNumJS add(const BigNumJS& other) const {
         return BigNumJS(num + other.num);
@@ -26,32 +128,42 @@ public:
     }
 
     BigNumJS multiply(const BigNumJS& other) const {
-        return BigNumJS(num * other.num);
+        return BigNumJS(guarded([&] { return num * other.num; }));
     }
 
     BigNumJS divide(const BigNumJS& other) const {
-        return BigNumJS(num / other.num);
+        return BigNumJS(guarded([&] { return num / other.num; }));
     }
 
     BigNumJS modulo(const BigNumJS& other) const {
-        return BigNumJS(num % other.num);
+        return BigNumJS(guarded([&] { return num % other.num; }));
+    }
+
+    // Raises to a non-negative exponent below 2^64 in one call
+    BigNumJS pow(const BigNumJS& exponent) const {
+        const BigNum& e = exponent.num;
+        if (e.isNegative() || e.getDigits().size() > 1) {
+            throw std::invalid_argument("Exponent must be in [0, 2^64)");
+        }
+        return BigNumJS(guarded([&] { return num.pow(e.getDigits()[0]); }));
     }
 
     // Cryptographic operations
     BigNumJS modPow(const BigNumJS& exponent, const BigNumJS& modulus) const {
-        return BigNumJS(num.modPow(exponent.num, modulus.num));
+        return BigNumJS(guarded([&] { return num.modPow(exponent.num, modulus.num); }));
     }
 
     BigNumJS gcd(const BigNumJS& other) const {
-        return BigNumJS(num.gcd(other.num));
+        return BigNumJS(guarded([&] { return num.gcd(other.num); }));
     }
 
     BigNumJS modInverse(const BigNumJS& modulus) const {
-        return BigNumJS(num.modInverse(modulus.num));
+        return BigNumJS(guarded([&] { return num.modInverse(modulus.num); }));
     }
 
     // Extended GCD - returns object with gcd, s, and t
     val extendedGcd(const BigNumJS& other) const {
+        CallGuard guard;
         auto result = num.extendedGcd(other.num);
         
         val obj = val::object();
@@ -101,6 +213,11 @@ public:
         return num.toHexString();
     }
 
+    std::string toDecimalString() const {
+        CallGuard guard;
+        return num.toDecimalString();
+    }
+
     bool isZero() const {
         return num.isZero();
     }
@@ -129,8 +246,49 @@ public:
         return num.byteLength();
     }
 
+    // The parallel modes run on the library thread pool in the threaded
+    // build and fall back to one thread in the baseline build
     bool isProbablePrime(int rounds = 20) const {
-        return num.isProbablePrime(rounds);
+        CallGuard guard;
+        return num.isProbablePrime(rounds, BigNum::Execution::Parallel);
+    }
+
+    BigNumJS nextPrime() const {
+        return BigNumJS(guarded([&] { return num.nextPrime(); }));
+    }
+
+    // Prime factors in ascending order, as hex strings
+    val factor() const {
+        CallGuard guard;
+        val factors = val::array();
+        for (const BigNum& f : num.factor()) {
+            factors.call<void>("push", f.toHexString());
+        }
+        return factors;
+    }
+
+    // Typed-array and BigInt interop. limbs() is a BigUint64Array over the
+    // value's own storage: no copy, but only valid until the value is freed
+    // or the wasm memory grows.
+    val limbs() const {
+        const LimbVector& d = num.getDigits();
+        return val::take_ownership(limbsView(d.data(), d.size()));
+    }
+
+    val toBigInt() const {
+        return ::toBigInt(num);
+    }
+
+    val toBytes(size_t length, bool bigEndian) const {
+        return toByteArray(num, length, bigEndian);
+    }
+
+    static BigNumJS fromBigInt(const val& value) {
+        return BigNumJS(::fromBigInt(value));
+    }
+
+    static BigNumJS fromBytes(const val& bytes, bool bigEndian) {
+        return BigNumJS(fromByteView(bytes, bigEndian));
     }
 
     // Static methods
@@ -139,13 +297,60 @@ public:
     }
 
     static BigNumJS randomPrime(size_t bitLength) {
-        return BigNumJS(BigNum::randomPrime(bitLength));
+        return BigNumJS(guarded([&] { return BigNum::randomPrime(bitLength, BigNum::Execution::Parallel); }));
+    }
+
+    // modPow over arrays of hex strings, one result per base; a single
+    // exponent or modulus is shared by all of them
+    static val modPowBatch(const val& bases, const val& exponents, const val& moduli) {
+        auto load = [](const val& hexes) {
+            std::vector<BigNum> values;
+            for (const std::string& hex : vecFromJSArray<std::string>(hexes)) {
+                values.push_back(BigNum::fromHexString(hex));
+            }
+            return values;
+        };
+        CallGuard guard;
+        val results = val::array();
+        for (const BigNum& r : BigNum::modPowBatch(load(bases), load(exponents), load(moduli))) {
+            results.call<void>("push", r.toHexString());
+        }
+        return results;
+    }
+
+    // Present only in builds whose long-running calls poll Module.cancelFlag
+    // through CallGuard; checkBigNumModule() in bignum_eval.js refuses
+    // modules without it, so the page's cancel flag is never ignored
+    static bool cancelPolling() {
+        return true;
+    }
+
+    // Threads the parallel calls use, the calling one included
+    static size_t threadCount() {
+        return BigNum::threadCount();
+    }
+
+    static void setThreadCount(size_t threads) {
+        BigNum::setThreadCount(threads);
+    }
+
+    // BigNumStats as JSON; "enabled" is false unless built with BIGNUM_STATS=1
+    static std::string statsJson() {
+        return BigNum::stats().toJson();
+    }
+
+    static void resetStats() {
+        BigNum::resetStats();
     }
 
     static BigNumJS fromHexString(const std::string& hexStr) {
         return BigNumJS(BigNum::fromHexString(hexStr));
     }
 
+    static BigNumJS fromDecimalString(const std::string& decStr) {
+        return BigNumJS(BigNum::fromDecimalString(decStr));
+    }
+
     static BigNumJS zero() {
         return BigNumJS(BigNum::zero());
     }
@@ -159,6 +364,167 @@ public:
     }
 };
 
+// Register file for running many operations per call. Values live in
+// numbered registers on the wasm side; a program is a Uint32Array of
+// five-word instructions [op, dst, a, b, c] executed in order, so a long
+// script crosses the JS boundary once instead of once per step. Writing a
+// register past the end grows the file with zeros.
+//
+//   COPY   dst = a              SET    dst = immediate a
+//   ADD    dst = a + b          SUB    dst = a - b
+//   MUL    dst = a * b          SQR    dst = a * a
+//   DIV    dst = a / b          MOD    dst = a % b
+//   NEG    dst = -a             CMP    dst = -1, 0 or 1 comparing a with b
+//   POW    dst = a ^ b          MODPOW dst = a ^ b mod c
+//   GCD    dst = gcd(a, b)      MODINV dst = a^-1 mod b
+//   EXTGCD dst, dst + 1, dst + 2 = g, s, t with a s + b t = g
+//   SHL    dst = a << immediate b
+//   SHR    dst = a >> immediate b
+//   AND, OR, XOR  dst = a op b
+class BigNumBatch {
+public:
+    enum Op : uint32_t {
+        COPY, SET, ADD, SUB, MUL, SQR, DIV, MOD, NEG, CMP, POW, MODPOW,
+        GCD, MODINV, EXTGCD, SHL, SHR, AND, OR, XOR, OP_COUNT
+    };
+
+    static constexpr size_t WORDS = 5;
+
+    explicit BigNumBatch(size_t registers) : regs(registers) {}
+
+    size_t size() const {
+        return regs.size();
+    }
+
+    void resize(size_t registers) {
+        regs.resize(registers);
+    }
+
+    void set(size_t r, const BigNumJS& value) {
+        target(r) = value.value();
+    }
+
+    void setHex(size_t r, const std::string& hex) {
+        target(r) = BigNum::fromHexString(hex);
+    }
+
+    void setBigInt(size_t r, const val& value) {
+        target(r) = ::fromBigInt(value);
+    }
+
+    void setBytes(size_t r, const val& bytes, bool bigEndian) {
+        target(r) = fromByteView(bytes, bigEndian);
+    }
+
+    BigNumJS get(size_t r) const {
+        return BigNumJS(source(r));
+    }
+
+    std::string getHex(size_t r) const {
+        return source(r).toHexString();
+    }
+
+    val getBigInt(size_t r) const {
+        return ::toBigInt(source(r));
+    }
+
+    val getBytes(size_t r, size_t length, bool bigEndian) const {
+        return toByteArray(source(r), length, bigEndian);
+    }
+
+    // Zero-copy view of a register; see BigNumJS::limbs()
+    val limbs(size_t r) const {
+        const LimbVector& d = source(r).getDigits();
+        return val::take_ownership(limbsView(d.data(), d.size()));
+    }
+
+    void run(const val& program) {
+        const std::vector<uint32_t> code = convertJSArrayToNumberVector<uint32_t>(program);
+        if (code.size() % WORDS != 0) {
+            throw std::invalid_argument("Program length must be a multiple of 5 words");
+        }
+        BigNum::CancelScope cancel([] { return cancelRequested(); });
+        for (size_t pc = 0; pc < code.size(); pc += WORDS) {
+            try {
+                execute(&code[pc]);
+            } catch (const BigNum::Cancelled&) {
+                throw;
+            } catch (const std::exception& e) {
+                throw std::invalid_argument("Instruction " + std::to_string(pc / WORDS) + ": " + e.what());
+            }
+        }
+    }
+
+    // Opcode numbers by name, for building programs
+    static val opcodes() {
+        static const char* const names[OP_COUNT] = {
+            "COPY", "SET", "ADD", "SUB", "MUL", "SQR", "DIV", "MOD", "NEG", "CMP", "POW", "MODPOW",
+            "GCD", "MODINV", "EXTGCD", "SHL", "SHR", "AND", "OR", "XOR"};
+        val ops = val::object();
+        for (uint32_t op = 0; op < OP_COUNT; ++op) ops.set(names[op], op);
+        return ops;
+    }
+
+private:
+    std::vector<BigNum> regs;
+
+    const BigNum& source(size_t r) const {
+        if (r >= regs.size()) {
+            throw std::invalid_argument("Register " + std::to_string(r) + " out of range");
+        }
+        return regs[r];
+    }
+
+    BigNum& target(size_t r) {
+        if (r >= regs.size()) regs.resize(r + 1);
+        return regs[r];
+    }
+
+    void execute(const uint32_t* ins) {
+        const uint32_t dst = ins[1];
+        auto a = [&]() -> const BigNum& { return source(ins[2]); };
+        auto b = [&]() -> const BigNum& { return source(ins[3]); };
+        BigNum result;
+        switch (ins[0]) {
+            case COPY: result = a(); break;
+            case SET: result = BigNum(static_cast<int64_t>(ins[2])); break;
+            case ADD: result = a() + b(); break;
+            case SUB: result = a() - b(); break;
+            case MUL: result = a() * b(); break;
+            case SQR: result = a().square(); break;
+            case DIV: result = a() / b(); break;
+            case MOD: result = a() % b(); break;
+            case NEG: result = BigNum(0LL) - a(); break;
+            case CMP: result = BigNum(static_cast<int64_t>(a() < b() ? -1 : a() > b() ? 1 : 0)); break;
+            case POW: {
+                const BigNum& e = b();
+                if (e.isNegative() || e.getDigits().size() > 1) {
+                    throw std::invalid_argument("Exponent must be in [0, 2^64)");
+                }
+                result = a().pow(e.getDigits()[0]);
+                break;
+            }
+            case MODPOW: result = a().modPow(b(), source(ins[4])); break;
+            case GCD: result = a().gcd(b()); break;
+            case MODINV: result = a().modInverse(b()); break;
+            case EXTGCD: {
+                auto egcd = a().extendedGcd(b());
+                target(dst + 2) = std::move(egcd.second.second);
+                target(dst + 1) = std::move(egcd.second.first);
+                target(dst) = std::move(egcd.first);
+                return;
+            }
+            case SHL: result = a() << static_cast<int>(ins[3]); break;
+            case SHR: result = a() >> static_cast<int>(ins[3]); break;
+            case AND: result = a() & b(); break;
+            case OR: result = a() | b(); break;
+            case XOR: result = a() ^ b(); break;
+            default: throw std::invalid_argument("Unknown opcode " + std::to_string(ins[0]));
+        }
+        target(dst) = std::move(result);
+    }
+};
+
 // JavaScript bindings
 EMSCRIPTEN_BINDINGS(bignum) {
     class_<BigNumJS>("BigNum")
@@ -171,6 +537,7 @@ EMSCRIPTEN_BINDINGS(bignum) {
         .function("multiply", &BigNumJS::multiply)
         .function("divide", &BigNumJS::divide)
         .function("modulo", &BigNumJS::modulo)
+        .function("pow", &BigNumJS::pow)
         
         // Cryptographic operations
         .function("modPow", &BigNumJS::modPow)
@@ -192,6 +559,7 @@ EMSCRIPTEN_BINDINGS(bignum) {
         
         // Properties and utilities
         .function("toHexString", &BigNumJS::toHexString)
+        .function("toDecimalString", &BigNumJS::toDecimalString)
         .function("isZero", &BigNumJS::isZero)
         .function("isOne", &BigNumJS::isOne)
         .function("isNegative", &BigNumJS::isNegative)
@@ -200,12 +568,44 @@ EMSCRIPTEN_BINDINGS(bignum) {
         .function("bitLength", &BigNumJS::bitLength)
         .function("byteLength", &BigNumJS::byteLength)
         .function("isProbablePrime", &BigNumJS::isProbablePrime)
+        .function("nextPrime", &BigNumJS::nextPrime)
+        .function("factor", &BigNumJS::factor)
+        
+        // Typed-array and BigInt interop
+        .function("limbs", &BigNumJS::limbs)
+        .function("toBigInt", &BigNumJS::toBigInt)
+        .function("toBytes", &BigNumJS::toBytes)
         
         // Static methods
         .class_function("random", &BigNumJS::random)
         .class_function("randomPrime", &BigNumJS::randomPrime)
+        .class_function("modPowBatch", &BigNumJS::modPowBatch)
+        .class_function("cancelPolling", &BigNumJS::cancelPolling)
+        .class_function("threadCount", &BigNumJS::threadCount)
+        .class_function("setThreadCount", &BigNumJS::setThreadCount)
+        .class_function("statsJson", &BigNumJS::statsJson)
+        .class_function("resetStats", &BigNumJS::resetStats)
         .class_function("fromHexString", &BigNumJS::fromHexString)
+        .class_function("fromBigInt", &BigNumJS::fromBigInt)
+        .class_function("fromBytes", &BigNumJS::fromBytes)
+        .class_function("fromDecimalString", &BigNumJS::fromDecimalString)
         .class_function("zero", &BigNumJS::zero)
         .class_function("one", &BigNumJS::one)
         .class_function("two", &BigNumJS::two);
+
+    class_<BigNumBatch>("BigNumBatch")
+        .constructor<size_t>()
+        .function("size", &BigNumBatch::size)
+        .function("resize", &BigNumBatch::resize)
+        .function("set", &BigNumBatch::set)
+        .function("setHex", &BigNumBatch::setHex)
+        .function("setBigInt", &BigNumBatch::setBigInt)
+        .function("setBytes", &BigNumBatch::setBytes)
+        .function("get", &BigNumBatch::get)
+        .function("getHex", &BigNumBatch::getHex)
+        .function("getBigInt", &BigNumBatch::getBigInt)
+        .function("getBytes", &BigNumBatch::getBytes)
+        .function("limbs", &BigNumBatch::limbs)
+        .function("run", &BigNumBatch::run)
+        .class_function("opcodes", &BigNumBatch::opcodes);
 }
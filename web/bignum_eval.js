@@ -0,0 +1,426 @@
+/**
+ * Expression evaluator shared by the calculator page and bignum_worker.js.
+ *
+ * Both hosts load this as a classic script and provide three globals: the
+ * instantiated module `BigNumWasm`, the `variables` map from name to BigNum,
+ * and the current `outputFormat` ('dec', 'hex' or 'both').
+ */
+// Number Conversion Utilities
+function parseNumber(input) {
+    input = input.trim();
+
+    // Handle hex (0x prefix)
+    if (input.toLowerCase().startsWith('0x')) {
+        return {
+            type: 'hex',
+            value: input.substring(2),
+            original: input
+        };
+    }
+
+    // Handle binary (0b prefix)
+    if (input.toLowerCase().startsWith('0b')) {
+        const binary = input.substring(2);
+        const hex = parseInt(binary, 2).toString(16);
+        return {
+            type: 'binary',
+            value: hex,
+            original: input
+        };
+    }
+
+    // Handle octal (0o prefix)
+    if (input.toLowerCase().startsWith('0o')) {
+        const octal = input.substring(2);
+        const hex = parseInt(octal, 8).toString(16);
+        return {
+            type: 'octal',
+            value: hex,
+            original: input
+        };
+    }
+
+    // Handle decimal (no prefix); the digits are converted natively
+    if (/^\d+$/.test(input)) {
+        return {
+            type: 'decimal',
+            value: input,
+            original: input
+        };
+    }
+
+    // Handle pure hex (no prefix, contains a-f)
+    if (/^[0-9a-f]+$/i.test(input)) {
+        return {
+            type: 'hex',
+            value: input.toLowerCase(),
+            original: input
+        };
+    }
+
+    throw new Error(`Invalid number format: ${input}`);
+}
+
+// Methods the evaluator calls that older builds of bignum.js lack. A module
+// missing any of them is stale and has to be rebuilt with build_wasm.sh;
+// the evaluator does not emulate them in JavaScript.
+const REQUIRED_STATIC_METHODS = ['fromDecimalString', 'cancelPolling', 'statsJson', 'resetStats'];
+const REQUIRED_INSTANCE_METHODS = ['toDecimalString', 'pow', 'nextPrime', 'factor'];
+
+// Throws, naming the missing methods, unless `module` has everything above
+function checkBigNumModule(module, script = 'bignum.js') {
+    const missing = [
+        ...REQUIRED_STATIC_METHODS.filter(name => typeof module.BigNum[name] !== 'function'),
+        ...REQUIRED_INSTANCE_METHODS.filter(name => typeof module.BigNum.prototype[name] !== 'function')
+    ];
+    if (missing.length > 0) {
+        throw new Error(`${script} is out of date (missing ${missing.join(', ')}); rebuild it with ./build_wasm.sh`);
+    }
+}
+
+function createBigNum(input) {
+    const parsed = parseNumber(input);
+    if (parsed.type === 'decimal') {
+        return BigNumWasm.BigNum.fromDecimalString(parsed.value);
+    }
+    return new BigNumWasm.BigNum(parsed.value);
+}
+
+// Helper function to create BigNum from various input types
+function createBigNumSafe(input) {
+    if (typeof input === 'string') {
+        // Handle simple decimal numbers
+        if (/^\d+$/.test(input)) {
+            return BigNumWasm.BigNum.fromDecimalString(input);
+        }
+        return createBigNum(input);
+    } else if (typeof input === 'number') {
+        const hex = input.toString(16);
+        return new BigNumWasm.BigNum(hex);
+    } else {
+        return createBigNum(input.toString());
+    }
+}
+
+function processFunctions(expr) {
+    // Process functions one by one to avoid conflicts
+    let processed = expr;
+
+    // Note: ExtGCD is handled separately in evaluateCommand, so we don't process it here
+
+    // NextPrime function (sieved search in wasm)
+    processed = processed.replace(/nextprime\s*\(\s*([^)]+)\s*\)/gi, (match, num) => {
+        try {
+            const number = createBigNumSafe(num.trim());
+            const nextPrime = number.nextPrime();
+            return `0x${nextPrime.toHexString()}`;
+        } catch (error) {
+            throw new Error(`NextPrime error: ${error.message}`);
+        }
+    });
+
+    // GCD function
+    processed = processed.replace(/gcd\s*\(\s*([^,]+)\s*,\s*([^)]+)\s*\)/gi, (match, a, b) => {
+        try {
+            const numA = createBigNumSafe(a.trim());
+            const numB = createBigNumSafe(b.trim());
+            const result = numA.gcd(numB);
+            return `0x${result.toHexString()}`;
+        } catch (error) {
+            throw new Error(`GCD error: ${error.message}`);
+        }
+    });
+
+    // LCM function
+    processed = processed.replace(/lcm\s*\(\s*([^,]+)\s*,\s*([^)]+)\s*\)/gi, (match, a, b) => {
+        try {
+            const numA = createBigNumSafe(a.trim());
+            const numB = createBigNumSafe(b.trim());
+            const gcd = numA.gcd(numB);
+            const result = numA.multiply(numB).divide(gcd);
+            return `0x${result.toHexString()}`;
+        } catch (error) {
+            throw new Error(`LCM error: ${error.message}`);
+        }
+    });
+
+    // ModPow function
+    processed = processed.replace(/modpow\s*\(\s*([^,]+)\s*,\s*([^,]+)\s*,\s*([^)]+)\s*\)/gi, (match, base, exp, mod) => {
+        try {
+            const numBase = createBigNumSafe(base.trim());
+            const numExp = createBigNumSafe(exp.trim());
+            const numMod = createBigNumSafe(mod.trim());
+            const result = numBase.modPow(numExp, numMod);
+            return `0x${result.toHexString()}`;
+        } catch (error) {
+            throw new Error(`ModPow error: ${error.message}`);
+        }
+    });
+
+    // ModInverse function
+    processed = processed.replace(/modinv\s*\(\s*([^,]+)\s*,\s*([^)]+)\s*\)/gi, (match, a, mod) => {
+        try {
+            const numA = createBigNumSafe(a.trim());
+            const numMod = createBigNumSafe(mod.trim());
+            const result = numA.modInverse(numMod);
+            return `0x${result.toHexString()}`;
+        } catch (error) {
+            throw new Error(`ModInverse error: ${error.message}`);
+        }
+    });
+
+    // IsPrime function - returns boolean, handle specially
+    processed = processed.replace(/isprime\s*\(\s*([^)]+)\s*\)/gi, (match, num) => {
+        try {
+            const number = createBigNumSafe(num.trim());
+            const isPrime = number.isProbablePrime(20);
+            return isPrime ? 'true' : 'false';
+        } catch (error) {
+            throw new Error(`IsPrime error: ${error.message}`);
+        }
+    });
+
+    // Factor function (trial division, Pollard rho and ECM in wasm)
+    processed = processed.replace(/factor\s*\(\s*([^)]+)\s*\)/gi, (match, num) => {
+        try {
+            const number = createBigNumSafe(num.trim());
+            const factors = findFactors(number);
+            return `"${factors}"`; // Wrap in quotes to treat as string literal
+        } catch (error) {
+            throw new Error(`Factor error: ${error.message}`);
+        }
+    });
+
+    // Random functions
+    processed = processed.replace(/random\s*\(\s*([^)]+)\s*\)/gi, (match, bits) => {
+        try {
+            const bitCount = parseInt(bits.trim());
+            if (isNaN(bitCount) || bitCount <= 0) {
+                throw new Error("Invalid bit count");
+            }
+            const result = BigNumWasm.BigNum.random(bitCount);
+            return `0x${result.toHexString()}`;
+        } catch (error) {
+            throw new Error(`Random error: ${error.message}`);
+        }
+    });
+
+    processed = processed.replace(/randprime\s*\(\s*([^)]+)\s*\)/gi, (match, bits) => {
+        try {
+            const bitCount = parseInt(bits.trim());
+            if (isNaN(bitCount) || bitCount <= 0) {
+                throw new Error("Invalid bit count");
+            }
+            const result = BigNumWasm.BigNum.randomPrime(bitCount);
+            return `0x${result.toHexString()}`;
+        } catch (error) {
+            throw new Error(`RandPrime error: ${error.message}`);
+        }
+    });
+
+    // Bitwise functions that return numbers - need to be converted to BigNum format
+    processed = processed.replace(/bitlength\s*\(\s*([^)]+)\s*\)/gi, (match, num) => {
+        try {
+            const number = createBigNumSafe(num.trim());
+            const length = number.bitLength();
+            // Convert to hex so it can be used in further calculations
+            return `0x${length.toString(16)}`;
+        } catch (error) {
+            throw new Error(`BitLength error: ${error.message}`);
+        }
+    });
+
+    // Boolean functions - handle specially
+    processed = processed.replace(/iseven\s*\(\s*([^)]+)\s*\)/gi, (match, num) => {
+        try {
+            const number = createBigNumSafe(num.trim());
+            return number.isEven() ? 'true' : 'false';
+        } catch (error) {
+            throw new Error(`IsEven error: ${error.message}`);
+        }
+    });
+
+    processed = processed.replace(/isodd\s*\(\s*([^)]+)\s*\)/gi, (match, num) => {
+        try {
+            const number = createBigNumSafe(num.trim());
+            return number.isOdd() ? 'true' : 'false';
+        } catch (error) {
+            throw new Error(`IsOdd error: ${error.message}`);
+        }
+    });
+
+    return processed;
+}
+
+// Updated evaluateArithmetic to handle string literals and boolean values
+function evaluateArithmetic(expr) {
+    // Handle string literals (wrapped in quotes) - just return the content
+    if (expr.startsWith('"') && expr.endsWith('"')) {
+        return expr.slice(1, -1); // Remove quotes and return as string
+    }
+
+    // Handle boolean values
+    if (expr === 'true' || expr === 'false') {
+        return expr === 'true';
+    }
+
+    // Handle pure numbers that are already decimal strings (from bitlength etc.)
+    if (/^\d+$/.test(expr.trim())) {
+        try {
+            return createBigNumSafe(expr.trim());
+        } catch (error) {
+            return parseInt(expr.trim());
+        }
+    }
+
+    // Handle parentheses first
+    while (expr.includes('(')) {
+        expr = expr.replace(/\(([^()]+)\)/g, (match, inner) => {
+            const result = evaluateArithmetic(inner);
+            if (typeof result === 'string') {
+                return `"${result}"`; // Wrap strings in quotes
+            } else if (typeof result === 'boolean') {
+                return result.toString();
+            } else if (result && typeof result.toHexString === 'function') {
+                return `0x${result.toHexString()}`;
+            } else {
+                return result.toString();
+            }
+        });
+    }
+
+    // Handle exponentiation (^)
+    const powerMatch = expr.match(/((?:0x)?[0-9a-f]+)\s*\^\s*((?:0x)?[0-9a-f]+)/i);
+    if (powerMatch) {
+        const base = createBigNumSafe(powerMatch[1]);
+        const exp = createBigNumSafe(powerMatch[2]);
+        return base.pow(exp);
+    }
+
+    // Handle multiplication and division
+    const mulDivMatch = expr.match(/((?:0x)?[0-9a-f]+)\s*([*\/])\s*((?:0x)?[0-9a-f]+)/i);
+    if (mulDivMatch) {
+        const left = createBigNumSafe(mulDivMatch[1]);
+        const op = mulDivMatch[2];
+        const right = createBigNumSafe(mulDivMatch[3]);
+
+        if (op === '*') return left.multiply(right);
+        if (op === '/') return left.divide(right);
+    }
+
+    // Handle addition and subtraction
+    const addSubMatch = expr.match(/((?:0x)?[0-9a-f]+)\s*([+\-])\s*((?:0x)?[0-9a-f]+)/i);
+    if (addSubMatch) {
+        const left = createBigNumSafe(addSubMatch[1]);
+        const op = addSubMatch[2];
+        const right = createBigNumSafe(addSubMatch[3]);
+
+        if (op === '+') return left.add(right);
+        if (op === '-') return left.subtract(right);
+    }
+
+    // Handle modulo
+    const modMatch = expr.match(/((?:0x)?[0-9a-f]+)\s*%\s*((?:0x)?[0-9a-f]+)/i);
+    if (modMatch) {
+        const left = createBigNumSafe(modMatch[1]);
+        const right = createBigNumSafe(modMatch[2]);
+        return left.modulo(right);
+    }
+
+    // Single number or string
+    const trimmed = expr.trim();
+    if (trimmed.startsWith('"') && trimmed.endsWith('"')) {
+        return trimmed.slice(1, -1); // Remove quotes
+    }
+
+    // Try to create a BigNum, fallback to string if it fails
+    try {
+        return createBigNumSafe(trimmed);
+    } catch (error) {
+        return trimmed; // Return as string if it can't be parsed as a number
+    }
+}
+
+// Update formatResult to handle non-BigNum results
+function formatResult(result, format = outputFormat) {
+    // Handle string results (like factor output, boolean values)
+    if (typeof result === 'string') {
+        return result;
+    }
+
+    // Handle boolean results
+    if (typeof result === 'boolean') {
+        return result.toString();
+    }
+
+    // Handle number results
+    if (typeof result === 'number') {
+        return result.toString();
+    }
+
+    // Handle null/undefined
+    if (result == null) {
+        return 'undefined';
+    }
+
+    // Handle BigNum results
+    if (result && typeof result.toHexString === 'function') {
+        const hex = result.toHexString();
+
+        try {
+            const decimal = result.toDecimalString();
+
+            switch (format) {
+                case 'dec':
+                    return decimal;
+                case 'hex':
+                    return '0x' + hex;
+                case 'both':
+                    return `${decimal} (0x${hex})`;
+                default:
+                    return decimal;
+            }
+        } catch (error) {
+            // Fall back to hex if decimal conversion fails
+            return '0x' + hex;
+        }
+    }
+
+    // Fallback for unknown types
+    return String(result);
+}
+
+function evaluateExpression(expr) {
+    // Replace variables first, but be careful about function names
+    let processed = expr;
+
+    // Sort variables by length (longest first) to avoid partial replacements
+    const sortedVars = Object.keys(variables).sort((a, b) => b.length - a.length);
+
+    for (const varName of sortedVars) {
+        // Use word boundaries to avoid replacing parts of function names
+        const regex = new RegExp(`\\b${varName}\\b`, 'g');
+        const value = variables[varName];
+        if (value && typeof value.toHexString === 'function') {
+            processed = processed.replace(regex, `0x${value.toHexString()}`);
+        }
+    }
+
+    // Handle function calls
+    processed = processFunctions(processed);
+
+    // Handle arithmetic expressions
+    return evaluateArithmetic(processed);
+}
+
+// Helper function to format a factorization
+function findFactors(bignum) {
+    if (bignum.isZero()) {
+        throw new Error("Cannot factor zero");
+    }
+    const factors = bignum.factor();
+    if (factors.length === 0) {
+        return "1 has no prime factors";
+    }
+    return factors.map(hex => formatResult(createBigNumSafe('0x' + hex))).join(" × ");
+}
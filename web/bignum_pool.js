@@ -0,0 +1,242 @@
+/**
+ * Pool of bignum_worker.js workers for the calculator page.
+ *
+ * Jobs queue up and go to the first idle worker, so independent commands
+ * run on separate cores while the page stays responsive. Cancelling a
+ * running job sets the worker's shared flag when the page is cross-origin
+ * isolated (SharedArrayBuffer available), which the wasm side polls;
+ * otherwise the worker is terminated and a fresh one takes its place.
+ *
+ * Workers load the best wasm build the browser supports: the SIMD + threads
+ * build needs wasm SIMD, native wasm exceptions and shared memory, which
+ * browsers only grant to cross-origin isolated pages. Its workers are fewer
+ * and split the cores between their pthread pools.
+ */
+
+// Wasm builds in order of preference; see build_wasm.sh
+const BIGNUM_BUILDS = [
+    {name: 'SIMD + threads', script: 'bignum_mt.js', needs: ['simd', 'exceptions', 'threads']},
+    {name: 'baseline', script: 'bignum.js', needs: []}
+];
+
+class BigNumWorkerPool {
+    // Which optional wasm features this browser can run
+    static detectFeatures() {
+        // Smallest modules using a v128 instruction, a try/catch block and
+        // an atomic load from shared memory
+        const modules = {
+            simd: [0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11],
+            exceptions: [0, 97, 115, 109, 1, 0, 0, 0, 1, 4, 1, 96, 0, 0, 3, 2, 1, 0, 10, 8, 1, 6, 0, 6, 64, 25, 11, 11],
+            threads: [0, 97, 115, 109, 1, 0, 0, 0, 1, 4, 1, 96, 0, 0, 3, 2, 1, 0, 5, 4, 1, 3, 1, 1, 10, 11, 1, 9, 0, 65, 0, 254, 16, 2, 0, 26, 11]
+        };
+        const features = {};
+        for (const [name, bytes] of Object.entries(modules)) {
+            try {
+                features[name] = WebAssembly.validate(new Uint8Array(bytes));
+            } catch (error) {
+                features[name] = false;
+            }
+        }
+        features.threads = features.threads && self.crossOriginIsolated === true &&
+            typeof SharedArrayBuffer !== 'undefined';
+        return features;
+    }
+
+    // Preferred build first, down to the baseline build that runs everywhere
+    static candidateBuilds(features = BigNumWorkerPool.detectFeatures()) {
+        return BIGNUM_BUILDS.filter(build => build.needs.every(feature => features[feature]));
+    }
+
+    // The candidates whose files are deployed. build_wasm.sh writes every
+    // variant, but a server may lack the optional ones, so those are probed;
+    // the baseline is what the page itself loaded.
+    static async availableBuilds(candidates = BigNumWorkerPool.candidateBuilds()) {
+        const deployed = async (build) => {
+            if (build.needs.length === 0) return true;
+            const files = [build.script, build.script.replace(/\.js$/, '.wasm')];
+            try {
+                const responses = await Promise.all(files.map(file => fetch(file, {method: 'HEAD'})));
+                return responses.every(response => response.ok);
+            } catch (error) {
+                return false;
+            }
+        };
+        const found = await Promise.all(candidates.map(deployed));
+        return candidates.filter((build, i) => found[i]);
+    }
+
+    constructor(build = BIGNUM_BUILDS[BIGNUM_BUILDS.length - 1]) {
+        const cores = navigator.hardwareConcurrency || 2;
+        const threaded = build.needs.includes('threads');
+        this.build = build;
+        this.size = threaded ? Math.min(2, cores) : Math.min(cores, 4);
+        this.threadsPerWorker = threaded ? Math.max(1, Math.floor(cores / this.size)) : 1;
+        this.shared = self.crossOriginIsolated === true && typeof SharedArrayBuffer !== 'undefined';
+        this.slots = [];
+        this.queue = [];
+        this.nextId = 1;
+    }
+
+    // Resolves once the first worker has loaded its module, and rejects when
+    // every worker failed or none is ready within timeoutMs (a threaded build
+    // whose pthreads cannot start never finishes loading)
+    start(timeoutMs = 15000) {
+        const ready = [];
+        for (let i = 0; i < this.size; ++i) {
+            const slot = {worker: null, flag: null, job: null, ready: false, statsWaiters: []};
+            this.slots.push(slot);
+            ready.push(this.spawn(slot));
+        }
+        let timer;
+        const timeout = new Promise((resolve, reject) => {
+            timer = setTimeout(() => reject(new Error(`${this.build.script} did not load within ${timeoutMs / 1000}s`)), timeoutMs);
+        });
+        return Promise.race([Promise.any(ready), timeout]).finally(() => clearTimeout(timer));
+    }
+
+    // Jobs queued or running
+    get pending() {
+        return this.queue.length + this.slots.filter(slot => slot.job).length;
+    }
+
+    get cancelMode() {
+        return this.shared ? 'shared flag' : 'terminate';
+    }
+
+    // Evaluates `expr` with `vars` (name -> BigNum) in a worker. The result
+    // promise resolves to {hex, text} and rejects with an Error whose
+    // `cancelled` property tells a cancellation from a failure.
+    run(expr, vars, format) {
+        const hexVars = {};
+        for (const [name, value] of Object.entries(vars)) hexVars[name] = value.toHexString();
+
+        const job = {id: this.nextId++, expr, vars: hexVars, format};
+        job.promise = new Promise((resolve, reject) => {
+            job.resolve = resolve;
+            job.reject = reject;
+        });
+        this.queue.push(job);
+        this.pump();
+        return {promise: job.promise, cancel: () => this.cancel(job)};
+    }
+
+    // Library counters of every loaded worker, as [{stats, heapBytes}]. A
+    // busy worker answers once its current job is done.
+    stats(reset = false) {
+        const replies = this.slots.filter(slot => slot.ready).map(slot => new Promise(resolve => {
+            slot.statsWaiters.push(resolve);
+            slot.worker.postMessage({type: 'stats', reset});
+        }));
+        return Promise.all(replies).then(all => all.filter(reply => reply));
+    }
+
+    cancelAll() {
+        for (const job of this.queue.splice(0)) job.reject(BigNumWorkerPool.cancelledError());
+        for (const slot of this.slots) {
+            if (slot.job) this.cancel(slot.job);
+        }
+    }
+
+    // Stops every worker; the pool cannot be used afterwards
+    terminate() {
+        for (const job of this.queue.splice(0)) job.reject(BigNumWorkerPool.cancelledError());
+        for (const slot of this.slots) {
+            slot.worker.terminate();
+            if (slot.job) slot.job.reject(BigNumWorkerPool.cancelledError());
+        }
+        this.slots = [];
+    }
+
+    cancel(job) {
+        const queued = this.queue.indexOf(job);
+        if (queued >= 0) {
+            this.queue.splice(queued, 1);
+            job.reject(BigNumWorkerPool.cancelledError());
+            return;
+        }
+        const slot = this.slots.find(s => s.job === job);
+        if (!slot) return;  // already finished
+        if (slot.flag) {
+            Atomics.store(slot.flag, 0, 1);  // the worker answers with cancelled: true
+            return;
+        }
+        slot.worker.terminate();
+        slot.job = null;
+        job.reject(BigNumWorkerPool.cancelledError());
+        this.spawn(slot);
+    }
+
+    spawn(slot) {
+        // A replaced worker's counters are gone with it
+        for (const resolve of slot.statsWaiters.splice(0)) resolve(null);
+        slot.ready = false;
+        slot.flag = this.shared ? new Int32Array(new SharedArrayBuffer(4)) : null;
+        slot.worker = new Worker('bignum_worker.js');
+        return new Promise((resolve, reject) => {
+            slot.worker.onmessage = (event) => {
+                const message = event.data;
+                if (message.type === 'ready') {
+                    slot.ready = true;
+                    resolve();
+                    this.pump();
+                } else if (message.type === 'failed') {
+                    reject(new Error(message.error));
+                } else if (message.type === 'result') {
+                    this.finish(slot, message);
+                } else if (message.type === 'stats') {
+                    const waiter = slot.statsWaiters.shift();
+                    if (waiter) waiter({stats: message.stats, heapBytes: message.heapBytes});
+                }
+            };
+            slot.worker.onerror = (event) => {
+                event.preventDefault();
+                const job = slot.job;
+                slot.job = null;
+                if (job) job.reject(new Error(event.message || 'Worker failed'));
+                reject(new Error(event.message || 'Worker failed'));
+                if (slot.ready) {
+                    slot.worker.terminate();
+                    this.spawn(slot);
+                }
+            };
+            slot.worker.postMessage({
+                type: 'init',
+                script: this.build.script,
+                threads: this.threadsPerWorker,
+                cancelBuffer: slot.flag ? slot.flag.buffer : null
+            });
+        });
+    }
+
+    finish(slot, message) {
+        const job = slot.job;
+        slot.job = null;
+        if (job && job.id === message.id) {
+            if (message.ok) {
+                job.resolve({hex: message.hex, text: message.text});
+            } else if (message.cancelled) {
+                job.reject(BigNumWorkerPool.cancelledError());
+            } else {
+                job.reject(new Error(message.error));
+            }
+        }
+        this.pump();
+    }
+
+    pump() {
+        for (const slot of this.slots) {
+            if (this.queue.length === 0) return;
+            if (!slot.ready || slot.job) continue;
+            const job = this.queue.shift();
+            slot.job = job;
+            if (slot.flag) Atomics.store(slot.flag, 0, 0);
+            slot.worker.postMessage({type: 'run', id: job.id, expr: job.expr, vars: job.vars, format: job.format});
+        }
+    }
+
+    static cancelledError() {
+        const error = new Error('Cancelled');
+        error.cancelled = true;
+        return error;
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * Dedicated worker hosting its own BigNum module instance.
+ *
+ * Protocol (one job at a time per worker):
+ *   page -> worker  {type: 'init', script, threads, cancelBuffer}
+ *                   script is the wasm build to load, cancelBuffer a
+ *                   SharedArrayBuffer or null
+ *   worker -> page  {type: 'ready'} or {type: 'failed', error}
+ *   page -> worker  {type: 'run', id, expr, vars, format}
+ *                   vars maps variable names to hex strings
+ *   worker -> page  {type: 'result', id, ok: true, hex, text}
+ *                   hex is null when the result is not a number
+ *                   {type: 'result', id, ok: false, error, cancelled}
+ *   page -> worker  {type: 'stats', reset}
+ *   worker -> page  {type: 'stats', stats, heapBytes}
+ *                   stats is the parsed BigNum.statsJson(); reset
+ *                   clears the counters after reading them
+ *
+ * The page cancels a running job by storing a non-zero value in the shared
+ * flag, which the wasm side polls; BigNum::Cancelled then unwinds the call.
+ */
+
+importScripts('bignum_eval.js');
+
+// Globals the shared evaluator works on
+var BigNumWasm = null;
+var variables = {};
+var outputFormat = 'dec';
+
+let cancelFlag = null;
+
+function errorMessage(error) {
+    if (error && error.message) return error.message;
+    return String(error);
+}
+
+async function init({script, threads, cancelBuffer}) {
+    try {
+        importScripts(script);
+        // The threaded build starts its pthreads from the module script, not
+        // from this worker's
+        BigNumWasm = await BigNumModule({mainScriptUrlOrBlob: script});
+        checkBigNumModule(BigNumWasm, script);
+        if (typeof BigNumWasm.BigNum.setThreadCount === 'function') {
+            BigNumWasm.BigNum.setThreadCount(threads);
+        }
+        // The check above guarantees the module polls Module.cancelFlag
+        if (cancelBuffer) {
+            cancelFlag = new Int32Array(cancelBuffer);
+            BigNumWasm.cancelFlag = cancelFlag;
+        }
+        self.postMessage({type: 'ready'});
+    } catch (error) {
+        self.postMessage({type: 'failed', error: errorMessage(error)});
+    }
+}
+
+function run({id, expr, vars, format}) {
+    for (const value of Object.values(variables)) value.delete();
+    variables = {};
+    for (const [name, hex] of Object.entries(vars)) {
+        variables[name] = new BigNumWasm.BigNum(hex);
+    }
+    outputFormat = format;
+
+    try {
+        const result = evaluateExpression(expr);
+        const isNumber = result && typeof result.toHexString === 'function';
+        self.postMessage({
+            type: 'result', id, ok: true,
+            hex: isNumber ? result.toHexString() : null,
+            text: formatResult(result, format)
+        });
+    } catch (error) {
+        const cancelled = cancelFlag !== null && Atomics.load(cancelFlag, 0) !== 0;
+        self.postMessage({type: 'result', id, ok: false, error: errorMessage(error), cancelled});
+    }
+}
+
+function stats({reset}) {
+    const snapshot = JSON.parse(BigNumWasm.BigNum.statsJson());
+    if (reset) BigNumWasm.BigNum.resetStats();
+    self.postMessage({type: 'stats', stats: snapshot, heapBytes: BigNumWasm.HEAP8.buffer.byteLength});
+}
+
+self.onmessage = (event) => {
+    const message = event.data;
+    if (message.type === 'init') init(message);
+    else if (message.type === 'run') run(message);
+    else if (message.type === 'stats') stats(message);
+};
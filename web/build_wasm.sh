@@ -57,38 +57,80 @@ echo "✅ All source files found"
 
 # Clean previous builds
 echo "🧹 Cleaning previous builds..."
-rm -f bignum.js bignum.wasm bignum.d.ts
-
-# Compile to WebAssembly
-echo "🔨 Compiling to WebAssembly..."
-
-emcc ../bignum-cpp/src/bignum.cpp bignum_bindings.cpp \
-    -I../bignum-cpp/include \
-    -O3 \
-    -s WASM=1 \
-    -s MODULARIZE=1 \
-    -s EXPORT_NAME="BigNumModule" \
-    -s ALLOW_MEMORY_GROWTH=1 \
-    -s MAXIMUM_MEMORY=268435456 \
-    -s NO_EXIT_RUNTIME=1 \
-    -s ASSERTIONS=0 \
+rm -f bignum.js bignum.wasm bignum.d.ts bignum_mt.js bignum_mt.wasm bignum_mt.worker.js
+
+SOURCES=(
+    ../bignum-cpp/src/bignum.cpp
+    ../bignum-cpp/src/bignum_kernels.cpp
+    ../bignum-cpp/src/bignum_ntt.cpp
+    ../bignum-cpp/src/bignum_thread_pool.cpp
+    bignum_bindings.cpp
+)
+
+COMMON_FLAGS=(
+    -I../bignum-cpp/include
+    -O3
+    -s WASM=1
+    -s MODULARIZE=1
+    -s EXPORT_NAME="BigNumModule"
+    -s ALLOW_MEMORY_GROWTH=1
+    -s MAXIMUM_MEMORY=268435456
+    -s NO_EXIT_RUNTIME=1
+    -s ASSERTIONS=0
+    -s FILESYSTEM=0
+    -s ENVIRONMENT='web,worker'
+    -s EXPORTED_RUNTIME_METHODS='["ccall", "cwrap", "HEAP8"]'
+    --bind
+    -std=c++17
+)
+
+# Thresholds measured for wasm rather than the native defaults. Generate the
+# header by running the tuning tool itself as wasm under node:
+#   emcc ../bignum-cpp/tune-tool/tune.cpp "${SOURCES[@]:0:4}" -I../bignum-cpp/include \
+#       -O3 -std=c++17 -s NODERAWFS=1 -s ALLOW_MEMORY_GROWTH=1 -o bignum-tune.js
+#   node bignum-tune.js --header "$PWD/bignum_tuning_wasm.h"
+# then build with BIGNUM_TUNING_HEADER=$PWD/bignum_tuning_wasm.h ./build_wasm.sh
+# BIGNUM_STATS=1 ./build_wasm.sh turns on the operation counters behind the
+# dashboard's library statistics
+if [ "$BIGNUM_STATS" = "1" ]; then
+    echo "📊 Operation counters enabled"
+    COMMON_FLAGS+=(-DBIGNUM_STATS=1)
+fi
+if [ -n "$BIGNUM_TUNING_HEADER" ]; then
+    echo "🎛️  Using tuning header: $BIGNUM_TUNING_HEADER"
+    COMMON_FLAGS+=("-DBIGNUM_TUNING_HEADER=\"$BIGNUM_TUNING_HEADER\"")
+fi
+
+# Baseline build: runs everywhere, single-threaded, JavaScript-based
+# exception catching
+echo "🔨 Compiling baseline WebAssembly build..."
+emcc "${SOURCES[@]}" "${COMMON_FLAGS[@]}" \
     -s DISABLE_EXCEPTION_CATCHING=0 \
-    -s FILESYSTEM=0 \
-    -s ENVIRONMENT='web,worker' \
-    -s EXPORTED_RUNTIME_METHODS='["ccall", "cwrap"]' \
-    --bind \
-    -std=c++17 \
     -o bignum.js
 
+# Threaded build: wasm SIMD, native wasm exceptions and pthreads over a
+# SharedArrayBuffer heap, so the library thread pool backs randomPrime,
+# isProbablePrime and modPowBatch. Browsers only allow it on cross-origin
+# isolated pages; bignum_pool.js detects support and otherwise uses the
+# baseline build.
+echo "🔨 Compiling SIMD + threads WebAssembly build..."
+emcc "${SOURCES[@]}" "${COMMON_FLAGS[@]}" \
+    -msimd128 \
+    -fwasm-exceptions \
+    -pthread \
+    -s PTHREAD_POOL_SIZE=navigator.hardwareConcurrency \
+    -Wno-pthreads-mem-growth \
+    -o bignum_mt.js
+
 if [ $? -eq 0 ]; then
     echo "✅ WebAssembly compilation successful!"
     echo ""
     echo "📄 Generated files:"
-    echo "   - bignum.js (JavaScript wrapper)"
-    echo "   - bignum.wasm (WebAssembly binary)"
+    echo "   - bignum.js / bignum.wasm (baseline build)"
+    echo "   - bignum_mt.js / bignum_mt.wasm (SIMD + threads build)"
     echo ""
     echo "📊 File sizes:"
-    ls -lh bignum.js bignum.wasm 2>/dev/null || echo "Files generated successfully"
+    ls -lh bignum.js bignum.wasm bignum_mt.js bignum_mt.wasm 2>/dev/null || echo "Files generated successfully"
     echo ""
     echo "🌐 Ready to deploy! Your BigNum calculator is ready to use."
 else